@@ -0,0 +1,429 @@
+﻿#include "../src/Core/Block.h"
+#include "../src/Core/BlockImport.h"
+#include "../src/Core/BlockStore.h"
+#include "../src/Core/Blockchain.h"
+#include "../src/Core/Mempool.h"
+#include "../src/Core/Merkle.h"
+#include "../src/Crypto/Hash.h"
+#include "../src/Crypto/Sha256.h"
+#include "../src/Wallet/Base58.h"
+#include "../src/Wallet/Wallet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 性能基准 (不注册到 ctest，手动运行)
+// 用法: bench_mybitcoin [--filter=子串] [--min-time=秒] [--json=输出文件]
+// 每个用例先预热，再按固定批量采样若干次，报告每次操作耗时的分位数和吞吐量。
+// JSON 每个用例一行、字段顺序固定，两次构建的结果可以直接 diff。
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE ""
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 被测函数返回这次调用处理的条目数 (字节、哈希次数、区块数 ...)，用来算吞吐量
+typedef std::function<uint64_t()> BenchFn;
+
+struct BenchResult {
+    std::string name;
+    std::string unit;           // 条目的单位
+    uint64_t iterations = 0;    // 总调用次数
+    size_t samples = 0;
+    double minNs = 0, medianNs = 0, p90Ns = 0, p99Ns = 0, maxNs = 0;
+    double itemsPerSecond = 0;
+};
+
+// 被测代码 (挖矿、连接区块) 会往 std::cout 打日志，运行期间把它们吞掉
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+class QuietStdout {
+public:
+    QuietStdout() : old(std::cout.rdbuf(&sink)) {}
+    ~QuietStdout() { std::cout.rdbuf(old); }
+
+private:
+    NullBuffer sink;
+    std::streambuf* old;
+};
+
+// 被测结果写到这里，防止编译器把整个调用优化掉
+volatile uint8_t benchSink;
+
+double Percentile(const std::vector<double>& sorted, double p) {
+    // 最近秩法
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+class Runner {
+public:
+    std::string filter;
+    double minTime = 1.0;   // 每个用例的采样时间 (秒)
+
+    void Run(const std::string& name, const std::string& unit, const BenchFn& fn) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+        BenchResult r;
+        r.name = name;
+        r.unit = unit;
+        std::vector<double> perOp;
+        uint64_t items = 0;
+        double total = 0;
+        {
+            QuietStdout quiet;
+
+            // 1. 预热 (填满缓存、触发惰性初始化)，顺便估计单次耗时
+            double warm = 0;
+            uint64_t warmCalls = 0;
+            Clock::time_point begin = Clock::now();
+            do {
+                fn();
+                warmCalls++;
+                warm = Seconds(begin);
+            } while (warm < minTime * 0.1);
+
+            // 2. 每个样本至少 ~minTime/50，太快的操作合并成一批再计时
+            const size_t MIN_SAMPLES = 10, MAX_SAMPLES = 200;
+            double perCall = warm / warmCalls;
+            uint64_t batch = std::max<uint64_t>(1, static_cast<uint64_t>(minTime / 50 / perCall));
+            while (perOp.size() < MIN_SAMPLES || (total < minTime && perOp.size() < MAX_SAMPLES)) {
+                Clock::time_point start = Clock::now();
+                for (uint64_t i = 0; i < batch; i++) items += fn();
+                double elapsed = Seconds(start);
+                total += elapsed;
+                perOp.push_back(elapsed * 1e9 / batch);
+                r.iterations += batch;
+            }
+        }
+
+        std::sort(perOp.begin(), perOp.end());
+        r.samples = perOp.size();
+        r.minNs = perOp.front();
+        r.medianNs = Percentile(perOp, 0.5);
+        r.p90Ns = Percentile(perOp, 0.9);
+        r.p99Ns = Percentile(perOp, 0.99);
+        r.maxNs = perOp.back();
+        r.itemsPerSecond = total > 0 ? items / total : 0;
+        results.push_back(r);
+
+        printf("%-34s %14.1f %14.1f %14.1f %16.4g %s/s\n",
+            name.c_str(), r.medianNs, r.p90Ns, r.p99Ns, r.itemsPerSecond, unit.c_str());
+        fflush(stdout);
+    }
+
+    void WriteJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Cannot open " + path);
+
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#if defined(__clang__)
+        const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        const char* compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        const char* compiler = "MSVC " _CRT_STRINGIZE(_MSC_VER);
+#else
+        const char* compiler = "unknown";
+#endif
+
+        out << "{\n  \"context\": {"
+            << "\"date\": \"" << date << "\", "
+            << "\"build_type\": \"" << BENCH_BUILD_TYPE << "\", "
+            << "\"compiler\": \"" << compiler << "\", "
+            << "\"sha256\": \"" << Sha256Implementation() << "\", "
+            << "\"hardware_threads\": " << std::thread::hardware_concurrency() << ", "
+            << "\"min_time\": " << minTime << "},\n  \"benchmarks\": [\n";
+        char line[512];
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            snprintf(line, sizeof(line),
+                "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %llu, \"samples\": %zu, "
+                "\"ns_per_op\": {\"min\": %.1f, \"median\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}, "
+                "\"items_per_second\": %.6g}%s\n",
+                r.name.c_str(), r.unit.c_str(), static_cast<unsigned long long>(r.iterations), r.samples,
+                r.minNs, r.medianNs, r.p90Ns, r.p99Ns, r.maxNs, r.itemsPerSecond,
+                i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+    }
+
+private:
+    static double Seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    std::vector<BenchResult> results;
+};
+
+// --- 用例 ---
+
+void BenchHashing(Runner& runner) {
+    for (size_t size : { 64, 1024, 1024 * 1024 }) {
+        Bytes data(size, 0xA5);
+        runner.Run("sha256/" + std::to_string(size) + "B", "bytes", [data]() {
+            benchSink = Sha256(data)[0];
+            return static_cast<uint64_t>(data.size());
+        });
+    }
+    uint8_t header[Block::HEADER_SIZE] = {};
+    runner.Run("hash256/80B", "hashes", [&header]() {
+        header[0] = Hash256(header, sizeof(header))[0]; // 每次输入都不同
+        return uint64_t(1);
+    });
+}
+
+void BenchMining(Runner& runner) {
+    // 固定目标 0x1f00ffff (哈希以 2 个零字节开头，平均 65536 次)，每次换时间戳挖一个新区块头，吞吐量即哈希率
+    for (unsigned threads : { 1u, 0u }) {
+        uint32_t time = 0;
+        std::string name = threads == 1 ? "mine/difficulty2/1thread" : "mine/difficulty2/all_threads";
+        runner.Run(name, "hashes", [&time, threads]() {
+            Block block(1, uint256(), Hash256(ToBytes("bench")), ++time, 0x1f00ffff);
+            return block.Mine(threads).totalHashes;
+        });
+    }
+}
+
+// count 笔互不相同的交易
+std::vector<Transaction> MakeTransactions(size_t count) {
+    std::vector<Transaction> txs(count);
+    for (size_t i = 0; i < count; i++) {
+        txs[i].inputs.push_back({ Hash256(ToBytes("prev" + std::to_string(i))), 0, {}, {} });
+        txs[i].outputs.push_back({ static_cast<int64_t>(i + 1), Hash160(ToBytes("out" + std::to_string(i))) });
+        txs[i].Freeze();
+    }
+    return txs;
+}
+
+void BenchMerkle(Runner& runner) {
+    for (size_t count : { 1, 16, 256, 4096 }) {
+        std::vector<Transaction> txs = MakeTransactions(count);
+        runner.Run("merkle/" + std::to_string(count) + "tx", "tx", [txs]() {
+            benchSink = ComputeMerkleRoot(txs)[0];
+            return static_cast<uint64_t>(txs.size());
+        });
+    }
+}
+
+void BenchSignatures(Runner& runner) {
+    auto wallet = std::make_shared<Wallet>();
+    wallet->GenerateNewKey();
+    uint256 hash = Hash256(ToBytes("bench"));
+    Bytes sig = wallet->Sign(hash);
+
+    runner.Run("ecdsa/sign", "sigs", [wallet, hash]() {
+        return static_cast<uint64_t>(wallet->Sign(hash).empty() ? 0 : 1);
+    });
+    // Wallet::Verify 走公钥缓存，测的是命中缓存后的验证本身
+    runner.Run("ecdsa/verify", "sigs", [wallet, hash, sig]() {
+        return static_cast<uint64_t>(Wallet::Verify(wallet->GetPublicKey(), hash, sig) ? 1 : 0);
+    });
+}
+
+void BenchBase58(Runner& runner) {
+    uint8_t payload[21] = { 0x00 };
+    for (size_t i = 1; i < sizeof(payload); i++) payload[i] = static_cast<uint8_t>(i * 37);
+    runner.Run("base58/encode_check_address", "addresses", [&payload]() {
+        benchSink = static_cast<uint8_t>(EncodeBase58Check(payload, sizeof(payload))[1]);
+        return uint64_t(1);
+    });
+    std::string address = EncodeBase58Check(payload, sizeof(payload));
+    runner.Run("base58/decode_check_address", "addresses", [address]() {
+        Bytes out;
+        return static_cast<uint64_t>(DecodeBase58Check(address, out) ? 1 : 0);
+    });
+}
+
+// 花费 prev 的第 index 个输出
+Transaction Spend(const uint256& prev, uint32_t index, int64_t value, const Wallet& from, const uint160& to) {
+    Transaction tx;
+    tx.inputs.push_back({ prev, index, {}, {} });
+    tx.outputs.push_back({ value, to });
+    for (auto& in : tx.inputs) in.publicKey = from.GetPublicKey();
+    Bytes sig = from.Sign(tx.GetSignatureHash());
+    for (auto& in : tx.inputs) in.signature = sig;
+    return tx;
+}
+
+// 合成链：每个区块 = coinbase + 把上一个 coinbase 拆成 width 份 + 花掉上一个区块拆出的 width 个输出
+// width = 0 时只有 coinbase
+std::vector<Block> BuildSyntheticChain(uint32_t bits, size_t length, uint32_t width) {
+    QuietStdout quiet;
+    Blockchain chain(bits);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    std::vector<Block> blocks;
+    uint256 prevCoinbase, prevSplit;
+    for (uint32_t height = 1; height <= length; height++) {
+        Block block(1, chain.GetTip()->hash, uint256(), GENESIS_TIMESTAMP + height, bits);
+        Transaction coinbase = MakeCoinbase(height, alice.GetPubKeyHash(), GetBlockSubsidy(height));
+        block.AddTransaction(coinbase);
+        if (width > 0 && height >= 2) {
+            Transaction split;
+            split.inputs.push_back({ prevCoinbase, 0, {}, {} });
+            int64_t part = GetBlockSubsidy(height - 1) / width;
+            for (uint32_t i = 0; i < width; i++) split.outputs.push_back({ part, alice.GetPubKeyHash() });
+            for (auto& in : split.inputs) in.publicKey = alice.GetPublicKey();
+            Bytes sig = alice.Sign(split.GetSignatureHash());
+            for (auto& in : split.inputs) in.signature = sig;
+            block.AddTransaction(split);
+            if (height >= 3) {
+                for (uint32_t i = 0; i < width; i++) {
+                    block.AddTransaction(Spend(prevSplit, i, GetBlockSubsidy(height - 2) / width, alice, bob.GetPubKeyHash()));
+                }
+            }
+            prevSplit = split.GetId();
+        }
+        prevCoinbase = coinbase.GetId();
+        block.FinalizeAndMine();
+        chain.AddBlock(block);
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+void BenchChain(Runner& runner) {
+    // 每次操作 = 新建一条链 (目标 0x2000ffff，创世区块只需几百次哈希) 并依次 AddBlock 50 个区块；吞吐量按区块计
+    const uint32_t BITS = 0x2000ffff;
+    for (uint32_t width : { 0u, 20u }) {
+        std::string name = width == 0 ? "chain/add_50_blocks/coinbase_only" : "chain/add_50_blocks/41tx";
+        if (!runner.filter.empty() && name.find(runner.filter) == std::string::npos) continue;
+        auto blocks = std::make_shared<std::vector<Block>>(BuildSyntheticChain(BITS, 50, width));
+        runner.Run(name, "blocks", [blocks]() {
+            Blockchain chain(BITS);
+            for (const Block& b : *blocks) chain.AddBlock(b);
+            return static_cast<uint64_t>(blocks->size());
+        });
+    }
+
+    // 同样的 50 个区块 (41 笔交易) 走批量导入流水线，与上面逐个 AddBlock 对比
+    std::string name = "chain/import_50_blocks/41tx";
+    if (!runner.filter.empty() && name.find(runner.filter) == std::string::npos) return;
+    auto stream = std::make_shared<std::string>();
+    for (const Block& b : BuildSyntheticChain(BITS, 50, 20)) {
+        Bytes data = b.Serialize();
+        uint8_t header[8];
+        SpanWriter writer(header, sizeof(header));
+        WriteLE32(writer, BLOCK_FILE_MAGIC);
+        WriteLE32(writer, static_cast<uint32_t>(data.size()));
+        stream->append(reinterpret_cast<const char*>(header), sizeof(header));
+        stream->append(data.begin(), data.end());
+    }
+    runner.Run(name, "blocks", [stream]() {
+        Blockchain chain(BITS);
+        std::istringstream in(*stream);
+        return ImportBlocks(chain, in).accepted;
+    });
+}
+
+// 装满的内存池：POOL_TXS 笔互不依赖的交易，手续费各不相同，远超一个区块的容量
+struct MempoolFixture {
+    static const uint32_t POOL_TXS = 20000;
+    Blockchain chain;
+    Mempool pool;
+    std::vector<Transaction> txs;   // 按手续费从低到高
+
+    MempoolFixture() : chain(0x2000ffff), pool(chain) {
+        QuietStdout quiet;
+        Wallet alice;
+        alice.GenerateNewKey();
+        Transaction reward = MakeCoinbase(1, alice.GetPubKeyHash(), GetBlockSubsidy(1));
+        Block first(1, chain.GetTip()->hash, uint256(), GENESIS_TIMESTAMP + 1, chain.GetNextWorkRequired());
+        first.AddTransaction(reward);
+        first.FinalizeAndMine();
+        chain.AddBlock(first);
+
+        // 一笔交易拆出 POOL_TXS 个输出，每个输出再被池中的一笔交易花掉
+        Transaction fan;
+        fan.inputs.push_back({ reward.GetId(), 0, {}, {} });
+        const int64_t part = GetBlockSubsidy(1) / POOL_TXS;
+        for (uint32_t i = 0; i < POOL_TXS; i++) fan.outputs.push_back({ part, alice.GetPubKeyHash() });
+        for (auto& in : fan.inputs) in.publicKey = alice.GetPublicKey();
+        Bytes sig = alice.Sign(fan.GetSignatureHash());
+        for (auto& in : fan.inputs) in.signature = sig;
+        Block second(1, chain.GetTip()->hash, uint256(), GENESIS_TIMESTAMP + 2, chain.GetNextWorkRequired());
+        second.AddTransaction(fan);
+        second.FinalizeAndMine();
+        chain.AddBlock(second);
+
+        for (uint32_t i = 0; i < POOL_TXS; i++) {
+            txs.push_back(Spend(fan.GetId(), i, part - 1000 - i, alice, alice.GetPubKeyHash()));
+            pool.AddTransaction(txs.back());
+        }
+        pool.BuildBlockTemplate(alice.GetPubKeyHash(), GENESIS_TIMESTAMP + 3);
+    }
+};
+
+void BenchMempool(Runner& runner) {
+    // 每次操作 = 从装满的池里移除一笔交易、再加回去、取一次区块模板 (签名已在缓存中)
+    //   low_fee：手续费最低的交易，模板增量更新
+    //   high_fee：手续费最高的交易 (在模板里)，模板完整重建
+    const std::string suffix = "_update/" + std::to_string(MempoolFixture::POOL_TXS) + "tx";
+    const std::string names[2] = { "mempool/low_fee" + suffix, "mempool/high_fee" + suffix };
+    if (!runner.filter.empty() && names[0].find(runner.filter) == std::string::npos &&
+        names[1].find(runner.filter) == std::string::npos) return;
+    auto fixture = std::make_shared<MempoolFixture>();
+    for (int high = 0; high < 2; high++) {
+        const Transaction& tx = high ? fixture->txs.back() : fixture->txs.front();
+        runner.Run(names[high], "updates", [fixture, &tx]() {
+            fixture->pool.Remove(tx.GetId());
+            fixture->pool.AddTransaction(tx);
+            benchSink = fixture->pool.BuildBlockTemplate(uint160(), GENESIS_TIMESTAMP + 3).merkleRoot.data()[0];
+            return uint64_t(1);
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Runner runner;
+    std::string jsonPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) runner.filter = arg.substr(9);
+        else if (arg.rfind("--min-time=", 0) == 0) runner.minTime = std::stod(arg.substr(11));
+        else if (arg.rfind("--json=", 0) == 0) jsonPath = arg.substr(7);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter=substring] [--min-time=seconds] [--json=file]" << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        printf("%-34s %14s %14s %14s %16s\n", "benchmark", "median ns/op", "p90 ns/op", "p99 ns/op", "throughput");
+        BenchHashing(runner);
+        BenchMining(runner);
+        BenchMerkle(runner);
+        BenchSignatures(runner);
+        BenchBase58(runner);
+        BenchChain(runner);
+        BenchMempool(runner);
+        if (!jsonPath.empty()) runner.WriteJson(jsonPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,86 +1,286 @@
 ﻿#include "Block.h"
-#include <iostream>
+#include "Pow.h"
+#include "../Crypto/Sha256.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/ThreadPool.h"
 #include <cstring>
 #include <algorithm> // for std::reverse if needed
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
 
-// 辅助：将整数转为小端序字节数组
-void AppendUInt32(Bytes& data, uint32_t value) {
-    data.push_back(value & 0xFF);
-    data.push_back((value >> 8) & 0xFF);
-    data.push_back((value >> 16) & 0xFF);
-    data.push_back((value >> 24) & 0xFF);
+// 辅助：将整数以小端序写入缓冲区
+static void WriteUInt32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
 }
 
-Block::Block(int32_t ver, const Bytes& prev, const Bytes& root, uint32_t time, uint32_t difficulty_bits)
+Block::Block(int32_t ver, const uint256& prev, const uint256& root, uint32_t time, uint32_t difficulty_bits)
     : version(ver), prevBlockHash(prev), merkleRoot(root), timestamp(time), bits(difficulty_bits), nonce(0) {
 }
 
 void Block::AddTransaction(const Transaction& tx) {
-    transactions.push_back(tx);
+    AddTransaction(Transaction(tx));
 }
 
-void Block::FinalizeAndMine(uint32_t difficulty_zeros) {
+void Block::AddTransaction(Transaction&& tx) {
+    frozen = false;
+    transactions.push_back(std::move(tx));
+    transactions.back().Freeze();
+    merkleTree.Append(transactions.back().GetId());
+}
+
+uint256 Block::GetMerkleRoot() const {
+    // 如果有人绕过 AddTransaction 改了交易列表，增量树就不可信了，退回完整计算
+    if (merkleTree.Size() != transactions.size()) {
+        return ComputeMerkleRoot(transactions);
+    }
+    return merkleTree.Root();
+}
+
+void Block::RebuildMerkleTree() {
+    frozen = false;
+    merkleTree.Clear();
+    // 交易多时把重新哈希分给共享线程池 (与 ComputeMerkleRoot 的阈值相同)
+    auto refreeze = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            transactions[i].Thaw();
+            transactions[i].Freeze();
+        }
+    };
+    if (transactions.size() >= 256) {
+        ThreadPool::Shared().ParallelFor(transactions.size(), 64, refreeze);
+    }
+    else {
+        refreeze(0, transactions.size());
+    }
+    for (const auto& tx : transactions) merkleTree.Append(tx.GetId());
+}
+
+double MiningStats::HashRate() const {
+    return seconds > 0 ? totalHashes / seconds : 0.0;
+}
+
+double MiningStats::ThreadHashRate(size_t i) const {
+    return (seconds > 0 && i < threadHashes.size()) ? threadHashes[i] / seconds : 0.0;
+}
+
+MiningStats Block::FinalizeAndMine(unsigned threads) {
     // 1. 在挖矿前，根据当前的交易列表计算 Merkle Root 并填入区块头
     if (!transactions.empty()) {
-        merkleRoot = ComputeMerkleRoot(transactions);
+        frozen = false;
+        merkleRoot = GetMerkleRoot();
     }
 
     // 2. 调用之前的挖矿逻辑
-    Mine(difficulty_zeros);
+    return Mine(threads);
 }
 
-Bytes Block::Serialize() const {
-    Bytes data;
+void Block::SerializeHeader(uint8_t out[HEADER_SIZE]) const {
     // 必须严格按照比特币协议顺序拼接这 6 个字段
-    AppendUInt32(data, version);                    // 4 Bytes
-    data.insert(data.end(), prevBlockHash.begin(), prevBlockHash.end()); // 32 Bytes
-    data.insert(data.end(), merkleRoot.begin(), merkleRoot.end());       // 32 Bytes
-    AppendUInt32(data, timestamp);                  // 4 Bytes
-    AppendUInt32(data, bits);                       // 4 Bytes
-    AppendUInt32(data, nonce);                      // 4 Bytes
-    return data;
+    WriteUInt32(out, version);                          // 4 Bytes
+    memcpy(out + 4, prevBlockHash.data(), 32);          // 32 Bytes
+    memcpy(out + 36, merkleRoot.data(), 32);            // 32 Bytes
+    WriteUInt32(out + 68, timestamp);                   // 4 Bytes
+    WriteUInt32(out + 72, bits);                        // 4 Bytes
+    WriteUInt32(out + 76, nonce);                       // 4 Bytes
 }
 
-Bytes Block::GetHash() const {
-    return Hash256(Serialize());
+Bytes Block::Serialize() const {
+    Bytes data(GetSerializeSize());
+    SpanWriter writer(data.data(), data.size());
+    SerializeBlock(writer, *this);
+    return data;
 }
 
-// 简化的难度检查：这里我们暂时不解析复杂的 bits (如 0x1d00ffff)，
-// 而是简单地检查哈希值的前 N 位是否为 0。
-// 真正的比特币代码在 main.cpp 里用 bignum 比较。
-bool Block::CheckPoW(uint32_t difficulty_zeros) const {
-    Bytes hash = GetHash();
-    // 检查哈希值是小端序还是大端序？
-    // 在比特币内部计算通常用 Little Endian，但展示给人类看通常反转成 Big Endian。
-    // 这里我们简单起见，假设 hash 数组的最后一个字节是最高位（因为 Hash256 结果通常被视为大数）。
-    // 实际上，只要我们约定好即可。
-    // 让我们用最直观的方式：检查 hash 数组 **最后面** 的字节是否为 0 (因为比特币内部显示通常反转)。
-    // 为了通过下面的测试，我们简单检查哈希数组 **反转后** 的前导零个数。
+size_t Block::GetSerializeSize() const {
+    SizeComputer size;
+    SerializeBlock(size, *this);
+    return size.Size();
+}
 
-    Bytes hashReverse = hash;
-    std::reverse(hashReverse.begin(), hashReverse.end());
+Block DeserializeBlockHeader(const uint8_t header[Block::HEADER_SIZE]) {
+    SpanReader reader(header, Block::HEADER_SIZE);
+    int32_t version = static_cast<int32_t>(reader.ReadLE32());
+    uint256 prev = reader.ReadUint256();
+    uint256 root = reader.ReadUint256();
+    uint32_t time = reader.ReadLE32();
+    uint32_t bits = reader.ReadLE32();
+    Block block(version, prev, root, time, bits);
+    block.nonce = reader.ReadLE32();
+    return block;
+}
 
-    for (uint32_t i = 0; i < difficulty_zeros; i++) {
-        if (hashReverse[i] != 0) return false;
+Block DeserializeBlock(ByteView data) {
+    SpanReader reader(data);
+    Block block = DeserializeBlockHeader(reader.Read(Block::HEADER_SIZE));
+    uint64_t txCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < txCount; i++) {
+        block.AddTransaction(DeserializeTransaction(reader));
     }
-    return true;
+    if (!reader.Empty()) throw std::runtime_error("Deserialize: trailing data after block");
+    block.Freeze();
+    return block;
+}
+
+uint256 Block::GetHash() const {
+    if (frozen) return cachedHash;
+    uint8_t header[HEADER_SIZE];
+    SerializeHeader(header);
+    return Hash256(header, HEADER_SIZE);
 }
 
-void Block::Mine(uint32_t difficulty_zeros) {
-    std::cout << "Mining started... Target: " << difficulty_zeros << " leading zeros." << std::endl;
-    nonce = 0;
-    while (true) {
-        if (CheckPoW(difficulty_zeros)) {
-            std::cout << "Block Mined! Nonce: " << nonce << std::endl;
-            std::cout << "Hash: " << ToHex(GetHash()) << std::endl;
-            break;
+void Block::Freeze() {
+    if (frozen) return;
+    for (auto& tx : transactions) tx.Freeze();
+    cachedHash = GetHash();
+    frozen = true;
+}
+
+// 把 bits 解码成 256 位目标值，再把哈希当作小端序整数与它比较 (对应 v0.1.5 main.cpp 里的 bignum 比较)
+// 冻结的区块直接用缓存的哈希
+bool Block::CheckPoW() const {
+    return CheckProofOfWork(GetHash(), bits);
+}
+
+// 每个线程一次从共享计数器领取的 nonce 个数
+// 块太小会让原子计数器争用严重，太大则找到答案后其它线程要多跑一会儿
+static const uint64_t NONCE_CHUNK = 4096;
+static const uint64_t NONCE_SPACE = 1ULL << 32; // nonce 是 32 位，一共 2^32 个候选
+static const size_t MAX_MINING_LANES = 16;       // 一批最多交给 SIMD 内核的 nonce 个数 (AVX-512)
+
+// 挖矿指标 (哈希次数每个 nonce 块记一次，挖矿过程中就能看到实时哈希率)
+static MetricCounter& minedHashes = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_mining_hashes_total", "Block header hashes tried by Block::Mine");
+static MetricCounter& minedBlocks = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_mining_blocks_total", "Blocks mined by Block::Mine");
+static MetricCounter& nonceOverflows = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_mining_nonce_overflows_total", "Times the whole nonce space was exhausted and the timestamp bumped");
+static MetricGauge& lastHashRate = MetricsRegistry::Shared().GetGauge(
+    "mybitcoin_mining_hashrate", "Hash rate of the most recent Block::Mine call (H/s)");
+static MetricHistogram& mineSeconds = MetricsRegistry::Shared().GetHistogram(
+    "mybitcoin_mining_seconds", "Wall time of Block::Mine calls");
+
+// 在当前区块头上搜索一遍完整的 nonce 空间，找到时把最小的合格 nonce 写进 block.nonce
+// stop 被置位时所有线程在领取下一个 nonce 块之前退出
+static bool SearchNonceSpace(Block& block, const ArithUint256& target, unsigned threads, MiningStats& stats,
+                             const std::atomic<bool>* stop) {
+    // 各线程按顺序领取 nonce 块，找到答案后把它写进 bestNonce。
+    // 领到的块起点已经超过 bestNonce 的线程直接退出，
+    // 所以最终留下的一定是最小的合格 nonce，和单线程从 0 开始数的结果一样。
+    std::atomic<uint64_t> nextNonce(0);
+    std::atomic<uint64_t> bestNonce(NONCE_SPACE); // NONCE_SPACE 表示还没找到
+
+    auto worker = [&](unsigned id) {
+        // 每个线程只准备一份 80 字节区块头，不拷贝交易列表。
+        // nonce 只影响最后 16 字节，前 64 字节的 midstate 每轮只算一次，
+        // 之后每个 nonce 只做 2 次压缩 (原来要 3 次) 且不分配任何内存。
+        // 多个 nonce 凑成一批交给 SIMD 多路内核 (AVX2 一次 8 个)。
+        uint8_t header[Block::HEADER_SIZE];
+        block.SerializeHeader(header);
+        uint32_t midstate[8];
+        Sha256Midstate(midstate, header);
+
+        const size_t lanes = std::min<size_t>(Sha256BatchLanes(), MAX_MINING_LANES);
+        uint8_t tails[16 * MAX_MINING_LANES];
+        uint8_t hashes[32 * MAX_MINING_LANES];
+        for (size_t l = 0; l < lanes; l++) memcpy(tails + 16 * l, header + 64, 16);
+
+        uint64_t tried = 0;
+        bool found = false;
+        while (!found) {
+            if (stop && stop->load(std::memory_order_relaxed)) break;
+            uint64_t begin = nextNonce.fetch_add(NONCE_CHUNK);
+            if (begin >= NONCE_SPACE || begin >= bestNonce.load()) break;
+
+            uint64_t end = std::min(begin + NONCE_CHUNK, NONCE_SPACE);
+            uint64_t triedBefore = tried;
+            for (uint64_t n = begin; n < end && !found; n += lanes) {
+                size_t count = static_cast<size_t>(std::min<uint64_t>(lanes, end - n));
+                for (size_t l = 0; l < count; l++) {
+                    WriteUInt32(tails + 16 * l + 12, static_cast<uint32_t>(n + l));
+                }
+                Sha256D80MidstateBatch(hashes, midstate, tails, count);
+                tried += count;
+
+                // 按 nonce 从小到大检查，保证记录的是这一批里最小的合格 nonce
+                for (size_t l = 0; l < count; l++) {
+                    if (!HashMeetsTarget(hashes + 32 * l, target)) continue;
+                    uint64_t winner = n + l;
+                    uint64_t cur = bestNonce.load();
+                    while (winner < cur && !bestNonce.compare_exchange_weak(cur, winner)) {
+                    }
+                    found = true;
+                    break;
+                }
+            }
+            minedHashes.Add(tried - triedBefore);
         }
-        nonce++;
+        stats.threadHashes[id] += tried;
+    };
 
-        // 防止溢出 (实际不太可能在测试中溢出)
-        if (nonce == 0) {
-            std::cout << "Nonce overflow, updating timestamp..." << std::endl;
-            timestamp++;
+    if (threads == 1) {
+        worker(0);
+    }
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; i++) {
+            pool.emplace_back(worker, i);
         }
+        for (auto& t : pool) t.join();
     }
-}
\ No newline at end of file
+
+    if (bestNonce.load() >= NONCE_SPACE) return false;
+    block.nonce = static_cast<uint32_t>(bestNonce.load());
+    return true;
+}
+
+// 挖矿开始前的公共准备：解码目标值，确定线程数
+static ArithUint256 MiningTarget(uint32_t bits, unsigned& threads, MiningStats& stats) {
+    // 目标值只解码一次，内层循环只做逐字比较
+    ArithUint256 target;
+    if (!DecodeTarget(bits, target)) throw std::runtime_error("Mine: invalid compact target");
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    stats = MiningStats();
+    stats.threadHashes.assign(threads, 0);
+    return target;
+}
+
+static void FinishMiningStats(MiningStats& stats, std::chrono::steady_clock::time_point start, bool found) {
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (uint64_t h : stats.threadHashes) stats.totalHashes += h;
+
+    if (found) minedBlocks.Add();
+    lastHashRate.Set(stats.HashRate());
+    mineSeconds.Observe(stats.seconds);
+}
+
+MiningStats Block::Mine(unsigned threads) {
+    MiningStats stats;
+    ArithUint256 target = MiningTarget(bits, threads, stats);
+    frozen = false; // 挖矿会改 nonce / timestamp
+    auto start = std::chrono::steady_clock::now();
+
+    while (!SearchNonceSpace(*this, target, threads, stats, nullptr)) {
+        // 整个 nonce 空间都试完了 (实际不太可能在测试中溢出)
+        nonceOverflows.Add();
+        timestamp++;
+    }
+
+    FinishMiningStats(stats, start, true);
+    return stats;
+}
+
+bool Block::TryMine(MiningStats& stats, unsigned threads, const std::atomic<bool>* stop) {
+    ArithUint256 target = MiningTarget(bits, threads, stats);
+    frozen = false;
+    auto start = std::chrono::steady_clock::now();
+    bool found = SearchNonceSpace(*this, target, threads, stats, stop);
+    FinishMiningStats(stats, start, found);
+    return found;
+}
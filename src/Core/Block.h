@@ -1,6 +1,7 @@
 ﻿#ifndef BITCOIN_CORE_BLOCK_H
 #define BITCOIN_CORE_BLOCK_H
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -8,41 +9,112 @@
 #include "Transaction.h" // 新增
 #include "Merkle.h"      // 新增
 
+// 挖矿统计：总尝试次数、耗时，以及每个线程各自的尝试次数
+struct MiningStats {
+    uint64_t totalHashes = 0;             // 所有线程一共算了多少次哈希
+    double seconds = 0.0;                 // 挖矿耗时 (秒)
+    std::vector<uint64_t> threadHashes;   // 每个线程的哈希次数
+
+    // 总哈希率 (H/s)
+    double HashRate() const;
+    // 第 i 个线程的哈希率 (H/s)
+    double ThreadHashRate(size_t i) const;
+};
+
 class Block {
 public:
     // --- 1. 区块头结构 (共 80 字节) ---
     // 参考 v0.1.5 main.h 中的 CBlock
     int32_t version;            // 版本号
-    Bytes prevBlockHash;        // 前一个区块的哈希 (32字节)
-    Bytes merkleRoot;           // 交易树根哈希 (32字节)
+    uint256 prevBlockHash;      // 前一个区块的哈希 (32字节)
+    uint256 merkleRoot;         // 交易树根哈希 (32字节)
     uint32_t timestamp;         // 时间戳
-    uint32_t bits;              // 难度目标 (Target)
+    uint32_t bits;              // 难度目标 (compact 格式的 256 位目标值，见 Pow.h)
     uint32_t nonce;             // 随机数 (矿工唯一能改的东西)
     // [新增] 交易列表本体
     std::vector<Transaction> transactions;
 
     // --- 构造函数 ---
-    Block(int32_t ver, const Bytes& prev, const Bytes& root, uint32_t time, uint32_t difficulty_bits);
+    Block(int32_t ver, const uint256& prev, const uint256& root, uint32_t time, uint32_t difficulty_bits);
 
     // --- 2. 核心功能 ---
     // 
-    // [新增] 添加交易
+    // [新增] 添加交易 (同时增量更新默克尔树，O(log n) 次哈希)
+    // 区块里保存的是冻结的副本，txid 只算这一次
     void AddTransaction(const Transaction& tx);
+    void AddTransaction(Transaction&& tx);
+
+    // 当前交易列表的默克尔根，直接从增量默克尔树读出，不需要重新哈希已有交易
+    uint256 GetMerkleRoot() const;
+
+    // 直接修改过 transactions (而不是通过 AddTransaction) 后调用：
+    // 重新冻结每笔交易 (丢弃过期的 txid 缓存) 并重建增量默克尔树
+    void RebuildMerkleTree();
+
+    // 增量默克尔树 (含缓存的全部 txid)，生成默克尔证明时使用
+    const MerkleFrontier& GetMerkleTree() const { return merkleTree; }
 
     // [修改] 挖矿前，先计算 Merkle Root
-    void FinalizeAndMine(uint32_t difficulty_zeros);
+    MiningStats FinalizeAndMine(unsigned threads = 1);
 
-    // 序列化：将区块头转为字节流 (用于计算哈希)
+    // 序列化整个区块 (区块头 + 全部交易)，先算出准确长度再一次写完
     Bytes Serialize() const;
 
-    // 计算当前区块的哈希 ID (即 Hash256(Serialize()))
-    Bytes GetHash() const;
+    // 序列化后的字节数
+    size_t GetSerializeSize() const;
+
+    // 区块头固定 80 字节
+    static const size_t HEADER_SIZE = 80;
+
+    // 序列化到调用方提供的 80 字节缓冲区 (不分配内存，挖矿用)
+    void SerializeHeader(uint8_t out[HEADER_SIZE]) const;
 
-    // 挖矿函数：不断修改 nonce，直到 GetHash() < Target
-    void Mine(uint32_t difficulty_bits);
+    // 计算当前区块的哈希 ID (即对 80 字节区块头做 Hash256)，冻结后直接返回缓存
+    uint256 GetHash() const;
 
-    // 辅助：检查当前哈希是否满足难度
-    bool CheckPoW(uint32_t difficulty_bits) const;
+    // --- 哈希缓存 ---
+    // Freeze() 算好区块哈希并缓存；冻结后不能直接改区块头字段，要改先 Thaw()。
+    // Mine / FinalizeAndMine / AddTransaction / RebuildMerkleTree 会自动解冻。
+    void Freeze();
+    void Thaw() { frozen = false; }
+    bool IsFrozen() const { return frozen; }
+
+    // 挖矿函数：不断修改 nonce，直到 GetHash() <= bits 解码出的目标值
+    // threads: 并行搜索 nonce 的线程数 (1 = 单线程，0 = 使用全部 CPU 核心)
+    // 多线程时 nonce 空间按小块分给各线程，找到的 nonce 与单线程结果完全一致 (最小的合格 nonce)
+    // bits 不合法 (负数、溢出或为 0) 时抛异常
+    MiningStats Mine(unsigned threads = 1);
+
+    // 只搜索一遍 nonce 空间，不改 timestamp：找到时填好 nonce 返回 true，
+    // 全部试完或 stop 被置位 (另一个线程可以随时取消) 时返回 false
+    // 由调用方换一个 extranonce (见 WorkUnit.h) 或时间戳后再试
+    bool TryMine(MiningStats& stats, unsigned threads = 1, const std::atomic<bool>* stop = nullptr);
+
+    // 辅助：检查当前哈希是否满足区块头里的 bits
+    bool CheckPoW() const;
+
+private:
+    bool frozen = false;
+    uint256 cachedHash;
+
+    // 与 transactions 同步维护的增量默克尔树
+    MerkleFrontier merkleTree;
 };
 
+// 完整区块的序列化格式：80 字节区块头 + [CompactSize 交易数] + 每笔交易
+template <typename Stream>
+void SerializeBlock(Stream& s, const Block& block) {
+    uint8_t header[Block::HEADER_SIZE];
+    block.SerializeHeader(header);
+    s.Write(header, Block::HEADER_SIZE);
+    WriteCompactSize(s, block.transactions.size());
+    for (const auto& tx : block.transactions) SerializeTransaction(s, tx);
+}
+
+// 从 80 字节区块头还原 (交易列表为空)
+Block DeserializeBlockHeader(const uint8_t header[Block::HEADER_SIZE]);
+
+// 解析整个区块，data 必须正好是一个区块，格式不对时抛异常
+Block DeserializeBlock(ByteView data);
+
 #endif //BITCOIN_CORE_BLOCK_H
\ No newline at end of file
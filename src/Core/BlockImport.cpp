@@ -0,0 +1,330 @@
+﻿#include "BlockImport.h"
+#include "Blockchain.h"
+#include "BlockStore.h"
+#include "SignatureCheck.h"
+#include "TransactionView.h"
+#include "../Utils/BoundedQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 流水线中的一条记录
+struct ImportItem {
+    uint64_t seq = 0;                  // 读入顺序
+    Bytes data;                        // 原始字节 (检查完就释放)
+    std::unique_ptr<Block> block;      // 通过无状态检查的区块；为空表示这条记录无效
+};
+
+uint32_t ReadMagic(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 从流中切出记录
+// 长度字段看起来合理但内容不是一个完整区块 (损坏、截断或者恰好出现的魔数) 时，
+// 把长度字段和读进来的字节退回去，从魔数后面继续找，不会把紧跟在后面的有效记录一起跳过
+class RecordReader {
+public:
+    explicit RecordReader(std::istream& in) : in(in) {}
+
+    // 读出下一条记录，流结束返回 false；格式不对的记录 data 为空 (照样计数，交给后面当作无效记录)
+    bool Next(Bytes& data) {
+        uint8_t window[4];
+        if (Get(window, 4) != 4) return false;
+        while (true) {
+            // 找魔数：不对就向后移一个字节
+            while (ReadMagic(window) != BLOCK_FILE_MAGIC) {
+                uint8_t c;
+                if (Get(&c, 1) != 1) return false;
+                memmove(window, window + 1, 3);
+                window[3] = c;
+            }
+            // 魔数的 4 个字节各不相同，从魔数 +1 到 +3 开始不可能再是魔数，所以直接从长度字段继续找
+            uint8_t len[4];
+            if (Get(len, 4) != 4) return false;
+            uint32_t length = ReadMagic(len);
+            if (length < Block::HEADER_SIZE || length > MAX_SERIALIZED_SIZE) {
+                // 长度不可能是区块
+                memcpy(window, len, 4);
+                continue;
+            }
+            data.resize(length);
+            size_t got = Get(data.data(), length);
+            if (got == length) {
+                try {
+                    BlockView view{ByteView(data)};
+                    return true;
+                }
+                catch (const std::exception&) {
+                }
+            }
+            // 内容不是区块或者流提前结束：退回长度字段和读到的字节，从长度字段开始重新找
+            data.insert(data.begin(), len, len + 4);
+            data.resize(4 + got);
+            Unget(data);
+            data.clear();
+            if (got == length) return true;
+            if (Get(window, 4) != 4) return false;
+        }
+    }
+
+private:
+    // 先取退回的字节，再从流里读；返回实际取到的字节数
+    size_t Get(uint8_t* out, size_t n) {
+        size_t got = std::min(n, pending.size() - pendingPos);
+        memcpy(out, pending.data() + pendingPos, got);
+        pendingPos += got;
+        if (got < n) {
+            in.read(reinterpret_cast<char*>(out + got), n - got);
+            got += static_cast<size_t>(in.gcount());
+        }
+        return got;
+    }
+
+    void Unget(const Bytes& bytes) {
+        Bytes rest;
+        rest.reserve(bytes.size() + pending.size() - pendingPos);
+        rest.insert(rest.end(), bytes.begin(), bytes.end());
+        rest.insert(rest.end(), pending.begin() + pendingPos, pending.end());
+        pending.swap(rest);
+        pendingPos = 0;
+    }
+
+    std::istream& in;
+    Bytes pending;           // 退回的字节
+    size_t pendingPos = 0;
+};
+
+// 不依赖链状态的检查：解析 (顺便算好全部 txid 和区块哈希)、PoW、默克尔根、签名
+// 便宜的检查在前，任何一项失败都返回 nullptr
+std::unique_ptr<Block> CheckStateless(const Bytes& data, SigCache* cache) {
+    std::unique_ptr<Block> block;
+    try {
+        block = std::make_unique<Block>(DeserializeBlock(ByteView(data)));
+    }
+    catch (const std::exception&) {
+        return nullptr;
+    }
+    if (!block->CheckPoW()) return nullptr;
+    // 解析时已经逐笔追加进增量默克尔树，这里直接读出根
+    if (block->GetMerkleRoot() != block->merkleRoot) return nullptr;
+
+    for (const auto& tx : block->transactions) {
+        if (tx.IsCoinBase()) continue;
+        uint256 sighash = tx.GetSignatureHash();
+        for (const auto& in : tx.inputs) {
+            SignatureCheck check;
+            check.publicKey = &in.publicKey;
+            check.signature = &in.signature;
+            check.hash = sighash;
+            check.cache = cache;
+            if (!check.Verify()) return nullptr;
+        }
+    }
+    return block;
+}
+
+// 检查完的记录按读入顺序交给应用阶段
+// 只接收 [next, next + capacity) 范围内的记录，跑得太靠前的检查线程在这里等，内存占用有上限
+class ReorderWindow {
+public:
+    explicit ReorderWindow(size_t capacity) : capacity(capacity ? capacity : 1) {}
+
+    void Put(ImportItem item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        hasSpace.wait(lock, [&]() { return closed || item.seq < next + capacity; });
+        if (closed) return;
+        ready.emplace(item.seq, std::move(item));
+        hasNext.notify_one();
+    }
+
+    // 取出下一条；total 是全部记录数 (读取结束前为 UINT64_MAX)，全部取完返回 false
+    bool Take(ImportItem& item, const std::atomic<uint64_t>& total) {
+        std::unique_lock<std::mutex> lock(mutex);
+        hasNext.wait(lock, [&]() { return closed || ready.count(next) || next >= total.load(); });
+        auto it = ready.find(next);
+        if (it == ready.end()) return false;
+        item = std::move(it->second);
+        ready.erase(it);
+        next++;
+        hasSpace.notify_all();
+        return true;
+    }
+
+    // 读取结束 (total 已经确定) 时唤醒应用阶段
+    void Notify() {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasNext.notify_all();
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        hasSpace.notify_all();
+        hasNext.notify_all();
+    }
+
+private:
+    size_t capacity;
+    uint64_t next = 0;
+    bool closed = false;
+    std::map<uint64_t, ImportItem> ready;
+    std::mutex mutex;
+    std::condition_variable hasSpace;
+    std::condition_variable hasNext;
+};
+
+} // namespace
+
+ImportStats ImportBlocks(Blockchain& chain, std::istream& in, const ImportOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    unsigned threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    BoundedQueue<ImportItem> raw(options.queueSize);
+    ReorderWindow window(options.queueSize);
+    std::atomic<uint64_t> total(UINT64_MAX);
+    std::exception_ptr readError;
+
+    // 1. 读取：只切分记录，不解析
+    std::thread reader([&]() {
+        uint64_t seq = 0;
+        try {
+            RecordReader records(in);
+            Bytes data;
+            while (records.Next(data)) {
+                ImportItem item;
+                item.seq = seq;
+                item.data = std::move(data);
+                if (!raw.Push(std::move(item))) break;
+                seq++;
+            }
+            if (in.bad()) throw std::runtime_error("ImportBlocks: read error");
+        }
+        catch (...) {
+            readError = std::current_exception();
+        }
+        total = seq;
+        raw.Close();
+        window.Notify();
+    });
+
+    // 2. 无状态检查：各个区块互不依赖，多个线程同时做
+    std::vector<std::thread> checkers;
+    for (unsigned i = 0; i < threads; i++) {
+        checkers.emplace_back([&]() {
+            ImportItem item;
+            while (raw.Pop(item)) {
+                item.block = CheckStateless(item.data, options.sigCache);
+                item.data = Bytes();
+                window.Put(std::move(item));
+            }
+        });
+    }
+
+    // 3. 应用：在调用线程里按读入顺序串行进行
+    ImportStats stats;
+    std::unordered_multimap<uint256, std::unique_ptr<Block>> orphans; // 按父区块哈希暂存
+    size_t orphanBytes = 0;                                            // 暂存孤块的序列化大小之和
+    auto apply = [&](std::unique_ptr<Block> first) {
+        std::vector<std::unique_ptr<Block>> pending;
+        pending.push_back(std::move(first));
+        while (!pending.empty()) {
+            std::unique_ptr<Block> block = std::move(pending.back());
+            pending.pop_back();
+            uint256 hash = block->GetHash();
+            if (chain.LookupBlock(hash)) {
+                stats.duplicate++;
+                continue;
+            }
+            if (!chain.LookupBlock(block->prevBlockHash)) {
+                // 超过上限的直接丢弃，计入 orphaned
+                size_t size = block->GetSerializeSize();
+                if (orphanBytes + size > options.maxOrphanBytes) {
+                    stats.orphaned++;
+                    continue;
+                }
+                orphanBytes += size;
+                uint256 prev = block->prevBlockHash;
+                orphans.emplace(prev, std::move(block));
+                continue;
+            }
+            try {
+                chain.AddPrevalidatedBlock(std::move(*block));
+                stats.accepted++;
+            }
+            catch (const std::exception&) {
+                stats.invalid++;
+                continue;
+            }
+            // 等着这个区块的孤块现在可以接上了
+            auto range = orphans.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                orphanBytes -= it->second->GetSerializeSize();
+                pending.push_back(std::move(it->second));
+            }
+            orphans.erase(range.first, range.second);
+        }
+    };
+
+    std::exception_ptr applyError;
+    try {
+        ImportItem item;
+        while (window.Take(item, total)) {
+            stats.read++;
+            if (!item.block) {
+                stats.invalid++;
+                continue;
+            }
+            apply(std::move(item.block));
+        }
+    }
+    catch (...) {
+        applyError = std::current_exception();
+    }
+
+    // 出错时让其余阶段尽快停下
+    raw.Close();
+    window.Close();
+    reader.join();
+    for (auto& t : checkers) t.join();
+    if (applyError) std::rethrow_exception(applyError);
+    if (readError) std::rethrow_exception(readError);
+
+    stats.orphaned += orphans.size();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+ImportStats ImportBlocksFromFile(Blockchain& chain, const std::string& path, const ImportOptions& options) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("ImportBlocks: cannot open " + path);
+    return ImportBlocks(chain, in, options);
+}
+
+void ExportBlocks(const Blockchain& chain, std::ostream& out) {
+    for (uint32_t height = 1; height <= chain.GetHeight(); height++) {
+        Bytes data = chain.GetBlockBytes(chain.GetBlockAtHeight(height));
+        uint8_t header[8];
+        SpanWriter writer(header, sizeof(header));
+        WriteLE32(writer, BLOCK_FILE_MAGIC);
+        WriteLE32(writer, static_cast<uint32_t>(data.size()));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    if (!out) throw std::runtime_error("ExportBlocks: write failed");
+}
@@ -0,0 +1,47 @@
+﻿#ifndef BITCOIN_CORE_BLOCKIMPORT_H
+#define BITCOIN_CORE_BLOCKIMPORT_H
+
+#include "Block.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+class Blockchain;
+class SigCache;
+
+// 批量导入的参数
+struct ImportOptions {
+    unsigned threads = 0;          // 做无状态检查 (解析、PoW、默克尔根、签名) 的线程数，0 = CPU 核心数
+    size_t queueSize = 64;         // 读取队列和等待按顺序应用的区块各自最多缓存多少个 (限制内存占用)
+    SigCache* sigCache = nullptr;  // 签名检查先查这个缓存 (只查不写)，为空时不用缓存
+    size_t maxOrphanBytes = 64 * 1024 * 1024; // 暂存的孤块 (序列化大小) 最多占多少字节，超过后新来的孤块直接丢弃
+};
+
+// 导入结果
+struct ImportStats {
+    uint64_t read = 0;         // 读到的记录数
+    uint64_t accepted = 0;     // 加入索引的区块 (主链或分叉)
+    uint64_t duplicate = 0;    // 已经在索引里的区块
+    uint64_t invalid = 0;      // 解析失败或验证失败的记录
+    uint64_t orphaned = 0;     // 直到最后也没有找到父区块的区块 (包括超过暂存上限被丢弃的)
+    double seconds = 0.0;
+};
+
+// 从流中批量导入区块 (对应 Bitcoin Core 的 -loadblock / LoadExternalBlockFile)
+// 每条记录 = 魔数 BLOCK_FILE_MAGIC (4) + 长度 (4) + 序列化的区块，与区块文件 blk?????.dat 的格式相同。
+// 流水线：读取线程按顺序切出记录 -> [有界队列] -> threads 个线程并行解析并做无状态检查
+//         -> [有界的重排窗口] -> 调用线程按读入顺序应用到链上 (依赖链状态的部分只能串行)。
+// 父区块还没出现的区块先暂存，父区块接上后立即处理 (区块文件里的区块不一定按高度排列)；
+// 暂存的总量受 maxOrphanBytes 限制，逆序或乱序严重的流只能导入一部分，可以再导入一遍补上。
+// 魔数不对时逐字节向后寻找下一条记录；记录内容不是完整区块时从它的魔数之后重新寻找 (不会连带跳过后面的有效记录)，
+// 末尾不完整的记录忽略；读取出错时抛异常 (已经应用的区块保留)。
+ImportStats ImportBlocks(Blockchain& chain, std::istream& in, const ImportOptions& options = ImportOptions());
+
+// 同上，从文件读取；文件打不开时抛异常
+ImportStats ImportBlocksFromFile(Blockchain& chain, const std::string& path,
+                                 const ImportOptions& options = ImportOptions());
+
+// 把主链上创世区块之后的全部区块按高度写成导入格式 (交给另一个节点快速重放)
+void ExportBlocks(const Blockchain& chain, std::ostream& out);
+
+#endif //BITCOIN_CORE_BLOCKIMPORT_H
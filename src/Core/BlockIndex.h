@@ -0,0 +1,34 @@
+﻿#ifndef BITCOIN_CORE_BLOCKINDEX_H
+#define BITCOIN_CORE_BLOCKINDEX_H
+
+#include "Block.h"
+#include "BlockStore.h"
+#include "UtxoSet.h"
+#include "../Crypto/ArithUint256.h"
+#include <utility>
+
+// 区块索引中的一项 (对应 v0.1.5 main.h 中的 CBlockIndex)
+// 主链和分叉上的区块都在索引里，通过 prev 指针连成一棵以创世区块为根的树。
+// 哈希、高度和累计工作量在加入索引时算好，之后查询不需要重新哈希区块头。
+struct BlockIndex {
+    uint256 hash;                  // 缓存的区块哈希
+    BlockIndex* prev = nullptr;    // 父区块 (创世区块为空)
+    uint32_t height = 0;
+    ArithUint256 chainWork;        // 从创世区块到这里的累计工作量 (期望哈希次数，精确的 256 位整数)
+
+    bool signaturesChecked = false; // 签名已经完整验证过一次，重组时再连接不必重新验证
+    bool failed = false;            // 连接时验证失败 (或被手动断开)，它和它的后代不会再成为主链
+
+    // 区块数据。有磁盘存储时这里只留区块头 (dataLoaded = false)，内存占用不随交易数增长；
+    // 交易列表用到时再从区块文件读出 (见 Blockchain::BlockData)
+    Block block;
+    bool dataLoaded = true;
+    BlockUndo undo;                // 只在主链上时有效 (有磁盘存储时撤销数据只放在磁盘上)
+
+    BlockFilePos blockPos;         // 在区块文件中的位置 (没有磁盘存储时为空)
+    BlockFilePos undoPos;          // 撤销数据的位置
+
+    explicit BlockIndex(Block b) : block(std::move(b)) {}
+};
+
+#endif //BITCOIN_CORE_BLOCKINDEX_H
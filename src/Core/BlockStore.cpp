@@ -0,0 +1,313 @@
+﻿#include "BlockStore.h"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint32_t CHAINSTATE_MAGIC = 0x4F545855;   // "UTXO"
+const size_t RECORD_HEADER_SIZE = 8;            // 魔数 + 长度
+
+// 索引文件的记录类型
+const uint8_t INDEX_BLOCK = 'B';    // 哈希 + 区块头 + 位置
+const uint8_t INDEX_UNDO = 'U';     // 哈希 + 撤销数据位置
+const uint8_t INDEX_FAILED = 'F';   // 哈希
+const size_t INDEX_BLOCK_SIZE = 1 + 32 + Block::HEADER_SIZE + 12;
+const size_t INDEX_UNDO_SIZE = 1 + 32 + 12;
+const size_t INDEX_FAILED_SIZE = 1 + 32;
+const size_t CHAINSTATE_HEADER_SIZE = 4 + 32 + 8;  // 魔数 + 链尾哈希 + UTXO 数量
+const size_t COIN_RECORD_SIZE = 32 + 4 + 8 + 20 + 4 + 1; // WriteCoin 写出的一条记录
+
+template <typename Stream>
+void WritePos(Stream& s, const BlockFilePos& pos) {
+    WriteLE32(s, pos.file);
+    WriteLE32(s, pos.offset);
+    WriteLE32(s, pos.length);
+}
+
+BlockFilePos ReadPos(SpanReader& r) {
+    BlockFilePos pos;
+    pos.file = r.ReadLE32();
+    pos.offset = r.ReadLE32();
+    pos.length = r.ReadLE32();
+    return pos;
+}
+
+template <typename Stream>
+void WriteCoin(Stream& s, const OutPoint& outpoint, const Coin& coin) {
+    WriteBlob(s, outpoint.txid);
+    WriteLE32(s, outpoint.index);
+    WriteLE64(s, static_cast<uint64_t>(coin.out.value));
+    WriteBlob(s, coin.out.pubKeyHash);
+    WriteLE32(s, coin.height);
+    WriteU8(s, coin.coinbase ? 1 : 0);
+}
+
+void ReadCoin(SpanReader& r, OutPoint& outpoint, Coin& coin) {
+    outpoint.txid = r.ReadUint256();
+    outpoint.index = r.ReadLE32();
+    coin.out.value = static_cast<int64_t>(r.ReadLE64());
+    coin.out.pubKeyHash = r.ReadUint160();
+    coin.height = r.ReadLE32();
+    coin.coinbase = r.ReadU8() != 0;
+}
+
+} // namespace
+
+BlockStore::BlockStore(const std::string& dir, uint32_t maxFileSize)
+    : dir(dir), maxFileSize(maxFileSize) {
+    fs::create_directories(dir);
+
+    // 找到编号最大的区块文件，继续往里追加
+    while (fs::exists(FilePath(currentFile + 1))) currentFile++;
+    maps.resize(currentFile + 1);
+    if (fs::exists(FilePath(currentFile))) {
+        currentSize = static_cast<uint32_t>(fs::file_size(FilePath(currentFile)));
+    }
+    blockFile = std::fopen(FilePath(currentFile).c_str(), "ab");
+    if (!blockFile) throw std::runtime_error("BlockStore: cannot open " + FilePath(currentFile));
+
+    LoadIndex();
+    indexFile = std::fopen((fs::path(dir) / "index.dat").string().c_str(), "ab");
+    if (!indexFile) throw std::runtime_error("BlockStore: cannot open index in " + dir);
+}
+
+BlockStore::~BlockStore() {
+    if (blockFile) std::fclose(blockFile);
+    if (indexFile) std::fclose(indexFile);
+}
+
+std::string BlockStore::FilePath(uint32_t file) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "blk%05u.dat", file);
+    return (fs::path(dir) / name).string();
+}
+
+void BlockStore::LoadIndex() {
+    std::string path = (fs::path(dir) / "index.dat").string();
+    if (!fs::exists(path)) return;
+
+    MappedFile index;
+    index.Open(path);
+    SpanReader r(index.Data(), index.Size());
+    std::unordered_map<uint256, size_t> byHash;
+    size_t good = 0; // 最后一条完整记录的结尾
+
+    while (!r.Empty()) {
+        uint8_t type = r.ReadU8();
+        size_t need = type == INDEX_BLOCK ? INDEX_BLOCK_SIZE : type == INDEX_UNDO ? INDEX_UNDO_SIZE
+            : type == INDEX_FAILED ? INDEX_FAILED_SIZE : 0;
+        if (need == 0) throw std::runtime_error("BlockStore: corrupt index record");
+        // 上次写到一半就退出了：丢掉残缺的尾巴
+        if (r.Remaining() < need - 1) break;
+
+        uint256 hash = r.ReadUint256();
+        if (type == INDEX_BLOCK) {
+            StoredBlockInfo info;
+            info.hash = hash;
+            info.header = DeserializeBlockHeader(r.Read(Block::HEADER_SIZE));
+            info.blockPos = ReadPos(r);
+            auto it = byHash.find(hash);
+            if (it == byHash.end()) {
+                byHash.emplace(hash, loaded.size());
+                loaded.push_back(info);
+            }
+            else if (loaded[it->second].failed) {
+                // 被拒绝过的区块又被提交并重新验证过：以新的记录为准 (之后的 'F' 记录仍会再次标记)
+                // 原地替换，父区块在前的顺序不变 (同一个哈希的父区块也相同)
+                loaded[it->second] = info;
+            }
+        }
+        else {
+            auto it = byHash.find(hash);
+            if (it == byHash.end()) throw std::runtime_error("BlockStore: index record for unknown block");
+            if (type == INDEX_UNDO) loaded[it->second].undoPos = ReadPos(r);
+            else loaded[it->second].failed = true;
+        }
+        good += need;
+    }
+
+    if (good != index.Size()) {
+        index.Close();
+        fs::resize_file(path, good);
+    }
+}
+
+BlockFilePos BlockStore::Append(const Bytes& payload) {
+    // 写入之前发出的视图到这里就失效了，被替换掉的旧映射可以解除 (否则每次读到新追加的数据都会多留一份映射)
+    retired.clear();
+
+    // 当前文件放不下就换一个新文件 (空文件总是可以写，哪怕单条记录超过上限)
+    if (currentSize > 0 && currentSize + RECORD_HEADER_SIZE + payload.size() > maxFileSize) {
+        std::fclose(blockFile);
+        currentFile++;
+        currentSize = 0;
+        maps.resize(currentFile + 1);
+        blockFile = std::fopen(FilePath(currentFile).c_str(), "ab");
+        if (!blockFile) throw std::runtime_error("BlockStore: cannot open " + FilePath(currentFile));
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    SpanWriter writer(header, sizeof(header));
+    WriteLE32(writer, BLOCK_FILE_MAGIC);
+    WriteLE32(writer, static_cast<uint32_t>(payload.size()));
+    if (std::fwrite(header, 1, sizeof(header), blockFile) != sizeof(header) ||
+        std::fwrite(payload.data(), 1, payload.size(), blockFile) != payload.size()) {
+        throw std::runtime_error("BlockStore: write failed");
+    }
+
+    BlockFilePos pos;
+    pos.file = currentFile;
+    pos.offset = currentSize + static_cast<uint32_t>(RECORD_HEADER_SIZE);
+    pos.length = static_cast<uint32_t>(payload.size());
+    currentSize += static_cast<uint32_t>(RECORD_HEADER_SIZE + payload.size());
+    return pos;
+}
+
+void BlockStore::AppendIndex(const Bytes& record) {
+    // 索引记录写在数据之后：崩溃时最多丢掉索引里的最后一条，不会指向不存在的数据
+    std::fflush(blockFile);
+    if (std::fwrite(record.data(), 1, record.size(), indexFile) != record.size()) {
+        throw std::runtime_error("BlockStore: index write failed");
+    }
+    std::fflush(indexFile);
+}
+
+BlockFilePos BlockStore::WriteBlock(const Block& block, const uint256& hash) {
+    Bytes payload = block.Serialize();
+    BlockFilePos pos = Append(payload);
+
+    Bytes record(INDEX_BLOCK_SIZE);
+    SpanWriter writer(record.data(), record.size());
+    WriteU8(writer, INDEX_BLOCK);
+    WriteBlob(writer, hash);
+    writer.Write(payload.data(), Block::HEADER_SIZE); // 区块本体正好以区块头开头
+    WritePos(writer, pos);
+    AppendIndex(record);
+    return pos;
+}
+
+BlockFilePos BlockStore::WriteUndo(const uint256& hash, const BlockUndo& undo) {
+    Bytes payload;
+    VectorWriter out(payload);
+    WriteCompactSize(out, undo.spent.size());
+    for (const auto& s : undo.spent) WriteCoin(out, s.first, s.second);
+    BlockFilePos pos = Append(payload);
+
+    Bytes record(INDEX_UNDO_SIZE);
+    SpanWriter writer(record.data(), record.size());
+    WriteU8(writer, INDEX_UNDO);
+    WriteBlob(writer, hash);
+    WritePos(writer, pos);
+    AppendIndex(record);
+    return pos;
+}
+
+void BlockStore::MarkFailed(const uint256& hash) {
+    Bytes record(INDEX_FAILED_SIZE);
+    SpanWriter writer(record.data(), record.size());
+    WriteU8(writer, INDEX_FAILED);
+    WriteBlob(writer, hash);
+    AppendIndex(record);
+}
+
+ByteView BlockStore::Read(const BlockFilePos& pos) {
+    if (pos.IsNull() || pos.file >= maps.size()) {
+        throw std::runtime_error("BlockStore: invalid block position");
+    }
+    uint64_t end = (uint64_t)pos.offset + pos.length;
+
+    // 映射还没建立，或者建立之后文件又追加过：重新映射 (旧映射保留到下一次写入，在此之前发出的视图仍然有效)
+    auto& map = maps[pos.file];
+    if (!map || map->Size() < end) {
+        if (pos.file == currentFile) std::fflush(blockFile);
+        auto fresh = std::make_unique<MappedFile>();
+        fresh->Open(FilePath(pos.file));
+        if (map) retired.push_back(std::move(map));
+        map = std::move(fresh);
+        if (map->Size() < end) throw std::runtime_error("BlockStore: block position out of range");
+    }
+
+    if (pos.offset < RECORD_HEADER_SIZE) throw std::runtime_error("BlockStore: corrupt block file record");
+    SpanReader header(map->Data() + pos.offset - RECORD_HEADER_SIZE, RECORD_HEADER_SIZE);
+    if (header.ReadLE32() != BLOCK_FILE_MAGIC || header.ReadLE32() != pos.length) {
+        throw std::runtime_error("BlockStore: corrupt block file record");
+    }
+
+    ByteView view;
+    view.data = map->Data() + pos.offset;
+    view.size = pos.length;
+    return view;
+}
+
+Block BlockStore::ReadBlock(const BlockFilePos& pos) {
+    return DeserializeBlock(Read(pos));
+}
+
+BlockUndo BlockStore::ReadUndo(const BlockFilePos& pos) {
+    SpanReader r(Read(pos));
+    BlockUndo undo;
+    uint64_t count = r.ReadCompactSize();
+    for (uint64_t i = 0; i < count; i++) {
+        std::pair<OutPoint, Coin> spent;
+        ReadCoin(r, spent.first, spent.second);
+        undo.spent.push_back(std::move(spent));
+    }
+    return undo;
+}
+
+void BlockStore::WriteChainState(const uint256& tip, const UtxoSet& utxo) {
+    Bytes data;
+    VectorWriter out(data);
+    WriteLE32(out, CHAINSTATE_MAGIC);
+    WriteBlob(out, tip);
+    WriteLE64(out, utxo.Size());
+    utxo.ForEach([&](const OutPoint& outpoint, const Coin& coin) { WriteCoin(out, outpoint, coin); });
+
+    // 先写临时文件再改名，崩溃时不会留下写了一半的快照
+    fs::path path = fs::path(dir) / "chainstate.dat";
+    fs::path tmp = fs::path(dir) / "chainstate.dat.tmp";
+    std::FILE* f = std::fopen(tmp.string().c_str(), "wb");
+    if (!f) throw std::runtime_error("BlockStore: cannot write chainstate");
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) throw std::runtime_error("BlockStore: cannot write chainstate");
+    fs::rename(tmp, path);
+}
+
+bool BlockStore::ReadChainState(uint256& tip, UtxoSet& utxo) {
+    std::string path = (fs::path(dir) / "chainstate.dat").string();
+    if (!fs::exists(path)) return false;
+
+    MappedFile file;
+    file.Open(path);
+    try {
+        SpanReader r(file.Data(), file.Size());
+        if (r.ReadLE32() != CHAINSTATE_MAGIC) return false;
+        tip = r.ReadUint256();
+        uint64_t count = r.ReadLE64();
+        // 数量来自文件本身，先和文件大小对上再按它分配哈希表，损坏的数量不会导致溢出或巨量分配
+        if (count > (file.Size() - CHAINSTATE_HEADER_SIZE) / COIN_RECORD_SIZE) return false;
+        UtxoSet fresh(static_cast<size_t>(count * 8 / 7 + 16));
+        for (uint64_t i = 0; i < count; i++) {
+            OutPoint outpoint;
+            Coin coin;
+            ReadCoin(r, outpoint, coin);
+            if (!fresh.Add(outpoint, coin)) return false;
+        }
+        if (!r.Empty()) return false;
+        utxo = std::move(fresh);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+void BlockStore::Flush() {
+    if (blockFile) std::fflush(blockFile);
+    if (indexFile) std::fflush(indexFile);
+}
@@ -0,0 +1,105 @@
+﻿#ifndef BITCOIN_CORE_BLOCKSTORE_H
+#define BITCOIN_CORE_BLOCKSTORE_H
+
+#include "Block.h"
+#include "TransactionView.h"
+#include "UtxoSet.h"
+#include "../Utils/MappedFile.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 每条区块文件记录的开头 (与比特币主网魔数相同)，批量导入的区块流也用同样的记录格式
+static const uint32_t BLOCK_FILE_MAGIC = 0xD9B4BEF9;
+
+// 数据在区块文件中的位置 (对应 Bitcoin Core 的 FlatFilePos)
+struct BlockFilePos {
+    uint32_t file = 0;     // blk?????.dat 的编号
+    uint32_t offset = 0;   // 数据起点 (已跳过记录头)
+    uint32_t length = 0;   // 0 表示不在磁盘上
+
+    bool IsNull() const { return length == 0; }
+};
+
+// 启动时从索引文件读出的一个区块
+struct StoredBlockInfo {
+    uint256 hash;
+    Block header;              // 只有区块头，交易列表为空
+    BlockFilePos blockPos;
+    BlockFilePos undoPos;      // 连接到主链时写入的撤销数据 (从没连接过则为空)
+    bool failed = false;
+
+    StoredBlockInfo() : header(0, uint256(), uint256(), 0, 0) {}
+};
+
+// 只追加的磁盘区块存储
+// 目录布局：
+//   blk00000.dat, blk00001.dat ...  区块和撤销数据，每条记录 = 魔数(4) + 长度(4) + 数据，单个文件不超过 maxFileSize
+//   index.dat                       紧凑的索引：每个区块一条 (哈希 + 80 字节区块头 + 位置)，另有撤销数据和无效标记的记录
+//   chainstate.dat                  最近一次 Flush 时的 UTXO 快照和对应的链尾哈希
+// 启动时只读索引文件 (不解析区块本体)，读取区块时直接在内存映射上解码。
+// 非线程安全，由 Blockchain 串行调用。
+class BlockStore {
+public:
+    static const uint32_t DEFAULT_MAX_FILE_SIZE = 128 * 1024 * 1024;
+
+    // 打开 (不存在就创建) 目录 dir，读出索引
+    explicit BlockStore(const std::string& dir, uint32_t maxFileSize = DEFAULT_MAX_FILE_SIZE);
+    ~BlockStore();
+
+    BlockStore(const BlockStore&) = delete;
+    BlockStore& operator=(const BlockStore&) = delete;
+
+    // 打开时读出的索引，按写入顺序 (父区块总在子区块前面)
+    const std::vector<StoredBlockInfo>& LoadedIndex() const { return loaded; }
+
+    // 追加一个区块，并在索引里记下它的位置
+    BlockFilePos WriteBlock(const Block& block, const uint256& hash);
+
+    // 追加一个区块的撤销数据
+    BlockFilePos WriteUndo(const uint256& hash, const BlockUndo& undo);
+
+    // 记录区块无效 (重启后也不会再被选为主链)
+    void MarkFailed(const uint256& hash);
+
+    // 读取原始数据 (零拷贝，指向映射内存)，位置越界或记录损坏时抛异常
+    // 视图在下一次 WriteBlock / WriteUndo 之前有效：写入后读新数据要重新映射，旧映射在再下一次写入时解除
+    ByteView Read(const BlockFilePos& pos);
+
+    // 直接在映射内存上解析区块，不构造 Block (有效期同 Read) 对象
+    BlockView ReadBlockView(const BlockFilePos& pos) { return BlockView(Read(pos)); }
+
+    Block ReadBlock(const BlockFilePos& pos);
+    BlockUndo ReadUndo(const BlockFilePos& pos);
+
+    // 保存 / 读取 UTXO 快照；没有快照或快照损坏时 ReadChainState 返回 false
+    void WriteChainState(const uint256& tip, const UtxoSet& utxo);
+    bool ReadChainState(uint256& tip, UtxoSet& utxo);
+
+    // 把缓冲中的写入交给操作系统
+    void Flush();
+
+    size_t FileCount() const { return maps.size(); }
+
+private:
+    std::string FilePath(uint32_t file) const;
+    BlockFilePos Append(const Bytes& payload);
+    void AppendIndex(const Bytes& record);
+    void LoadIndex();
+
+    std::string dir;
+    uint32_t maxFileSize;
+
+    uint32_t currentFile = 0;
+    uint32_t currentSize = 0;
+    std::FILE* blockFile = nullptr;   // 当前正在追加的区块文件
+    std::FILE* indexFile = nullptr;
+
+    std::vector<std::unique_ptr<MappedFile>> maps;     // 每个区块文件一个映射 (按需建立)
+    std::vector<std::unique_ptr<MappedFile>> retired;  // 被重新映射替换掉的旧映射，保留到下一次写入 (见 Read)
+
+    std::vector<StoredBlockInfo> loaded;
+};
+
+#endif //BITCOIN_CORE_BLOCKSTORE_H
@@ -1,50 +1,625 @@
 ﻿#include "Blockchain.h"
+#include "BlockStore.h"
+#include "SigCache.h"
+#include "SignatureCheck.h"
+#include <algorithm>
+#include <ctime>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 #include "../Crypto/Hash.h" // ToHex
+#include "../Utils/Metrics.h"
+#include "../Utils/ThreadPool.h"
+#include "../Wallet/Wallet.h"
 
-Blockchain::Blockchain(uint32_t diff) : difficulty(diff) {
-    // 1. 创建创世区块 (Genesis Block)
+int64_t GetBlockSubsidy(uint32_t height) {
+    uint32_t halvings = height / 210000;
+    if (halvings >= 64) return 0;
+    return (50 * COIN) >> halvings;
+}
+
+Transaction MakeCoinbase(uint32_t height, const uint160& pubKeyHash, int64_t value) {
+    TxIn in;
+    in.prevIndex = 0xFFFFFFFF;
+    for (int i = 0; i < 4; i++) in.signature.push_back((height >> (8 * i)) & 0xFF);
+
+    Transaction tx;
+    tx.inputs.push_back(in);
+    tx.outputs.push_back({ value, pubKeyHash });
+    return tx;
+}
+
+Transaction MakeCoinbase(uint32_t height, const uint160& pubKeyHash, int64_t value, uint64_t extraNonce) {
+    Transaction tx = MakeCoinbase(height, pubKeyHash, value);
+    for (int i = 0; i < 8; i++) tx.inputs[0].signature.push_back((extraNonce >> (8 * i)) & 0xFF);
+    return tx;
+}
+
+Transaction MakeCoinbase(uint32_t height, const std::string& address, int64_t value) {
+    return MakeCoinbase(height, TxOut(value, address).pubKeyHash, value);
+}
+
+static void CheckConsensusParams(const ConsensusParams& params) {
+    ArithUint256 limit;
+    if (!DecodeTarget(params.powLimitBits, limit)) {
+        throw std::runtime_error("Blockchain: invalid powLimitBits");
+    }
+    if (static_cast<uint64_t>(params.targetSpacing) * params.retargetInterval * 4 > 0xFFFFFFFFULL) {
+        throw std::runtime_error("Blockchain: retarget timespan too long");
+    }
+}
+
+Blockchain::Blockchain(uint32_t bits) : Blockchain(ConsensusParams::Fixed(bits)) {}
+
+Blockchain::Blockchain(const ConsensusParams& consensus) : params(consensus), sigCache(&SigCache::Shared()) {
+    CheckConsensusParams(params);
+    SetVerificationThreads(0);
+    InitGenesis();
+}
+
+Blockchain::Blockchain(uint32_t bits, const std::string& dataDir)
+    : Blockchain(ConsensusParams::Fixed(bits), dataDir) {}
+
+Blockchain::Blockchain(const ConsensusParams& consensus, const std::string& dataDir)
+    : params(consensus), sigCache(&SigCache::Shared()), store(std::make_unique<BlockStore>(dataDir)) {
+    CheckConsensusParams(params);
+    SetVerificationThreads(0);
+    if (store->LoadedIndex().empty()) {
+        InitGenesis();
+    }
+    else {
+        LoadFromStore();
+    }
+}
+
+Blockchain::~Blockchain() {
+    try {
+        Flush();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to flush block store: " << e.what() << std::endl;
+    }
+}
+
+void Blockchain::Flush() {
+    if (!store) return;
+    store->WriteChainState(activeChain.back()->hash, utxo);
+    store->Flush();
+}
+
+void Blockchain::InitGenesis() {
+    // 创建创世区块 (Genesis Block)
     // 前块哈希全0，默克尔根全0 (简化)
-    Block genesis(1, Bytes(32, 0), Bytes(32, 0), 12345, difficulty);
-    genesis.Mine(difficulty);
-    chain.push_back(genesis);
+    Block genesis(1, uint256(), uint256(), GENESIS_TIMESTAMP, params.powLimitBits);
+    genesis.Mine();
+
+    uint256 hash = genesis.GetHash();
+    BlockIndex* index = InsertIndex(std::move(genesis), hash, nullptr);
+    ConnectTip(index);
+}
+
+void Blockchain::LoadFromStore() {
+    // 1. 按写入顺序重建区块索引：只用索引文件里的区块头，不读区块本体
+    for (const StoredBlockInfo& info : store->LoadedIndex()) {
+        BlockIndex* parent = nullptr;
+        if (!blockIndex.empty()) {
+            auto it = blockIndex.find(info.header.prevBlockHash);
+            if (it == blockIndex.end()) throw std::runtime_error("Block store corrupt: unknown parent block");
+            parent = it->second.get();
+        }
+        auto entry = std::make_unique<BlockIndex>(info.header);
+        BlockIndex* index = entry.get();
+        index->hash = info.hash;
+        index->prev = parent;
+        index->height = parent ? parent->height + 1 : 0;
+        index->chainWork = (parent ? parent->chainWork : ArithUint256()) + GetBlockWork(info.header.bits);
+        index->dataLoaded = false;
+        index->blockPos = info.blockPos;
+        index->undoPos = info.undoPos;
+        index->signaturesChecked = !info.undoPos.IsNull(); // 连接过主链的区块签名都验证过
+        index->failed = info.failed || (parent && parent->failed);
+        blockIndex.emplace(info.hash, std::move(entry));
+    }
+    BlockIndex* genesis = blockIndex.at(store->LoadedIndex().front().hash).get();
+
+    // 2. 恢复 UTXO：优先用快照；没有快照 (上次没有正常退出) 就从创世区块开始
+    uint256 tipHash;
+    auto tipIt = blockIndex.end();
+    if (store->ReadChainState(tipHash, utxo)) tipIt = blockIndex.find(tipHash);
+    if (tipIt != blockIndex.end()) {
+        for (BlockIndex* p = tipIt->second.get(); p; p = p->prev) activeChain.push_back(p);
+        std::reverse(activeChain.begin(), activeChain.end());
+    }
+    else {
+        utxo = UtxoSet();
+        ConnectTip(genesis);
+    }
+
+    // 3. 快照之后链尾被手动断开过 (标记为无效)：先退回到有效的区块
+    while (activeChain.back()->failed) DisconnectTipIndex();
+
+    // 4. 快照之后又收到过工作量更多的区块：切换过去 (已连接过的区块不用再验证签名)
+    BlockIndex* best = activeChain.back();
+    for (const StoredBlockInfo& info : store->LoadedIndex()) {
+        BlockIndex* index = blockIndex.at(info.hash).get();
+        if (!index->failed && index->chainWork > best->chainWork) best = index;
+    }
+    if (best != activeChain.back()) {
+        try {
+            ActivateBranch(best);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Failed to activate best stored chain: " << e.what() << std::endl;
+        }
+    }
+}
+
+uint32_t Blockchain::GetNextWorkRequired(const BlockIndex* parent) const {
+    if (params.retargetInterval == 0) return params.powLimitBits;
+    uint32_t height = parent->height + 1;
+    if (height % params.retargetInterval != 0) return parent->block.bits;
+
+    // 统计区间覆盖最近 retargetInterval 个出块间隔；第一次调整时链还不够长，从创世区块算起
+    const BlockIndex* first = parent;
+    for (uint32_t i = 0; i < params.retargetInterval && first->prev; i++) first = first->prev;
+    return CalculateNextWorkRequired(parent->block.bits, first->block.timestamp, parent->block.timestamp,
+                                     parent->height - first->height, params);
+}
+
+uint32_t Blockchain::GetMedianTimePast(const BlockIndex* index) const {
+    uint32_t times[MEDIAN_TIME_SPAN];
+    size_t count = 0;
+    for (; index && count < MEDIAN_TIME_SPAN; index = index->prev) times[count++] = index->block.timestamp;
+    std::sort(times, times + count);
+    return times[count / 2];
+}
+
+BlockIndex* Blockchain::InsertIndex(Block block, const uint256& hash, BlockIndex* parent) {
+    auto entry = std::make_unique<BlockIndex>(std::move(block));
+    BlockIndex* index = entry.get();
+    index->hash = hash;
+    index->prev = parent;
+    index->height = parent ? parent->height + 1 : 0;
+    index->chainWork = (parent ? parent->chainWork : ArithUint256()) + GetBlockWork(index->block.bits);
+    if (store) {
+        index->blockPos = store->WriteBlock(index->block, hash);
+        // 索引里只留区块头；完整区块放进缓存，紧接着连接它时不用再从磁盘解码
+        uint8_t header[Block::HEADER_SIZE];
+        index->block.SerializeHeader(header);
+        CacheBlock(hash, std::move(index->block));
+        index->block = DeserializeBlockHeader(header);
+        index->dataLoaded = false;
+    }
+    blockIndex.emplace(hash, std::move(entry));
+    return index;
+}
+
+const Block& Blockchain::BlockData(const BlockIndex* index) const {
+    if (index->dataLoaded) return index->block;
+    for (auto it = blockCache.begin(); it != blockCache.end(); ++it) {
+        if (it->first == index->hash) {
+            blockCache.splice(blockCache.begin(), blockCache, it);
+            return it->second;
+        }
+    }
+    return CacheBlock(index->hash, store->ReadBlock(index->blockPos));
+}
+
+const Block& Blockchain::CacheBlock(const uint256& hash, Block block) const {
+    blockCache.emplace_front(hash, std::move(block));
+    if (blockCache.size() > BLOCK_CACHE_SIZE) blockCache.pop_back();
+    return blockCache.front().second;
+}
+
+void Blockchain::MarkFailed(BlockIndex* index) {
+    if (index->failed) return;
+    index->failed = true;
+    if (store) store->MarkFailed(index->hash);
+}
+
+void Blockchain::SetVerificationThreads(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    verifyThreads = threads;
+    verifyPool.reset();
+    if (threads > 1) {
+        verifyPool = std::make_unique<ThreadPool>(threads - 1);
+    }
+}
+
+const Block& Blockchain::GetBlockData(const BlockIndex* index) const {
+    return BlockData(blockIndex.at(index->hash).get());
+}
+
+Bytes Blockchain::GetBlockBytes(const BlockIndex* index) const {
+    const BlockIndex* entry = blockIndex.at(index->hash).get();
+    if (!store) return entry->block.Serialize();
+    ByteView data = store->Read(entry->blockPos);
+    return Bytes(data.data, data.data + data.size);
 }
 
 const Block& Blockchain::GetLatestBlock() const {
-    return chain.back();
+    return BlockData(activeChain.back());
+}
+
+const BlockIndex* Blockchain::LookupBlock(const uint256& hash) const {
+    auto it = blockIndex.find(hash);
+    return it == blockIndex.end() ? nullptr : it->second.get();
 }
 
+const BlockIndex* Blockchain::GetBlockAtHeight(uint32_t height) const {
+    return height < activeChain.size() ? activeChain[height] : nullptr;
+}
+
+bool Blockchain::IsInMainChain(const BlockIndex* index) const {
+    return index && index->height < activeChain.size() && activeChain[index->height] == index;
+}
+
+// 验证指标：各阶段耗时、区块接受延迟、接受 / 拒绝 / 重组次数
+static MetricHistogram& StageSeconds(const char* stage) {
+    return MetricsRegistry::Shared().GetHistogram("mybitcoin_validation_stage_seconds",
+        "Time spent in each block validation stage", std::string("stage=\"") + stage + "\"");
+}
+static MetricHistogram& stagePrevHash = StageSeconds("prev_hash");
+static MetricHistogram& stagePow = StageSeconds("pow");
+static MetricHistogram& stageMerkle = StageSeconds("merkle");
+static MetricHistogram& stageStore = StageSeconds("store");
+static MetricHistogram& stageUtxo = StageSeconds("utxo");
+static MetricHistogram& stageSignatures = StageSeconds("signatures");
+static MetricHistogram& acceptSeconds = MetricsRegistry::Shared().GetHistogram(
+    "mybitcoin_block_accept_seconds", "Latency of AddBlock calls that extended or reorganized the active chain");
+static MetricCounter& blocksAccepted = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_blocks_accepted_total", "Blocks connected to the active chain by AddBlock");
+static MetricCounter& blocksSideBranch = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_blocks_side_branch_total", "Valid blocks stored on a side branch without becoming the tip");
+static MetricCounter& blocksRejected = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_blocks_rejected_total", "Blocks rejected by AddBlock");
+static MetricCounter& reorgs = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_reorgs_total", "Chain reorganizations");
+static MetricCounter& reorgDisconnected = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_reorg_disconnected_blocks_total", "Blocks disconnected from the active chain by reorganizations");
+static MetricGauge& chainHeight = MetricsRegistry::Shared().GetGauge(
+    "mybitcoin_chain_height", "Height of the active chain tip");
+
+// AddBlock 因异常离开时记一次拒绝
+struct RejectionCounter {
+    bool finished = false;
+    ~RejectionCounter() {
+        if (!finished) blocksRejected.Add();
+    }
+};
+
 void Blockchain::AddBlock(Block newBlock) {
+    AcceptBlock(std::move(newBlock), false);
+}
+
+void Blockchain::AddPrevalidatedBlock(Block newBlock) {
+    AcceptBlock(std::move(newBlock), true);
+}
+
+void Blockchain::AcceptBlock(Block newBlock, bool prevalidated) {
     // --- 全节点验证流程 ---
+    // 先做不依赖链状态的检查，通过后才放进索引
+    RejectionCounter rejection;
+    MetricStopwatch total;
+    MetricStopwatch stage;
 
-    // 1. 验证前块哈希 (链接是否断裂)
-    Block latest = GetLatestBlock();
-    if (newBlock.prevBlockHash != latest.GetHash()) {
+    // 字段是公开的，调用方可能在冻结之后没有 Thaw() 就改过交易或区块头，传进来的缓存不可信：
+    // 丢掉全部缓存，按原始字段重新算 txid、签名哈希、默克尔树和区块哈希，之后的验证、索引、存盘都用这一份
+    // (预先验证过的区块由 ImportBlocks 刚刚反序列化得到，缓存就是按原始字节算的)
+    if (!prevalidated) newBlock.RebuildMerkleTree();
+    newBlock.Freeze();
+
+    // 1. 查找前一个区块 (可以在主链上，也可以在分叉上)
+    uint256 hash = newBlock.GetHash();
+    if (blockIndex.count(hash)) {
+        throw std::runtime_error("Invalid Block: duplicate block");
+    }
+    auto parentIt = blockIndex.find(newBlock.prevBlockHash);
+    if (parentIt == blockIndex.end()) {
         throw std::runtime_error("Invalid Block: PrevHash mismatch");
     }
+    BlockIndex* parent = parentIt->second.get();
+    if (parent->failed) {
+        throw std::runtime_error("Invalid Block: builds on an invalid block");
+    }
+    // 时间戳太早或太晚都不放进索引：太晚的区块等本地时间追上后可以重新提交
+    if (newBlock.timestamp <= GetMedianTimePast(parent)) {
+        throw std::runtime_error("Invalid Block: timestamp not after median time past");
+    }
+    if (static_cast<int64_t>(newBlock.timestamp) > static_cast<int64_t>(std::time(nullptr)) + MAX_FUTURE_BLOCK_TIME) {
+        throw std::runtime_error("Invalid Block: timestamp too far in the future");
+    }
+    stage.Lap(stagePrevHash);
 
     // 2. 验证 PoW (工作量证明是否达标)
-    if (!newBlock.CheckPoW(difficulty)) {
+    if (newBlock.bits != GetNextWorkRequired(parent)) {
+        throw std::runtime_error("Invalid Block: wrong difficulty bits");
+    }
+    if (!prevalidated && !newBlock.CheckPoW()) {
         throw std::runtime_error("Invalid Block: PoW check failed");
     }
+    stage.Lap(stagePow);
 
     // 3. 验证默克尔根 (交易数据是否被篡改)
-    Bytes calculatedRoot = ComputeMerkleRoot(newBlock.transactions);
-    if (newBlock.merkleRoot != calculatedRoot) {
+    // 重复交易的变体与合法区块的默克尔根、区块哈希都相同：必须在放进索引之前拒绝，
+    // 否则会占住这个哈希，或者让合法区块跟着被标记为无效
+    if (HasDuplicateLeaves(newBlock.GetMerkleTree().Leaves())) {
+        throw std::runtime_error("Invalid Block: duplicate transaction");
+    }
+    if (!prevalidated && newBlock.merkleRoot != newBlock.GetMerkleRoot()) {
         throw std::runtime_error("Invalid Block: Merkle Root mismatch");
     }
+    stage.Lap(stageMerkle);
+
+    // 4. 加入索引 (有磁盘存储时写入区块文件)
+    BlockIndex* index = InsertIndex(std::move(newBlock), hash, parent);
+    index->signaturesChecked = prevalidated;
+    stage.Lap(stageStore);
+
+    // 5. 工作量没有超过主链：只存在分叉上，交易等到重组时再验证
+    if (index->chainWork <= activeChain.back()->chainWork) {
+        blocksSideBranch.Add();
+        rejection.finished = true;
+        return;
+    }
+
+    // 6. 接到链尾，或者重组到新分支
+    try {
+        if (parent == activeChain.back()) {
+            ConnectTip(index);
+        }
+        else {
+            ActivateBranch(index);
+        }
+    }
+    catch (...) {
+        // 新区块本身不合法就不留在索引里 (分叉上更早的无效区块保留 failed 标记)
+        // 已经写到磁盘上的数据没法撤回，在磁盘索引里标记为无效
+        MarkFailed(index);
+        blockIndex.erase(hash);
+        blockCache.remove_if([&](const std::pair<uint256, Block>& entry) { return entry.first == hash; });
+        throw;
+    }
+    rejection.finished = true;
+    blocksAccepted.Add();
+    chainHeight.Set(GetHeight());
+    total.Lap(acceptSeconds);
+}
+
+void Blockchain::ConnectTip(BlockIndex* index) {
+    const Block& block = BlockData(index);
+
+    // 验证签名：把每个输入的 (公钥, 签名哈希, 签名) 交给线程池并行验证 (先查签名缓存)
+    // 以前在主链上验证过的区块 (重组时重新连接) 不必再验证
+    std::vector<SignatureCheck> checks;
+    if (!index->signaturesChecked) {
+        for (size_t t = 0; t < block.transactions.size(); t++) {
+            const Transaction& tx = block.transactions[t];
+            if (tx.IsCoinBase()) continue;
+            uint256 sighash = tx.GetSignatureHash();
+            for (const auto& in : tx.inputs) {
+                SignatureCheck check;
+                check.publicKey = &in.publicKey;
+                check.signature = &in.signature;
+                check.hash = sighash;
+                check.txIndex = t;
+                check.cache = sigCache;   // 进入内存池时已经验证过的签名直接跳过
+                checks.push_back(check);
+            }
+        }
+    }
+    // signatures 阶段从提交签名检查算到拿到结果，与 utxo 阶段在时间上重叠
+    MetricStopwatch sigTimer;
+    MetricStopwatch utxoTimer;
+    SignatureCheckQueue sigChecks(verifyPool.get(), std::move(checks));
+
+    // 签名在后台验证的同时，在本线程验证并应用交易：输入必须存在且未花费，输入金额要覆盖输出金额
+    // 这一步失败时 sigChecks 析构会取消剩下的签名检查
+    BlockUndo blockUndo = ConnectBlock(block, index->height);
+    utxoTimer.Lap(stageUtxo);
+
+    // 等签名结果；有无效签名就撤销上一步的修改
+    bool signaturesOk = sigChecks.Wait();
+    sigTimer.Lap(stageSignatures);
+    if (!signaturesOk) {
+        DisconnectBlock(block, blockUndo);
+        throw std::runtime_error("Invalid Block: bad signature in transaction " + std::to_string(sigChecks.FailedTx()));
+    }
+    if (!store) {
+        index->undo = std::move(blockUndo);
+    }
+    else if (index->undoPos.IsNull()) {
+        // 同一个区块接在同一个父区块后面，撤销数据总是一样的，只需要写一次
+        index->undoPos = store->WriteUndo(index->hash, blockUndo);
+    }
+    index->signaturesChecked = true;
+    activeChain.push_back(index);
+}
+
+void Blockchain::DisconnectTipIndex() {
+    BlockIndex* tip = activeChain.back();
+    if (store) {
+        BlockUndo undo = store->ReadUndo(tip->undoPos);
+        DisconnectBlock(store->ReadBlockView(tip->blockPos), undo);
+    }
+    else {
+        DisconnectBlock(tip->block, tip->undo);
+        tip->undo = BlockUndo();
+    }
+    activeChain.pop_back();
+}
+
+void Blockchain::ActivateBranch(BlockIndex* newTip) {
+    // 1. 沿 prev 指针往回找分叉点 (第一个在主链上的祖先，创世区块一定在主链上)
+    std::vector<BlockIndex*> branch;
+    BlockIndex* fork = newTip;
+    while (!IsInMainChain(fork)) {
+        branch.push_back(fork);
+        fork = fork->prev;
+    }
+    std::reverse(branch.begin(), branch.end());
+
+    // 2. 断开主链上分叉点之后的区块
+    std::vector<BlockIndex*> disconnected;
+    while (activeChain.back() != fork) {
+        disconnected.push_back(activeChain.back());
+        DisconnectTipIndex();
+    }
 
-    // 4. (可选) 验证每笔交易的签名 ...
+    // 3. 依次连接新分支
+    for (size_t i = 0; i < branch.size(); i++) {
+        try {
+            ConnectTip(branch[i]);
+        }
+        catch (...) {
+            // 这个区块和它之后的区块都不可能成为主链
+            for (size_t j = i; j < branch.size(); j++) MarkFailed(branch[j]);
 
-    // 全部通过，上链
-    chain.push_back(newBlock);
-    std::cout << "Block accepted! Height: " << chain.size() << std::endl;
+            // 恢复原来的主链 (这些区块之前都连接成功过，签名也不用再验证)
+            while (activeChain.back() != fork) DisconnectTipIndex();
+            for (auto it = disconnected.rbegin(); it != disconnected.rend(); ++it) ConnectTip(*it);
+            throw;
+        }
+    }
+    reorgs.Add();
+    reorgDisconnected.Add(disconnected.size());
+}
+
+void Blockchain::DisconnectTip() {
+    if (activeChain.size() <= 1) {
+        throw std::runtime_error("Cannot disconnect the genesis block");
+    }
+    BlockIndex* tip = activeChain.back();
+    DisconnectTipIndex();
+    MarkFailed(tip);
+}
+
+BlockUndo Blockchain::ConnectBlock(const Block& block, uint32_t height) {
+    BlockUndo blockUndo;
+    // 按顺序记录每一次修改 (true = 新增输出，false = 花费输出)，失败时按相反顺序撤销
+    std::vector<std::pair<bool, OutPoint>> journal;
+
+    try {
+        int64_t fees = 0;
+        int64_t coinbaseOut = 0;
+        for (size_t t = 0; t < block.transactions.size(); t++) {
+            const Transaction& tx = block.transactions[t];
+            if (tx.inputs.empty() || tx.outputs.empty()) {
+                throw std::runtime_error("Invalid Block: transaction without inputs or outputs");
+            }
+
+            int64_t valueOut = 0;
+            for (const auto& out : tx.outputs) {
+                valueOut += out.value;
+                if (!MoneyRange(out.value) || !MoneyRange(valueOut)) {
+                    throw std::runtime_error("Invalid Block: output value out of range");
+                }
+            }
+
+            if (tx.IsCoinBase()) {
+                if (t != 0) throw std::runtime_error("Invalid Block: coinbase must be the first transaction");
+                coinbaseOut = valueOut;
+            }
+            else {
+                int64_t valueIn = 0;
+                for (const auto& in : tx.inputs) {
+                    OutPoint prevout(in.prevTxId, in.prevIndex);
+                    Coin coin;
+                    // 不存在 = 引用了不存在的输出，或者已经被花掉 (包括同一区块内的双花)
+                    if (!utxo.Spend(prevout, &coin)) {
+                        throw std::runtime_error("Invalid Block: input missing or already spent");
+                    }
+                    journal.emplace_back(false, prevout);
+                    blockUndo.spent.emplace_back(prevout, coin);
+                    // 只有输出地址的主人才能花这笔钱 (签名本身由 AddBlock 并行验证)
+                    if (Hash160(in.publicKey) != coin.out.pubKeyHash) {
+                        throw std::runtime_error("Invalid Block: public key does not match spent output");
+                    }
+                    valueIn += coin.out.value;
+                    if (!MoneyRange(valueIn)) throw std::runtime_error("Invalid Block: input value out of range");
+                }
+                if (valueIn < valueOut) {
+                    throw std::runtime_error("Invalid Block: inputs do not cover outputs");
+                }
+                fees += valueIn - valueOut;
+            }
+
+            // 新输出加入 UTXO (同一区块内后面的交易可以花前面交易的输出)
+            uint256 txid = tx.GetId();
+            for (uint32_t i = 0; i < tx.outputs.size(); i++) {
+                Coin coin;
+                coin.out = tx.outputs[i];
+                coin.height = height;
+                coin.coinbase = tx.IsCoinBase();
+                if (!utxo.Add(OutPoint(txid, i), coin)) {
+                    throw std::runtime_error("Invalid Block: duplicate transaction output");
+                }
+                journal.emplace_back(true, OutPoint(txid, i));
+            }
+        }
+
+        // coinbase 最多只能拿走区块奖励 + 手续费
+        if (coinbaseOut > GetBlockSubsidy(height) + fees) {
+            throw std::runtime_error("Invalid Block: coinbase pays too much");
+        }
+    }
+    catch (...) {
+        size_t spentIndex = blockUndo.spent.size();
+        for (auto it = journal.rbegin(); it != journal.rend(); ++it) {
+            if (it->first) {
+                utxo.Spend(it->second);
+            }
+            else {
+                spentIndex--;
+                utxo.Add(blockUndo.spent[spentIndex].first, blockUndo.spent[spentIndex].second);
+            }
+        }
+        throw;
+    }
+    return blockUndo;
+}
+
+void Blockchain::DisconnectBlock(const Block& block, const BlockUndo& blockUndo) {
+    // 交易倒着处理：先删掉它创建的输出，再把它花掉的币放回去
+    size_t spentIndex = blockUndo.spent.size();
+    for (auto tx = block.transactions.rbegin(); tx != block.transactions.rend(); ++tx) {
+        uint256 txid = tx->GetId();
+        for (uint32_t i = 0; i < tx->outputs.size(); i++) {
+            utxo.Spend(OutPoint(txid, i));
+        }
+        if (tx->IsCoinBase()) continue;
+        for (size_t i = 0; i < tx->inputs.size(); i++) {
+            spentIndex--;
+            utxo.Add(blockUndo.spent[spentIndex].first, blockUndo.spent[spentIndex].second);
+        }
+    }
+}
+
+void Blockchain::DisconnectBlock(const BlockView& block, const BlockUndo& blockUndo) {
+    size_t spentIndex = blockUndo.spent.size();
+    for (size_t t = block.TransactionCount(); t-- > 0;) {
+        const TransactionView& tx = block.GetTransaction(t);
+        uint256 txid = tx.GetId();
+        for (uint32_t i = 0; i < tx.OutputCount(); i++) {
+            utxo.Spend(OutPoint(txid, i));
+        }
+        if (tx.IsCoinBase()) continue;
+        for (size_t i = 0; i < tx.InputCount(); i++) {
+            spentIndex--;
+            utxo.Add(blockUndo.spent[spentIndex].first, blockUndo.spent[spentIndex].second);
+        }
+    }
 }
 
 void Blockchain::PrintChain() {
-    for (size_t i = 0; i < chain.size(); i++) {
-        std::cout << "Height: " << i
-            << " | Hash: " << ToHex(chain[i].GetHash())
-            << " | TxCount: " << chain[i].transactions.size() << std::endl;
+    // 哈希在加入索引时已经算好，这里不再重新哈希区块头；交易数直接从区块文件的映射上数，不解码区块
+    for (BlockIndex* index : activeChain) {
+        size_t txCount = index->dataLoaded ? index->block.transactions.size()
+                                           : store->ReadBlockView(index->blockPos).TransactionCount();
+        std::cout << "Height: " << index->height
+            << " | Hash: " << ToHex(index->hash)
+            << " | TxCount: " << txCount << std::endl;
     }
 }
\ No newline at end of file
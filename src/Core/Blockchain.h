@@ -2,22 +2,188 @@
 #define BITCOIN_CORE_BLOCKCHAIN_H
 
 #include "Block.h"
+#include "BlockIndex.h"
+#include "Pow.h"
+#include "UtxoSet.h"
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+class BlockStore;
+struct ImportOptions;
+struct ImportStats;
+class SigCache;
+class ThreadPool;
+
+// 区块奖励：50 BTC，每 210000 个区块减半 (对应 v0.1.5 main.cpp 中的 GetBlockValue)
+int64_t GetBlockSubsidy(uint32_t height);
+
+// 构造 coinbase 交易：把 value 付给 pubKeyHash
+// 高度写进输入的 signature 字段 (相当于 coinbase 脚本)，保证不同区块的 coinbase txid 不同
+Transaction MakeCoinbase(uint32_t height, const uint160& pubKeyHash, int64_t value);
+
+// 同上，收款人用 Base58Check 地址表示，地址不合法时抛异常
+Transaction MakeCoinbase(uint32_t height, const std::string& address, int64_t value);
+
+// 同上，coinbase 脚本在高度之后再写 8 字节 extranonce (小端序)：
+// 换一个 extranonce 就得到新的默克尔根，也就有了一整个新的 nonce 空间 (见 WorkUnit.h)
+Transaction MakeCoinbase(uint32_t height, const uint160& pubKeyHash, int64_t value, uint64_t extraNonce);
+
+// 区块时间戳规则 (对应 Bitcoin Core 的 ContextualCheckBlockHeader)：
+// 必须晚于父区块及其之前共 MEDIAN_TIME_SPAN 个区块时间戳的中位数，并且不能比本地时间超前 MAX_FUTURE_BLOCK_TIME 秒。
+// 难度调整按时间戳计算出块间隔，没有这两条限制矿工就能任意伪造间隔压低难度 (time-warp)。
+static const uint32_t MEDIAN_TIME_SPAN = 11;
+static const int64_t MAX_FUTURE_BLOCK_TIME = 2 * 60 * 60;
+
+// 创世区块的时间戳，之后的区块都必须比它晚
+static const uint32_t GENESIS_TIMESTAMP = 12345;
+
 class Blockchain {
 private:
-    std::vector<Block> chain;
-    uint32_t difficulty; // 全局难度 (简化版)
+    // 全部已知区块 (主链 + 分叉)，按哈希查找 O(1)
+    std::unordered_map<uint256, std::unique_ptr<BlockIndex>> blockIndex;
+    std::vector<BlockIndex*> activeChain; // 主链，下标就是高度
+    UtxoSet utxo;                  // 当前主链上所有未花费的输出
+    ConsensusParams params;        // 难度上限和难度调整规则
+
+    unsigned verifyThreads = 1;             // 签名验证使用的线程数 (包括调用 AddBlock 的线程)
+    std::unique_ptr<ThreadPool> verifyPool; // verifyThreads - 1 个帮手线程；只用一个线程时为空
+    SigCache* sigCache;                     // 已验证签名的缓存 (默认 SigCache::Shared())，为空时不用缓存
+    std::unique_ptr<BlockStore> store;      // 磁盘存储；为空时整条链只在内存里
+
+    // 有磁盘存储时最近解码过的完整区块 (索引里只有区块头)，最近用过的在前，最多 BLOCK_CACHE_SIZE 个
+    static const size_t BLOCK_CACHE_SIZE = 16;
+    mutable std::list<std::pair<uint256, Block>> blockCache;
+
+    // 创建创世区块并连接
+    void InitGenesis();
+
+    // 从磁盘索引重建区块索引和 UTXO 集合
+    void LoadFromStore();
+
+    // 接在 parent 后面的区块必须使用的 bits：
+    // 不调整难度时总是 powLimitBits；否则每 retargetInterval 个区块按这段时间的时间戳重新计算一次，其余区块沿用父区块的 bits
+    uint32_t GetNextWorkRequired(const BlockIndex* parent) const;
+
+    // index 及其之前共 MEDIAN_TIME_SPAN 个区块 (不足时取到创世区块为止) 时间戳的中位数
+    uint32_t GetMedianTimePast(const BlockIndex* index) const;
+
+    // 把新的索引项放进 blockIndex (有磁盘存储时同时写入区块文件)
+    // 之后的失败会按哈希记到磁盘索引里，所以调用前必须确认交易列表就是区块头承诺的那一份 (默克尔根相符且没有重复交易)
+    BlockIndex* InsertIndex(Block block, const uint256& hash, BlockIndex* parent);
+
+    // 区块的完整数据：没有磁盘存储时就是索引里的区块；否则先查缓存，没有再从区块文件解码
+    const Block& BlockData(const BlockIndex* index) const;
+
+    // 放进 blockCache 的最前面，超出上限时丢掉最久没用过的
+    const Block& CacheBlock(const uint256& hash, Block block) const;
+
+    // 标记区块无效 (有磁盘存储时同时记到索引文件里)
+    void MarkFailed(BlockIndex* index);
+
+    // AddBlock / AddPrevalidatedBlock 的共同实现；prevalidated 时跳过 PoW、默克尔根和签名检查
+    void AcceptBlock(Block newBlock, bool prevalidated);
+
+    // 批量导入用 (见 BlockImport.h)：PoW、默克尔根和签名已经在别的线程检查过，这里不再重复；
+    // 父区块、bits 是否符合难度调整、UTXO 和公钥哈希等依赖链状态的检查照常进行。
+    // 跳过的检查只有 ImportBlocks 自己做过，所以不对外公开
+    void AddPrevalidatedBlock(Block newBlock);
+    friend ImportStats ImportBlocks(Blockchain& chain, std::istream& in, const ImportOptions& options);
+
+    // 把区块中的花费和新输出应用到 UTXO 集合，返回撤销数据
+    // 任何一笔交易不合法都会把已做的修改全部回滚后抛出异常 (要么全部生效，要么都不生效)
+    // 这里不验证签名，只核对输入里的公钥是否属于被花费输出的地址
+    BlockUndo ConnectBlock(const Block& block, uint32_t height);
+
+    // ConnectBlock 的逆操作
+    void DisconnectBlock(const Block& block, const BlockUndo& blockUndo);
+    // 同上，直接在区块文件的映射上读交易，不解码成 Block
+    void DisconnectBlock(const BlockView& block, const BlockUndo& blockUndo);
+
+    // 把 index 接到主链末尾 (它的父区块必须是当前链尾)：验证签名并更新 UTXO，失败抛异常且不留下任何修改
+    void ConnectTip(BlockIndex* index);
+
+    // 断开主链末尾的区块
+    void DisconnectTipIndex();
+
+    // 切换到以 newTip 结尾的分支：断开到分叉点，再依次连接新分支
+    // 新分支上有区块验证失败时，把它和它之后的区块标记为无效，恢复原来的主链后抛出异常
+    void ActivateBranch(BlockIndex* newTip);
 
 public:
-    Blockchain(uint32_t diff);
+    // 固定难度：所有区块 (包括创世区块) 都使用 bits
+    explicit Blockchain(uint32_t bits);
+    // powLimitBits 不合法或调整周期太长时抛异常
+    explicit Blockchain(const ConsensusParams& consensus);
+
+    // 使用目录 dataDir 下的磁盘存储：第一次启动时挖出创世区块并写盘；
+    // 之后启动时从紧凑索引和 UTXO 快照恢复，不重新挖矿也不重放区块
+    Blockchain(uint32_t bits, const std::string& dataDir);
+    Blockchain(const ConsensusParams& consensus, const std::string& dataDir);
+
+    // 有磁盘存储时会调用 Flush()
+    ~Blockchain();
+
+    // 保存 UTXO 快照并把缓冲的写入交给操作系统；没有磁盘存储时什么也不做
+    void Flush();
 
-    // 获取最新区块 (用于挖下一个块时引用)
+    // 设置验证签名用的线程数，0 = CPU 核心数，1 = 全部在调用线程里串行验证
+    void SetVerificationThreads(unsigned threads);
+    unsigned GetVerificationThreads() const { return verifyThreads; }
+
+    // 指定签名缓存；AddBlock 只查询不写入 (区块里的签名通常不会再被验证第二次)
+    void SetSignatureCache(SigCache* cache) { sigCache = cache; }
+
+    // 获取最新区块 (用于挖下一个块时引用)，引用的有效期同 GetBlockData
     const Block& GetLatestBlock() const;
 
+    // 主链末尾的索引项
+    const BlockIndex* GetTip() const { return activeChain.back(); }
+
+    // 按哈希查找区块 (包括分叉上的区块)，不存在返回 nullptr
+    const BlockIndex* LookupBlock(const uint256& hash) const;
+
+    // 主链上指定高度的区块，超出范围返回 nullptr
+    const BlockIndex* GetBlockAtHeight(uint32_t height) const;
+
+    // 是否在当前主链上
+    bool IsInMainChain(const BlockIndex* index) const;
+
+    // 索引中的区块总数 (含分叉)
+    size_t GetBlockIndexSize() const { return blockIndex.size(); }
+
     // 添加新区块 (核心验证逻辑)
+    // 父区块可以是索引里的任意区块：接在链尾时直接连接；
+    // 在分叉上时先存起来，分叉的累计工作量超过主链时重组到这条分叉 (工作量相同时保留先收到的)
     void AddBlock(Block newBlock);
 
+    // 区块的完整数据，index 必须来自这条链
+    // 有磁盘存储时从区块文件解码 (最近用过的几个有缓存)，返回的引用在下一次读取区块数据或修改链之前有效
+    const Block& GetBlockData(const BlockIndex* index) const;
+
+    // 区块的序列化字节：有磁盘存储时直接复制区块文件里的记录，不解码
+    Bytes GetBlockBytes(const BlockIndex* index) const;
+
+    // 断开最新的区块，恢复它花掉的币 (代价与区块大小成正比)
+    // 被断开的区块标记为无效，否则它的工作量最多，下一次 AddBlock 又会把它接回来
+    void DisconnectTip();
+
+    // 接在当前链尾后面的新区块必须使用的 bits
+    uint32_t GetNextWorkRequired() const { return GetNextWorkRequired(activeChain.back()); }
+
+    // 当前链尾的中位时间：接在链尾后面的新区块时间戳必须大于它
+    uint32_t GetMedianTimePast() const { return GetMedianTimePast(activeChain.back()); }
+
+    const ConsensusParams& GetConsensusParams() const { return params; }
+
+    // 当前高度 (创世区块为 0)
+    uint32_t GetHeight() const { return static_cast<uint32_t>(activeChain.size() - 1); }
+
+    const UtxoSet& GetUtxoSet() const { return utxo; }
+
     // 打印链状态
     void PrintChain();
 };
@@ -0,0 +1,498 @@
+﻿#include "Mempool.h"
+#include "Blockchain.h"
+#include "SigCache.h"
+#include "SignatureCheck.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include "../Wallet/Wallet.h"
+
+// 比较两个包的手续费率 feeA / sizeA 与 feeB / sizeB (交叉相乘，避免除法)
+// 用 double：手续费最多 2.1e15，乘上字节数会超出 int64
+static bool FeeRateLess(int64_t feeA, size_t sizeA, int64_t feeB, size_t sizeB) {
+    return static_cast<double>(feeA) * sizeB < static_cast<double>(feeB) * sizeA;
+}
+
+size_t Mempool::OutPointHasher::operator()(const OutPoint& o) const {
+    return std::hash<uint256>()(o.txid) ^ (static_cast<size_t>(o.index) * 0x9E3779B97F4A7C15ULL);
+}
+
+bool Mempool::CompareAncestorScore::operator()(const MempoolEntry* a, const MempoolEntry* b) const {
+    if (FeeRateLess(b->ancestorFee, b->ancestorSize, a->ancestorFee, a->ancestorSize)) return true;
+    if (FeeRateLess(a->ancestorFee, a->ancestorSize, b->ancestorFee, b->ancestorSize)) return false;
+    return a->txid < b->txid;
+}
+
+bool Mempool::CompareDescendantScore::operator()(const MempoolEntry* a, const MempoolEntry* b) const {
+    if (FeeRateLess(a->descendantFee, a->descendantSize, b->descendantFee, b->descendantSize)) return true;
+    if (FeeRateLess(b->descendantFee, b->descendantSize, a->descendantFee, a->descendantSize)) return false;
+    return a->txid < b->txid;
+}
+
+Mempool::Mempool(const Blockchain& chain, size_t maxSize)
+    : chain(chain), maxSize(maxSize), sigCache(&SigCache::Shared()), blockTemplate(1, uint256(), uint256(), 0, 0) {}
+
+Mempool::~Mempool() = default;
+
+const MempoolEntry* Mempool::Get(const uint256& txid) const {
+    auto it = entries.find(txid);
+    return it == entries.end() ? nullptr : it->second.get();
+}
+
+const MempoolEntry* Mempool::GetSpender(const OutPoint& outpoint) const {
+    auto it = spenders.find(outpoint);
+    return it == spenders.end() ? nullptr : it->second;
+}
+
+std::set<MempoolEntry*> Mempool::CalculateAncestors(const MempoolEntry* entry) const {
+    std::set<MempoolEntry*> result;
+    std::vector<MempoolEntry*> todo(entry->parents.begin(), entry->parents.end());
+    while (!todo.empty()) {
+        MempoolEntry* e = todo.back();
+        todo.pop_back();
+        if (!result.insert(e).second) continue;
+        todo.insert(todo.end(), e->parents.begin(), e->parents.end());
+    }
+    return result;
+}
+
+std::set<MempoolEntry*> Mempool::CalculateDescendants(const MempoolEntry* entry) const {
+    std::set<MempoolEntry*> result;
+    std::vector<MempoolEntry*> todo(entry->children.begin(), entry->children.end());
+    while (!todo.empty()) {
+        MempoolEntry* e = todo.back();
+        todo.pop_back();
+        if (!result.insert(e).second) continue;
+        todo.insert(todo.end(), e->children.begin(), e->children.end());
+    }
+    return result;
+}
+
+template <typename F>
+void Mempool::UpdateEntry(MempoolEntry* entry, F&& update) {
+    byAncestorScore.erase(entry);
+    byDescendantScore.erase(entry);
+    update(entry);
+    byAncestorScore.insert(entry);
+    byDescendantScore.insert(entry);
+}
+
+void Mempool::AddTransaction(const Transaction& tx) {
+    // 1. 不依赖其他数据的检查
+    if (tx.IsCoinBase()) throw std::runtime_error("Mempool: coinbase transaction");
+    if (tx.inputs.empty() || tx.outputs.empty()) {
+        throw std::runtime_error("Mempool: transaction without inputs or outputs");
+    }
+
+    auto entry = std::make_unique<MempoolEntry>();
+    entry->tx = tx;
+    entry->tx.Freeze();
+    entry->txid = entry->tx.GetId();
+    entry->size = entry->tx.GetSerializeSize();
+    if (entries.count(entry->txid)) throw std::runtime_error("Mempool: transaction already in pool");
+
+    int64_t valueOut = 0;
+    for (const auto& out : tx.outputs) {
+        valueOut += out.value;
+        if (!MoneyRange(out.value) || !MoneyRange(valueOut)) {
+            throw std::runtime_error("Mempool: output value out of range");
+        }
+    }
+
+    // 2. 输入：先找池中的父交易，再找主链 UTXO；已经被池中交易花掉的算冲突
+    const UtxoSet& utxo = chain.GetUtxoSet();
+    std::vector<OutPoint> prevouts;
+    int64_t valueIn = 0;
+    for (const auto& in : tx.inputs) {
+        OutPoint prevout(in.prevTxId, in.prevIndex);
+        if (spenders.count(prevout)) {
+            throw std::runtime_error("Mempool: input conflicts with a pool transaction");
+        }
+        if (std::find(prevouts.begin(), prevouts.end(), prevout) != prevouts.end()) {
+            throw std::runtime_error("Mempool: duplicate input");
+        }
+        prevouts.push_back(prevout);
+
+        const TxOut* spent = nullptr;
+        auto parent = entries.find(in.prevTxId);
+        if (parent != entries.end()) {
+            if (in.prevIndex < parent->second->tx.outputs.size()) {
+                spent = &parent->second->tx.outputs[in.prevIndex];
+                entry->parents.insert(parent->second.get());
+            }
+        }
+        else if (const Coin* coin = utxo.Get(prevout)) {
+            spent = &coin->out;
+        }
+        if (!spent) throw std::runtime_error("Mempool: input missing or already spent");
+
+        if (Hash160(in.publicKey) != spent->pubKeyHash) {
+            throw std::runtime_error("Mempool: public key does not match spent output");
+        }
+        valueIn += spent->value;
+        if (!MoneyRange(valueIn)) throw std::runtime_error("Mempool: input value out of range");
+    }
+    if (valueIn < valueOut) throw std::runtime_error("Mempool: inputs do not cover outputs");
+    entry->fee = valueIn - valueOut;
+
+    // 3. 祖先链长度限制
+    std::set<MempoolEntry*> ancestors = CalculateAncestors(entry.get());
+    if (ancestors.size() + 1 > MAX_ANCESTOR_COUNT) {
+        throw std::runtime_error("Mempool: too many unconfirmed ancestors");
+    }
+    for (const MempoolEntry* a : ancestors) {
+        if (a->descendantCount + 1 > MAX_DESCENDANT_COUNT) {
+            throw std::runtime_error("Mempool: too many unconfirmed descendants");
+        }
+    }
+
+    // 4. 池满：先选出要淘汰的包；轮到新交易自己的包时在修改池之前拒绝
+    std::vector<MempoolEntry*> evict;
+    if (!SelectEvictions(entry.get(), ancestors, evict)) {
+        throw std::runtime_error("Mempool: pool full, fee rate too low");
+    }
+
+    // 5. 最贵的签名检查放在最后，成功的签名写入缓存
+    if (!CheckTransactionSignatures(entry->tx, sigCache)) {
+        throw std::runtime_error("Mempool: signature verification failed");
+    }
+
+    // 6. 加入索引并更新祖先的后代统计
+    MempoolEntry* e = entry.get();
+    e->ancestorCount = ancestors.size() + 1;
+    e->ancestorSize = e->size;
+    e->ancestorFee = e->fee;
+    for (const MempoolEntry* a : ancestors) {
+        e->ancestorSize += a->size;
+        e->ancestorFee += a->fee;
+    }
+    e->descendantSize = e->size;
+    e->descendantFee = e->fee;
+    for (MempoolEntry* a : ancestors) {
+        UpdateEntry(a, [e](MempoolEntry* x) {
+            x->descendantCount++;
+            x->descendantSize += e->size;
+            x->descendantFee += e->fee;
+        });
+    }
+    for (MempoolEntry* p : e->parents) p->children.insert(e);
+    for (const auto& prevout : prevouts) spenders[prevout] = e;
+    byAncestorScore.insert(e);
+    byDescendantScore.insert(e);
+    totalSize += e->size;
+    entries.emplace(e->txid, std::move(entry));
+
+    bool templateCurrent = templateSequence == sequence;
+    sequence++;
+    if (templateCurrent && ExtendTemplate(e)) templateSequence = sequence;
+
+    // 7. 淘汰选中的包 (都不是新交易的祖先，所以也不会带走新交易)
+    for (MempoolEntry* x : evict) RemoveWithDescendants(x);
+}
+
+bool Mempool::SelectEvictions(const MempoolEntry* entry, const std::set<MempoolEntry*>& ancestors,
+                              std::vector<MempoolEntry*>& evict) const {
+    if (totalSize + entry->size <= maxSize) return true;
+
+    // 新交易所在的包：淘汰它自己或任何一个祖先都会带走它，取其中 (算上它之后) 后代包费率最低的
+    int64_t packageFee = entry->fee;
+    size_t packageSize = entry->size;
+    for (const MempoolEntry* a : ancestors) {
+        if (FeeRateLess(a->descendantFee + entry->fee, a->descendantSize + entry->size, packageFee, packageSize)) {
+            packageFee = a->descendantFee + entry->fee;
+            packageSize = a->descendantSize + entry->size;
+        }
+    }
+
+    std::set<const MempoolEntry*> removed;
+    size_t freed = 0;
+    for (MempoolEntry* x : byDescendantScore) {
+        if (totalSize + entry->size - freed <= maxSize) return true;
+        if (removed.count(x) || ancestors.count(x)) continue;
+        // 费率相同时也先淘汰新交易，池里原有的交易优先
+        if (!FeeRateLess(x->descendantFee, x->descendantSize, packageFee, packageSize)) return false;
+        evict.push_back(x);
+        std::set<MempoolEntry*> descendants = CalculateDescendants(x);
+        descendants.insert(x);
+        for (const MempoolEntry* d : descendants) {
+            if (removed.insert(d).second) freed += d->size;
+        }
+    }
+    return totalSize + entry->size - freed <= maxSize;
+}
+
+void Mempool::RemoveEntry(MempoolEntry* entry) {
+    // 不在模板里的叶子交易：它要么轮到时放不下，要么根本没轮到，去掉它不影响任何选择，模板仍然有效
+    bool templateCurrent = templateSequence == sequence && !inTemplate.count(entry) && entry->children.empty();
+    for (MempoolEntry* a : CalculateAncestors(entry)) {
+        UpdateEntry(a, [entry](MempoolEntry* x) {
+            x->descendantCount--;
+            x->descendantSize -= entry->size;
+            x->descendantFee -= entry->fee;
+        });
+    }
+    for (MempoolEntry* d : CalculateDescendants(entry)) {
+        UpdateEntry(d, [entry](MempoolEntry* x) {
+            x->ancestorCount--;
+            x->ancestorSize -= entry->size;
+            x->ancestorFee -= entry->fee;
+        });
+    }
+    for (MempoolEntry* p : entry->parents) p->children.erase(entry);
+    for (MempoolEntry* c : entry->children) c->parents.erase(entry);
+    for (const auto& in : entry->tx.inputs) {
+        spenders.erase(OutPoint(in.prevTxId, in.prevIndex));
+    }
+    byAncestorScore.erase(entry);
+    byDescendantScore.erase(entry);
+    totalSize -= entry->size;
+    sequence++;
+    uint256 txid = entry->txid; // erase 会释放 entry，键不能引用它自己
+    entries.erase(txid);
+    if (templateCurrent) {
+        templateSequence = sequence;
+        templateSkipped = inTemplate.size() != entries.size();
+    }
+}
+
+void Mempool::RemoveWithDescendants(MempoolEntry* entry) {
+    std::set<MempoolEntry*> descendants = CalculateDescendants(entry);
+    std::vector<MempoolEntry*> order(descendants.begin(), descendants.end());
+    // 后代先移除 (祖先数多的一定在后面)，每次移除的都是叶子，统计更新最少
+    std::sort(order.begin(), order.end(), [](const MempoolEntry* a, const MempoolEntry* b) {
+        return a->ancestorCount > b->ancestorCount;
+    });
+    for (MempoolEntry* d : order) RemoveEntry(d);
+    RemoveEntry(entry);
+}
+
+void Mempool::Remove(const uint256& txid) {
+    auto it = entries.find(txid);
+    if (it != entries.end()) RemoveWithDescendants(it->second.get());
+}
+
+void Mempool::RemoveForBlock(const Block& block) {
+    for (const auto& tx : block.transactions) {
+        if (tx.IsCoinBase()) continue;
+        auto it = entries.find(tx.GetId());
+        if (it != entries.end()) {
+            // 父交易在区块里排在前面，已经移除，所以这里通常是没有池中祖先的交易
+            RemoveEntry(it->second.get());
+            continue;
+        }
+        // 区块里的交易花掉了池中交易的输入：池中那笔 (及其后代) 再也不可能有效
+        for (const auto& in : tx.inputs) {
+            auto spender = spenders.find(OutPoint(in.prevTxId, in.prevIndex));
+            if (spender != spenders.end()) RemoveWithDescendants(spender->second);
+        }
+    }
+}
+
+void Mempool::TrimToSize(size_t limit) {
+    while (totalSize > limit && !byDescendantScore.empty()) {
+        RemoveWithDescendants(*byDescendantScore.begin());
+    }
+}
+
+bool Mempool::ExtendTemplate(MempoolEntry* entry) {
+    // 1. 之前没有跳过任何包 (池中全部交易都在模板里)，新交易也放得下：贪心选取的结果就是全部交易
+    if (!templateSkipped && templateSize + entry->size <= templateMaxSize) {
+        AppendToTemplate(entry);
+        return true;
+    }
+
+    // 2. 区块已满。新交易的包 = 它自己 + 不在模板里的祖先。
+    //    包费率低于选中的每个包时，贪心选取轮到它之前的过程与原来完全相同 (新交易是叶子，不改变别的包的祖先统计)，
+    //    而且此后原来就不会再选中任何包：轮到它时区块已经是原来的最终内容。
+    if (worstSize == 0) return false;
+    int64_t packageFee = entry->fee;
+    size_t packageSize = entry->size;
+    bool parentsInTemplate = true;
+    for (MempoolEntry* a : CalculateAncestors(entry)) {
+        if (inTemplate.count(a)) continue;
+        parentsInTemplate = false;
+        packageFee += a->fee;
+        packageSize += a->size;
+    }
+    if (!FeeRateLess(packageFee, packageSize, worstFee, worstSize)) return false;
+
+    // 放不下：跳过它，模板不变
+    if (templateSize + packageSize > templateMaxSize) {
+        templateSkipped = true;
+        return true;
+    }
+    // 放得下并且祖先都已在模板里：追加到末尾。之后的包原来就放不下，剩余空间只会更少。
+    // (还要带上祖先时，被带进来的祖先会提高兄弟交易的包费率，改变后面的选择，只能重建)
+    if (parentsInTemplate) {
+        AppendToTemplate(entry);
+        return true;
+    }
+    return false;
+}
+
+void Mempool::AppendToTemplate(MempoolEntry* entry) {
+    blockTemplate.transactions.push_back(entry->tx);
+    inTemplate.insert(entry);
+    templateBranch.Append(entry->txid);
+    templateSize += entry->size;
+    templateFees += entry->fee;
+    if (worstSize == 0 || FeeRateLess(entry->fee, entry->size, worstFee, worstSize)) {
+        worstFee = entry->fee;
+        worstSize = entry->size;
+    }
+}
+
+void Mempool::RebuildTemplate(size_t maxBlockSize) {
+    std::vector<MempoolEntry*> selected;
+    templateFees = 0;
+    templateSize = BLOCK_RESERVED_SIZE;
+    worstFee = 0;
+    worstSize = 0;
+
+    // 祖先已经有一部分进了区块的交易：记下去掉这些祖先后剩下的包统计
+    struct Package {
+        MempoolEntry* entry;
+        int64_t fee;
+        size_t size;
+    };
+    struct ComparePackage {
+        bool operator()(const Package& a, const Package& b) const {
+            if (FeeRateLess(b.fee, b.size, a.fee, a.size)) return true;
+            if (FeeRateLess(a.fee, a.size, b.fee, b.size)) return false;
+            return a.entry->txid < b.entry->txid;
+        }
+    };
+    std::set<Package, ComparePackage> modified;
+    std::unordered_map<MempoolEntry*, std::set<Package, ComparePackage>::iterator> modifiedOf;
+    std::unordered_set<MempoolEntry*> inBlock;
+    std::unordered_set<MempoolEntry*> failed;
+    auto it = byAncestorScore.begin();
+
+    // 剩余空间比池中最小的交易还小时，后面不可能再放进任何包
+    size_t minSize = 0;
+    for (const auto& entry : entries) {
+        if (minSize == 0 || entry.second->size < minSize) minSize = entry.second->size;
+    }
+
+    while ((it != byAncestorScore.end() || !modified.empty()) && templateSize + minSize <= maxBlockSize) {
+        // 已经打包、打不下、或统计已经过期 (在 modified 里) 的跳过
+        if (it != byAncestorScore.end() && (inBlock.count(*it) || failed.count(*it) || modifiedOf.count(*it))) {
+            ++it;
+            continue;
+        }
+
+        // 从两个来源里取包费率更高的
+        Package best{};
+        bool fromModified;
+        if (it == byAncestorScore.end()) {
+            fromModified = true;
+        }
+        else if (modified.empty()) {
+            fromModified = false;
+        }
+        else {
+            const MempoolEntry* e = *it;
+            const Package& m = *modified.begin();
+            fromModified = FeeRateLess(e->ancestorFee, e->ancestorSize, m.fee, m.size);
+        }
+        if (fromModified) {
+            best = *modified.begin();
+            modified.erase(modified.begin());
+            modifiedOf.erase(best.entry);
+        }
+        else {
+            best = { *it, (*it)->ancestorFee, (*it)->ancestorSize };
+            ++it;
+        }
+
+        if (templateSize + best.size > maxBlockSize) {
+            failed.insert(best.entry);
+            continue;
+        }
+        if (worstSize == 0 || FeeRateLess(best.fee, best.size, worstFee, worstSize)) {
+            worstFee = best.fee;
+            worstSize = best.size;
+        }
+
+        // 包 = 它自己 + 还没进区块的祖先，按祖先数排序即是父在前、子在后的顺序
+        std::vector<MempoolEntry*> package;
+        for (MempoolEntry* a : CalculateAncestors(best.entry)) {
+            if (!inBlock.count(a)) package.push_back(a);
+        }
+        package.push_back(best.entry);
+        std::sort(package.begin(), package.end(), [](const MempoolEntry* a, const MempoolEntry* b) {
+            return a->ancestorCount < b->ancestorCount;
+        });
+
+        for (MempoolEntry* p : package) {
+            inBlock.insert(p);
+            selected.push_back(p);
+            templateFees += p->fee;
+            templateSize += p->size;
+            auto m = modifiedOf.find(p);
+            if (m != modifiedOf.end()) {
+                modified.erase(m->second);
+                modifiedOf.erase(m);
+            }
+        }
+
+        // 还在池中的后代少了这些祖先，更新它们的包统计
+        for (MempoolEntry* p : package) {
+            for (MempoolEntry* d : CalculateDescendants(p)) {
+                if (inBlock.count(d)) continue;
+                Package pkg = { d, d->ancestorFee, d->ancestorSize };
+                auto m = modifiedOf.find(d);
+                if (m != modifiedOf.end()) {
+                    pkg = *m->second;
+                    modified.erase(m->second);
+                }
+                pkg.fee -= p->fee;
+                pkg.size -= p->size;
+                modifiedOf[d] = modified.insert(pkg).first;
+            }
+        }
+    }
+
+    // 没有选中全部交易，说明有包因为放不下被跳过
+    templateSkipped = inBlock.size() != entries.size();
+
+    // 交易直接放进 transactions (都已冻结)，默克尔根由 templateBranch 计算
+    blockTemplate.transactions.clear();
+    blockTemplate.transactions.reserve(selected.size() + 1);
+    blockTemplate.transactions.emplace_back(); // coinbase 占位
+    templateBranch.Clear();
+    for (MempoolEntry* e : selected) {
+        blockTemplate.transactions.push_back(e->tx);
+        templateBranch.Append(e->txid);
+    }
+    inTemplate = std::move(inBlock);
+
+    templateSequence = sequence;
+    templateMaxSize = maxBlockSize;
+    templateTip = chain.GetTip()->hash;
+}
+
+const Block& Mempool::BuildBlockTemplate(const std::string& coinbaseAddress, uint32_t timestamp, size_t maxBlockSize) {
+    return BuildBlockTemplate(TxOut(0, coinbaseAddress).pubKeyHash, timestamp, maxBlockSize);
+}
+
+const Block& Mempool::BuildBlockTemplate(const uint160& coinbasePubKeyHash, uint32_t timestamp, size_t maxBlockSize) {
+    if (templateSequence != sequence || templateMaxSize != maxBlockSize || templateTip != chain.GetTip()->hash) {
+        RebuildTemplate(maxBlockSize);
+    }
+
+    uint32_t height = chain.GetHeight() + 1;
+    Transaction coinbase = MakeCoinbase(height, coinbasePubKeyHash, GetBlockSubsidy(height) + templateFees);
+    coinbase.Freeze();
+    uint256 coinbaseId = coinbase.GetId();
+    blockTemplate.transactions[0] = std::move(coinbase);
+
+    blockTemplate.Thaw();
+    blockTemplate.version = 1;
+    blockTemplate.prevBlockHash = templateTip;
+    blockTemplate.merkleRoot = templateBranch.Root(coinbaseId);
+    blockTemplate.timestamp = timestamp;
+    blockTemplate.bits = chain.GetNextWorkRequired();
+    blockTemplate.nonce = 0;
+    return blockTemplate;
+}
@@ -0,0 +1,177 @@
+﻿#ifndef BITCOIN_CORE_MEMPOOL_H
+#define BITCOIN_CORE_MEMPOOL_H
+
+#include "Block.h"
+#include "Merkle.h"
+#include "UtxoSet.h"
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Blockchain;
+class SigCache;
+
+// 区块大小上限 (对应 v0.1.5 main.h 中的 MAX_BLOCK_SIZE)
+static const size_t MAX_BLOCK_SIZE = 1000000;
+// 打包时给区块头和 coinbase 预留的字节数
+static const size_t BLOCK_RESERVED_SIZE = 1000;
+// 一笔交易在池中的祖先 / 后代个数上限 (都包括它自己)，限制每次增量更新的代价
+static const size_t MAX_ANCESTOR_COUNT = 25;
+static const size_t MAX_DESCENDANT_COUNT = 25;
+// 池的默认容量：所有交易序列化后的总字节数
+static const size_t DEFAULT_MEMPOOL_MAX_SIZE = 300 * 1000 * 1000;
+
+// 池中的一笔交易 (对应 Bitcoin Core 的 CTxMemPoolEntry)
+struct MempoolEntry {
+    Transaction tx;        // 冻结的副本，txid 和签名哈希不会再算第二次
+    uint256 txid;
+    int64_t fee = 0;
+    size_t size = 0;       // 序列化后的字节数
+
+    std::set<MempoolEntry*> parents;   // 它直接花费的池中交易
+    std::set<MempoolEntry*> children;  // 直接花费它的池中交易
+
+    // 包括自己在内的全部祖先 / 后代的统计，加入和移除交易时增量维护
+    size_t ancestorCount = 1;
+    size_t ancestorSize = 0;
+    int64_t ancestorFee = 0;
+    size_t descendantCount = 1;
+    size_t descendantSize = 0;
+    int64_t descendantFee = 0;
+};
+
+// 内存池：还没有被打包的交易
+// 三个索引：txid -> 交易，被花费的输出 -> 花费它的交易 (发现冲突)，
+// 按手续费率排序的两个有序集合 (祖先包费率从高到低用于打包，后代包费率从低到高用于淘汰)。
+// 祖先 / 后代统计在每次加入和移除时增量更新，打包时不需要重新排序整个池。
+// 非线程安全；它引用的 Blockchain 连接或断开区块后调用 RemoveForBlock。
+// 重组时被断开区块里的交易不会自动放回池中。
+class Mempool {
+public:
+    explicit Mempool(const Blockchain& chain, size_t maxSize = DEFAULT_MEMPOOL_MAX_SIZE);
+    ~Mempool();
+
+    Mempool(const Mempool&) = delete;
+    Mempool& operator=(const Mempool&) = delete;
+
+    // 验证并加入一笔交易：输入必须存在于主链 UTXO 或池中的其他交易，不能与池中交易冲突，
+    // 签名在这里验证并写入签名缓存 (之后 AddBlock 直接命中)。不合法时抛出异常，池保持不变。
+    // 池满时按后代包费率从低到高淘汰别的包腾出空间；轮到淘汰新交易所在的包 (它自己或它的祖先) 时
+    // 在修改池之前就拒绝，同样保持不变。
+    void AddTransaction(const Transaction& tx);
+
+    bool Contains(const uint256& txid) const { return entries.count(txid) != 0; }
+
+    // 按 txid 查找，不存在返回 nullptr (指针在下一次修改池之前有效)
+    const MempoolEntry* Get(const uint256& txid) const;
+
+    // 池中花费了 outpoint 的交易，没有返回 nullptr
+    const MempoolEntry* GetSpender(const OutPoint& outpoint) const;
+
+    // 移除一笔交易以及所有依赖它的交易
+    void Remove(const uint256& txid);
+
+    // 区块连接到主链后调用：移除已经打包的交易，以及与区块中交易冲突的交易 (连同它们的后代)
+    void RemoveForBlock(const Block& block);
+
+    // 超过 maxSize 时按后代包费率从低到高淘汰
+    void TrimToSize(size_t maxSize);
+
+    // 在当前链尾上组装一个待挖的区块：coinbase (奖励 + 手续费付给 coinbaseAddress) + 池中交易。
+    // 按祖先包费率从高到低选取 (子交易可以带着父交易一起进入区块)，总大小不超过 maxBlockSize。
+    // 返回的区块已经填好默克尔根，只差挖矿 (引用在下一次修改池之前有效，挖矿前先拷贝一份)。
+    // 模板是增量维护的，结果始终与完整的贪心选取相同：
+    //   池没有变化时只换 coinbase 并用缓存的路径重算默克尔根 (O(log n) 次哈希)；
+    //   新交易的包费率低于模板里的每个包时 (区块已满时的常见情况) 直接追加或跳过；
+    //   移除 (淘汰、冲突) 不在模板里的交易时模板不变。
+    // 以下情况完整重建 (按包费率遍历池，池越大越慢，见 bench_mybitcoin 的 mempool/ 用例)：
+    //   区块已满时加入包费率高于模板中最低者的交易 (它会挤掉别的包)、移除模板里的交易、
+    //   链尾变化 (连接区块后第一次调用)、maxBlockSize 改变。
+    const Block& BuildBlockTemplate(const uint160& coinbasePubKeyHash, uint32_t timestamp, size_t maxBlockSize = MAX_BLOCK_SIZE);
+    const Block& BuildBlockTemplate(const std::string& coinbaseAddress, uint32_t timestamp, size_t maxBlockSize = MAX_BLOCK_SIZE);
+
+    // 最近一次 BuildBlockTemplate 的 coinbase 默克尔分支 (见 CoinbaseMerkleBranch::Branch)
+    std::vector<uint256> GetTemplateCoinbaseBranch() const { return templateBranch.Branch(); }
+
+    // 每次修改池都会变化，与上次记下的值不同说明模板需要更新
+    uint64_t GetSequence() const { return sequence; }
+
+    // 设置签名缓存 (默认 SigCache::Shared())，为空时不用缓存
+    void SetSignatureCache(SigCache* cache) { sigCache = cache; }
+
+    size_t Size() const { return entries.size(); }
+    size_t TotalSize() const { return totalSize; }
+    size_t MaxSize() const { return maxSize; }
+
+private:
+    struct OutPointHasher {
+        size_t operator()(const OutPoint& o) const;
+    };
+
+    // 祖先包费率高的在前，相同时按 txid
+    struct CompareAncestorScore {
+        bool operator()(const MempoolEntry* a, const MempoolEntry* b) const;
+    };
+
+    // 后代包费率低的在前，相同时按 txid
+    struct CompareDescendantScore {
+        bool operator()(const MempoolEntry* a, const MempoolEntry* b) const;
+    };
+
+    // 全部祖先 / 后代 (不包括自己)
+    std::set<MempoolEntry*> CalculateAncestors(const MempoolEntry* entry) const;
+    std::set<MempoolEntry*> CalculateDescendants(const MempoolEntry* entry) const;
+
+    // 修改会影响排序的统计字段：先从有序索引中取出，改完再放回
+    template <typename F>
+    void UpdateEntry(MempoolEntry* entry, F&& update);
+
+    // 移除单笔交易，更新池中剩余祖先和后代的统计
+    void RemoveEntry(MempoolEntry* entry);
+    void RemoveWithDescendants(MempoolEntry* entry);
+
+    // 加入 entry (祖先为 ancestors，尚未放进池) 后超出 maxSize 时，按后代包费率从低到高选出要淘汰的包 (不含它的祖先)；
+    // 在腾出足够空间之前就轮到 entry 所在的包时返回 false
+    bool SelectEvictions(const MempoolEntry* entry, const std::set<MempoolEntry*>& ancestors,
+                         std::vector<MempoolEntry*>& evict) const;
+
+    // 按祖先包费率重新选出要打包的交易 (父交易总在子交易前面)，重建模板
+    void RebuildTemplate(size_t maxBlockSize);
+
+    // 刚加入的 entry 不改变已有选择时直接更新模板，返回 false 表示需要重建
+    bool ExtendTemplate(MempoolEntry* entry);
+
+    // 把 entry 追加到模板末尾 (它的池中祖先必须都已在模板里)
+    void AppendToTemplate(MempoolEntry* entry);
+
+    const Blockchain& chain;
+    size_t maxSize;
+    SigCache* sigCache;
+
+    std::unordered_map<uint256, std::unique_ptr<MempoolEntry>> entries;
+    std::unordered_map<OutPoint, MempoolEntry*, OutPointHasher> spenders;
+    std::set<MempoolEntry*, CompareAncestorScore> byAncestorScore;
+    std::set<MempoolEntry*, CompareDescendantScore> byDescendantScore;
+    size_t totalSize = 0;
+
+    // 每次修改池都加一
+    uint64_t sequence = 0;
+
+    // --- 区块模板 ---
+    Block blockTemplate;                          // transactions[0] 是 coinbase，其余按选取顺序
+    std::unordered_set<MempoolEntry*> inTemplate;
+    CoinbaseMerkleBranch templateBranch;
+    uint64_t templateSequence = UINT64_MAX;       // 与 sequence 相同说明模板反映了池的当前内容
+    size_t templateMaxSize = 0;
+    uint256 templateTip;
+    size_t templateSize = 0;                      // 已用的字节数 (含 BLOCK_RESERVED_SIZE)
+    int64_t templateFees = 0;
+    bool templateSkipped = false;                 // 有包因为放不下被跳过
+    int64_t worstFee = 0;                         // 选中的包里费率最低的一个
+    size_t worstSize = 0;
+};
+
+#endif //BITCOIN_CORE_MEMPOOL_H
@@ -1,32 +1,300 @@
 #include "Merkle.h"
+#include "Block.h"
+#include "../Crypto/Sha256.h"
+#include "../Utils/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 
-Bytes ComputeMerkleRoot(const std::vector<Transaction>& txs) {
-    if (txs.empty()) return Bytes(32, 0);
+namespace {
 
-    // 1. ȡн׵ TxID (Hash)
-    std::vector<Bytes> hashes;
-    for (const auto& tx : txs) {
-        hashes.push_back(tx.GetId());
+// 32 ֽڶĹϣۣһһڴ
+struct alignas(32) HashSlot {
+    uint8_t data[32];
+};
+
+// ֵŰ txid ָ̳߳ (̫ٵĻ̵߳ȿȼ㻹)
+const size_t PARALLEL_TXID_THRESHOLD = 256;
+// ÿ߳һȡĽ
+const size_t TXID_GRAIN = 64;
+
+} // namespace
+
+uint256 ComputeMerkleRoot(const std::vector<Transaction>& txs) {
+    if (txs.empty()) return uint256();
+
+    // һλĳһʱһƵﲹ
+    const size_t n = txs.size();
+    std::vector<HashSlot> level(n + 1);
+
+    // 1. ȡн׵ TxID (Hash)׶ʱм
+    auto computeIds = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint256 id = txs[i].GetId();
+            memcpy(level[i].data, id.data(), 32);
+        }
+    };
+    if (n >= PARALLEL_TXID_THRESHOLD) {
+        ThreadPool::Shared().ParallelFor(n, TXID_GRAIN, computeIds);
+    }
+    else {
+        computeIds(0, n);
     }
 
-    // 2. ϼ
-    while (hashes.size() > 1) {
+    // 2. ϼ㣺ÿһڵ 32 ֽһ 64 ֽ룬
+    //    ֱӽ SIMD ںԭعԼҪƴҲ²
+    size_t count = n;
+    while (count > 1) {
         // һ
-        if (hashes.size() % 2 != 0) {
-            hashes.push_back(hashes.back());
+        if (count % 2 != 0) {
+            level[count] = level[count - 1];
+            count++;
+        }
+        Sha256D64Batch(level[0].data, level[0].data, count / 2);
+        count /= 2;
+    }
+
+    uint256 root;
+    memcpy(root.data(), level[0].data, 32);
+    return root;
+}
+
+bool HasDuplicateLeaves(const std::vector<uint256>& leaves) {
+    std::vector<uint256> sorted(leaves);
+    std::sort(sorted.begin(), sorted.end());
+    return std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end();
+}
+
+uint256 MerkleHashPair(const uint256& left, const uint256& right) {
+    uint8_t concat[64];
+    memcpy(concat, left.data(), 32);
+    memcpy(concat + 32, right.data(), 32);
+    return Hash256(concat, sizeof(concat));
+}
+
+void MerkleFrontier::Append(const uint256& leaf) {
+    uint64_t count = leaves.size();
+    leaves.push_back(leaf);
+
+    // count λ 1 ʾЩһõԵϲȥ (ƽλ)
+    uint256 h = leaf;
+    size_t level = 0;
+    while (count & (1ULL << level)) {
+        h = MerkleHashPair(inner[level], h);
+        level++;
+    }
+    if (inner.size() <= level) inner.resize(level + 1);
+    inner[level] = h;
+}
+
+uint256 MerkleFrontier::Root() const {
+    uint64_t count = leaves.size();
+    if (count == 0) return uint256();
+
+    // ͵һʼϺϲ
+    size_t level = 0;
+    while (!(count & (1ULL << level))) level++;
+    uint256 h = inner[level];
+
+    while (count != (1ULL << level)) {
+        // h Ƕ㣺رҵĹһһԼ
+        h = MerkleHashPair(h, h);
+        // ൱һһڵ㣬 count żλ
+        count += (1ULL << level);
+        level++;
+        // λĲ㶼һκϲ
+        while (!(count & (1ULL << level))) {
+            h = MerkleHashPair(inner[level], h);
+            level++;
+        }
+    }
+    return h;
+}
+
+void MerkleFrontier::Clear() {
+    leaves.clear();
+    inner.clear();
+}
+
+void CoinbaseMerkleBranch::Append(const uint256& leaf) {
+    // Ҷӵ± 2 ݣһΧѾĸ̶
+    if (count > 1 && (count & (count - 1)) == 0) {
+        siblings.push_back(last.Root());
+        last.Clear();
+    }
+    last.Append(leaf);
+    count++;
+}
+
+uint256 CoinbaseMerkleBranch::LastSibling() const {
+    // һΧ 2^k Ҷӣֻ m 
+    // ǵĸڵ ceil(log2 m) 㣬ÿ㶼Լֱ k 
+    size_t k = siblings.size();
+    size_t depth = 0;
+    while ((size_t(1) << depth) < last.Size()) depth++;
+    uint256 partial = last.Root();
+    for (; depth < k; depth++) partial = MerkleHashPair(partial, partial);
+    return partial;
+}
+
+uint256 CoinbaseMerkleBranch::Root(const uint256& first) const {
+    uint256 h = first;
+    for (const auto& sibling : siblings) h = MerkleHashPair(h, sibling);
+    if (last.Size() == 0) return h;
+    return MerkleHashPair(h, LastSibling());
+}
+
+std::vector<uint256> CoinbaseMerkleBranch::Branch() const {
+    std::vector<uint256> branch = siblings;
+    if (last.Size() != 0) branch.push_back(LastSibling());
+    return branch;
+}
+
+void CoinbaseMerkleBranch::Clear() {
+    count = 1;
+    siblings.clear();
+    last.Clear();
+}
+
+MerkleBranch BuildMerkleBranch(const std::vector<uint256>& leaves, uint32_t index) {
+    MerkleBranch branch;
+    if (index >= leaves.size()) {
+        throw std::out_of_range("BuildMerkleBranch: index out of range");
+    }
+    branch.txid = leaves[index];
+    branch.index = index;
+
+    //  ComputeMerkleRoot һһԭعԼ˳ֵܽڵ
+    std::vector<uint256> level(leaves.size() + 1);
+    std::copy(leaves.begin(), leaves.end(), level.begin());
+    size_t count = leaves.size();
+    size_t pos = index;
+    while (count > 1) {
+        if (count % 2 != 0) {
+            level[count] = level[count - 1];
+            count++;
         }
+        branch.siblings.push_back(level[pos ^ 1]);
+        Sha256D64Batch(level[0].data(), level[0].data(), count / 2);
+        count /= 2;
+        pos >>= 1;
+    }
+    return branch;
+}
+
+bool BuildMerkleBranch(const Block& block, const uint256& txid, MerkleBranch& branch) {
+    // ﻺȫ txid ʱֱãл
+    std::vector<uint256> ids;
+    const MerkleFrontier& tree = block.GetMerkleTree();
+    if (tree.Size() == block.transactions.size()) {
+        ids = tree.Leaves();
+    }
+    else {
+        for (const auto& tx : block.transactions) ids.push_back(tx.GetId());
+    }
 
-        std::vector<Bytes> newLevel;
-        // 
-        for (size_t i = 0; i < hashes.size(); i += 2) {
-            // ƴ left + right
-            Bytes concat = hashes[i];
-            concat.insert(concat.end(), hashes[i + 1].begin(), hashes[i + 1].end());
-            // ˫عϣ
-            newLevel.push_back(Hash256(concat));
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (ids[i] == txid) {
+            branch = BuildMerkleBranch(ids, static_cast<uint32_t>(i));
+            return true;
         }
-        hashes = newLevel;
     }
+    return false;
+}
+
+uint256 ComputeMerkleRootFromBranch(const uint256& leaf, const std::vector<uint256>& siblings, uint32_t index) {
+    uint256 h = leaf;
+    for (const auto& sibling : siblings) {
+        h = (index & 1) ? MerkleHashPair(sibling, h) : MerkleHashPair(h, sibling);
+        index >>= 1;
+    }
+    return h;
+}
+
+// ±ĸλȫΪ 0ͬһ·ԶӦ±
+static bool BranchIndexValid(const MerkleBranch& branch) {
+    if (branch.siblings.size() >= 32) return true;
+    return (branch.index >> branch.siblings.size()) == 0;
+}
+
+bool VerifyMerkleBranch(const MerkleBranch& branch, const uint256& merkleRoot) {
+    if (!BranchIndexValid(branch)) return false;
+    return ComputeMerkleRootFromBranch(branch.txid, branch.siblings, branch.index) == merkleRoot;
+}
+
+bool VerifyMerkleBranch(const MerkleBranch& branch, const Block& header) {
+    return VerifyMerkleBranch(branch, header.merkleRoot);
+}
+
+std::vector<bool> BatchVerifyMerkleBranches(const std::vector<MerkleProof>& proofs) {
+    // 1. 
+    std::unordered_map<uint256, std::vector<size_t>> groupIndex;
+    for (size_t i = 0; i < proofs.size(); i++) {
+        groupIndex[proofs[i].merkleRoot].push_back(i);
+    }
+    std::vector<const std::vector<size_t>*> groups;
+    for (const auto& g : groupIndex) groups.push_back(&g.second);
+
+    // vector<bool> λ洢߳дͬһֽڲȫд char 
+    std::vector<char> valid(proofs.size(), 0);
+
+    // 2. ÿ֤֮䲢
+    auto verifyGroups = [&](size_t begin, size_t end) {
+        for (size_t g = begin; g < end; g++) {
+            // ֤ʵĽڵ㣺key = ( << 32) | ò±
+            std::unordered_map<uint64_t, uint256> known;
+            std::vector<std::pair<uint64_t, uint256>> path;
+
+            for (size_t idx : *groups[g]) {
+                const MerkleProof& proof = proofs[idx];
+                const MerkleBranch& b = proof.branch;
+                if (!BranchIndexValid(b)) continue;
+
+                path.clear();
+                uint256 h = b.txid;
+                uint64_t pos = b.index;
+                bool failed = false;
+                for (size_t level = 0; level <= b.siblings.size(); level++) {
+                    uint64_t key = ((uint64_t)level << 32) | (pos & 0xFFFFFFFF);
+                    auto node = known.find(key);
+                    // ֪ڵ㲻ͬĸȻͬ
+                    if (node != known.end() && node->second != h) {
+                        failed = true;
+                        break;
+                    }
+                    path.emplace_back(key, h);
+                    if (level == b.siblings.size()) break;
+
+                    const uint256& sibling = b.siblings[level];
+                    uint64_t siblingKey = ((uint64_t)level << 32) | ((pos ^ 1) & 0xFFFFFFFF);
+                    uint64_t parentKey = ((uint64_t)(level + 1) << 32) | ((pos >> 1) & 0xFFFFFFFF);
+                    auto sib = known.find(siblingKey);
+                    auto parent = known.find(parentKey);
+                    if (node != known.end() && sib != known.end() && parent != known.end()) {
+                        // һѾֻ֤Ƚֵܽڵ㣬ڵֱȡֵ֪ùϣ
+                        if (sib->second != sibling) {
+                            failed = true;
+                            break;
+                        }
+                        h = parent->second;
+                    }
+                    else {
+                        path.emplace_back(siblingKey, sibling);
+                        h = (pos & 1) ? MerkleHashPair(sibling, h) : MerkleHashPair(h, sibling);
+                    }
+                    pos >>= 1;
+                }
+                bool ok = !failed && h == proof.merkleRoot;
+
+                if (ok) {
+                    // ·ϵĽڵֵܽڵ㶼֤ʵ֤
+                    for (const auto& node : path) known.emplace(node.first, node.second);
+                    valid[idx] = 1;
+                }
+            }
+        }
+    };
+    ThreadPool::Shared().ParallelFor(groups.size(), 1, verifyGroups);
 
-    return hashes[0];
+    return std::vector<bool>(valid.begin(), valid.end());
 }
\ No newline at end of file
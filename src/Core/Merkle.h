@@ -5,9 +5,109 @@
 #include "Transaction.h"
 #include <vector>
 
+class Block;
+
 // Ĭ˶
 // 룺н׵б
 // 32ֽڵĸϣ
-Bytes ComputeMerkleRoot(const std::vector<Transaction>& txs);
+// ׽϶ʱù̳߳زм txid֮һԭعԼ
+uint256 ComputeMerkleRoot(const std::vector<Transaction>& txs);
+
+// txid бǷظ
+// ĳһʱһڵԼԣ [.., b, c]  [.., b, c, c] Ĭ˶ͬ (CVE-2012-2459)
+// ظ׵ıúϷͷϷﲻͬĽף֤ʱֱӾܾ
+bool HasDuplicateLeaves(const std::vector<uint256>& leaves);
+
+// һڲڵ㣺Hash256(left + right)
+uint256 MerkleHashPair(const uint256& left, const uint256& right);
+
+// ֻ׷ӵĬ˶
+// ȫҶ (txid) ԼÿһδԵ ( log2(n)+1 )
+// ׷һҶֻ O(log n) ιϣʱ O(log n) ιϣǰĸ
+// ͬĽб ComputeMerkleRoot ȫһ¡
+class MerkleFrontier {
+public:
+    // ׷һҶ (׵ txid)
+    void Append(const uint256& leaf);
+
+    // ǰĬ˶ (ûҶʱȫ 0)
+    uint256 Root() const;
+
+    // ׷ӵҶӸ
+    size_t Size() const { return leaves.size(); }
+
+    // ȫҶ (׷˳)
+    const std::vector<uint256>& Leaves() const { return leaves; }
+
+    void Clear();
+
+private:
+    std::vector<uint256> leaves;
+    // inner[k] 2^k ҶӵҶĵ k λΪ 1 ʱЧ
+    std::vector<uint256> inner;
+};
+
+// һҶ (coinbase) ·Ҷֻ׷
+// ģãбʱһ coinbaseֻ O(log n) ιϣܵõµĬ˶
+// siblings[k] ǸҶ [2^k, 2^(k+1)) ֻһܲҶӷ last 
+// ׷ҶֻӰһֵܽڵ㡣
+class CoinbaseMerkleBranch {
+public:
+    // ׷ӵ 1, 2, ... Ҷ ( 0  coinbase)
+    void Append(const uint256& leaf);
+
+    //  0 ҶΪ first ʱĬ˶ ComputeMerkleRoot ȫһ
+    uint256 Root(const uint256& first) const;
+
+    // coinbase ·Եϵֵܽڵ㣺
+    // ComputeMerkleRootFromBranch(first, Branch(), 0) == Root(first)ⲿԼĬ˶
+    std::vector<uint256> Branch() const;
+
+    //  coinbase ڵҶӸ
+    size_t Size() const { return count; }
+
+    void Clear();
+
+private:
+    // һֵܽڵ (last Ϊʱ)
+    uint256 LastSibling() const;
+
+    size_t count = 1;
+    std::vector<uint256> siblings;  // Ѿֵܽڵ
+    MerkleFrontier last;            // һ (ܲ) ֵܽڵ㷶ΧڵҶ
+};
+
+// --- Ĭ˶֤ (ͻ SPV) ---
+// ֤ĳʽֻҪҶӵ·ϵֵܽڵ (log2(n) ϣ)
+// ͻõͷ + ֤ȷϣ顣
+struct MerkleBranch {
+    uint256 txid;                   // ֤Ľ
+    uint32_t index = 0;             // еλã k λ k (0)Һ(1)
+    std::vector<uint256> siblings;  // Եÿһֵܽڵ
+};
+
+// Ҷ±֤ (leaves Ϊȫ txid)
+MerkleBranch BuildMerkleBranch(const std::vector<uint256>& leaves, uint32_t index);
+
+// Ϊеĳʽ֤ײз false
+bool BuildMerkleBranch(const Block& block, const uint256& txid, MerkleBranch& branch);
+
+// ֤·Ҷ㵽
+uint256 ComputeMerkleRootFromBranch(const uint256& leaf, const std::vector<uint256>& siblings, uint32_t index);
+
+// ֤֤ǷĬ˶ / ͷе merkleRoot һ
+bool VerifyMerkleBranch(const MerkleBranch& branch, const uint256& merkleRoot);
+bool VerifyMerkleBranch(const MerkleBranch& branch, const Block& header);
+
+// ֤еһ֤ + ƵͷĬ˶
+struct MerkleProof {
+    MerkleBranch branch;
+    uint256 merkleRoot;
+};
+
+// ֤֤ÿǷЧ (˳һ)
+//  (merkleRoot) 鲢֤ͬһѾ֤ڵᱻס
+// ֤һ㵽һ֪ڵͿֱжϲ·ظϣ
+std::vector<bool> BatchVerifyMerkleBranches(const std::vector<MerkleProof>& proofs);
 
 #endif //BITCOIN_CORE_MERKLE_H
\ No newline at end of file
@@ -0,0 +1,51 @@
+﻿#include "Pow.h"
+
+bool DecodeTarget(uint32_t bits, ArithUint256& target) {
+    bool negative = false;
+    bool overflow = false;
+    target.SetCompact(bits, &negative, &overflow);
+    return !negative && !overflow && target != ArithUint256();
+}
+
+bool CheckProofOfWork(const uint256& hash, uint32_t bits) {
+    ArithUint256 target;
+    if (!DecodeTarget(bits, target)) return false;
+    return HashMeetsTarget(hash.data(), target);
+}
+
+ArithUint256 GetBlockWork(uint32_t bits) {
+    ArithUint256 target;
+    if (!DecodeTarget(bits, target)) return ArithUint256();
+    // 2^256 放不进 256 位，改用等价的 (2^256 - target - 1) / (target + 1) + 1
+    return (~target / (target + 1)) + 1;
+}
+
+uint32_t CalculateNextWorkRequired(uint32_t lastBits, int64_t firstTime, int64_t lastTime, uint32_t blocks,
+                                   const ConsensusParams& params) {
+    int64_t expected = static_cast<int64_t>(params.targetSpacing) * blocks;
+    if (expected <= 0) return lastBits;
+    int64_t actual = lastTime - firstTime;
+    if (actual < expected / 4) actual = expected / 4;
+    if (actual > expected * 4) actual = expected * 4;
+
+    ArithUint256 limit;
+    DecodeTarget(params.powLimitBits, limit);
+    ArithUint256 target;
+    target.SetCompact(lastBits);
+
+    // 新目标 = 旧目标 * actual / expected。旧目标接近 2^256 时先乘会溢出，
+    // 所以拆成 (q * expected + r) * actual / expected = q * actual + r * actual / expected，结果与直接计算完全相同
+    uint32_t actual32 = static_cast<uint32_t>(actual);
+    uint32_t expected32 = static_cast<uint32_t>(expected);
+    ArithUint256 q = target / ArithUint256(expected32);
+    ArithUint256 r = target - q * expected32;
+    if (q.Bits() + ArithUint256(actual32).Bits() > 256) {
+        target = limit; // 超出 256 位，肯定大于上限
+    }
+    else {
+        target = q * actual32 + (r * actual32) / ArithUint256(expected32);
+    }
+    if (target == ArithUint256()) target = 1;
+    if (target > limit) target = limit;
+    return target.GetCompact();
+}
@@ -0,0 +1,52 @@
+﻿#ifndef BITCOIN_CORE_POW_H
+#define BITCOIN_CORE_POW_H
+
+#include <cstdint>
+#include "../Crypto/ArithUint256.h"
+
+// 工作量证明 (对应 Bitcoin Core pow.h / pow.cpp)
+// 区块头的 bits 是 compact 格式的 256 位目标值，区块哈希 (当作小端序整数) 不超过目标才算合格。
+
+// 共识参数：难度上限和难度调整规则
+struct ConsensusParams {
+    uint32_t powLimitBits = 0x1f00ffff; // 最低难度 (最大目标)，创世区块使用它
+    uint32_t targetSpacing = 600;       // 期望的出块间隔 (秒)
+    uint32_t retargetInterval = 0;      // 每多少个区块按时间戳调整一次难度；0 = 难度固定为 powLimitBits
+                                        // (targetSpacing * retargetInterval * 4 必须小于 2^32)
+
+    // 固定难度 (不调整)
+    static ConsensusParams Fixed(uint32_t bits) {
+        ConsensusParams params;
+        params.powLimitBits = bits;
+        return params;
+    }
+};
+
+// 解码 bits；负数、溢出或目标为 0 时返回 false
+bool DecodeTarget(uint32_t bits, ArithUint256& target);
+
+// hash (32 字节小端序，即 Hash256 的输出) 是否 <= target
+// 从最高位的字开始比较，随机哈希通常在第一个字就能分出结果，不分配内存
+inline bool HashMeetsTarget(const uint8_t hash[32], const ArithUint256& target) {
+    for (int i = ArithUint256::WIDTH - 1; i >= 0; i--) {
+        const uint8_t* p = hash + 4 * i;
+        uint32_t word = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        if (word != target.Word(i)) return word < target.Word(i);
+    }
+    return true; // 与目标完全相等也算合格
+}
+
+// 区块哈希是否满足 bits (bits 不合法时返回 false)
+bool CheckProofOfWork(const uint256& hash, uint32_t bits);
+
+// 一个区块的工作量 = 2^256 / (target + 1)，即找到合格哈希平均要算的次数
+// bits 不合法时返回 0
+ArithUint256 GetBlockWork(uint32_t bits);
+
+// 难度调整：last 是上一个区块的 bits，firstTime / lastTime 是统计区间首尾区块的时间戳，
+// blocks 是区间内的出块间隔数。实际耗时限制在期望耗时的 [1/4, 4] 倍内 (防止时间戳作假导致难度剧变)，
+// 新目标 = 旧目标 * 实际耗时 / 期望耗时，并且不超过 powLimitBits
+uint32_t CalculateNextWorkRequired(uint32_t lastBits, int64_t firstTime, int64_t lastTime, uint32_t blocks,
+                                   const ConsensusParams& params);
+
+#endif //BITCOIN_CORE_POW_H
@@ -0,0 +1,243 @@
+﻿#ifndef BITCOIN_CORE_SERIALIZE_H
+#define BITCOIN_CORE_SERIALIZE_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "../Crypto/Hash.h"
+#include "../Crypto/Sha256.h"
+
+// 流式序列化 (对应 v0.1.5 serialize.h)
+// 输出流只需要提供 Write(const uint8_t*, size_t)：
+//   SizeComputer 只数字节，先用它算出准确长度，再一次性分配并用 SpanWriter 写入；
+//   HashWriter 直接把数据喂给 SHA-256，算 txid 时完全不需要中间缓冲区。
+// 输入流 SpanReader 在一段只读内存上解析，所有读取都检查边界，数据不完整或格式不对时抛异常。
+
+// 单个变长字段的上限，防止恶意数据让我们分配巨大的内存
+static const uint64_t MAX_SERIALIZED_SIZE = 0x02000000; // 32 MB
+
+// 指向外部缓冲区的只读字节跨度，不拥有数据
+struct ByteView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    ByteView() {}
+    ByteView(const uint8_t* d, size_t n) : data(d), size(n) {}
+    explicit ByteView(const Bytes& b) : data(b.data()), size(b.size()) {}
+
+    Bytes ToBytes() const { return Bytes(data, data + size); }
+    std::string ToString() const { return std::string(reinterpret_cast<const char*>(data), size); }
+
+    friend bool operator==(const ByteView& a, const ByteView& b) {
+        return a.size == b.size && (a.size == 0 || memcmp(a.data, b.data, a.size) == 0);
+    }
+    friend bool operator!=(const ByteView& a, const ByteView& b) { return !(a == b); }
+};
+
+// --- 输出流 ---
+
+// 只统计长度
+class SizeComputer {
+public:
+    void Write(const uint8_t*, size_t len) { size += len; }
+    size_t Size() const { return size; }
+
+private:
+    size_t size = 0;
+};
+
+// 写入调用方预先分配好的缓冲区 (长度通常由 SizeComputer 算出)
+class SpanWriter {
+public:
+    SpanWriter(uint8_t* data, size_t size) : p(data), end(data + size) {}
+
+    void Write(const uint8_t* data, size_t len) {
+        if (static_cast<size_t>(end - p) < len) throw std::length_error("SpanWriter: buffer too small");
+        if (len) memcpy(p, data, len);
+        p += len;
+    }
+
+    size_t Remaining() const { return end - p; }
+
+private:
+    uint8_t* p;
+    uint8_t* end;
+};
+
+// 追加到 Bytes 末尾 (长度事先不好算的场合，例如遍历 UTXO 集合)
+class VectorWriter {
+public:
+    explicit VectorWriter(Bytes& out) : out(out) {}
+    void Write(const uint8_t* data, size_t len) { out.insert(out.end(), data, data + len); }
+
+private:
+    Bytes& out;
+};
+
+// 边写边算双重 SHA-256，结果与 Hash256(序列化结果) 相同
+class HashWriter {
+public:
+    void Write(const uint8_t* data, size_t len) { hasher.Write(data, len); }
+
+    uint256 GetHash() {
+        uint256 result;
+        hasher.Finalize(result.data());
+        Sha256Hasher().Write(result.data(), result.size()).Finalize(result.data());
+        return result;
+    }
+
+private:
+    Sha256Hasher hasher;
+};
+
+// --- 基本类型 (全部小端序) ---
+
+template <typename Stream>
+void WriteU8(Stream& s, uint8_t v) {
+    s.Write(&v, 1);
+}
+
+template <typename Stream>
+void WriteLE32(Stream& s, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    s.Write(b, 4);
+}
+
+template <typename Stream>
+void WriteLE64(Stream& s, uint64_t v) {
+    uint8_t b[8];
+    for (int i = 0; i < 8; i++) b[i] = (uint8_t)(v >> (8 * i));
+    s.Write(b, 8);
+}
+
+template <typename Stream, unsigned int BITS>
+void WriteBlob(Stream& s, const BaseBlob<BITS>& blob) {
+    s.Write(blob.data(), blob.size());
+}
+
+// CompactSize 变长整数：< 0xFD 用 1 字节，否则 1 字节标记 + 2/4/8 字节
+inline size_t GetCompactSizeLength(uint64_t n) {
+    if (n < 0xFD) return 1;
+    if (n <= 0xFFFF) return 3;
+    if (n <= 0xFFFFFFFF) return 5;
+    return 9;
+}
+
+template <typename Stream>
+void WriteCompactSize(Stream& s, uint64_t n) {
+    if (n < 0xFD) {
+        WriteU8(s, (uint8_t)n);
+    }
+    else if (n <= 0xFFFF) {
+        uint8_t b[3] = { 0xFD, (uint8_t)n, (uint8_t)(n >> 8) };
+        s.Write(b, 3);
+    }
+    else if (n <= 0xFFFFFFFF) {
+        WriteU8(s, 0xFE);
+        WriteLE32(s, (uint32_t)n);
+    }
+    else {
+        WriteU8(s, 0xFF);
+        WriteLE64(s, n);
+    }
+}
+
+// 长度前缀 (CompactSize) + 数据
+template <typename Stream>
+void WriteVarBytes(Stream& s, const uint8_t* data, size_t len) {
+    WriteCompactSize(s, len);
+    s.Write(data, len);
+}
+
+template <typename Stream>
+void WriteVarBytes(Stream& s, const Bytes& v) {
+    WriteVarBytes(s, v.data(), v.size());
+}
+
+template <typename Stream>
+void WriteVarBytes(Stream& s, const std::string& v) {
+    WriteVarBytes(s, reinterpret_cast<const uint8_t*>(v.data()), v.size());
+}
+
+// --- 输入流 ---
+
+class SpanReader {
+public:
+    SpanReader(const uint8_t* data, size_t size) : p(data), end(data + size) {}
+    explicit SpanReader(ByteView view) : SpanReader(view.data, view.size) {}
+
+    // 取出 len 个字节 (返回指向源缓冲区的指针，不拷贝)
+    const uint8_t* Read(size_t len) {
+        if (static_cast<size_t>(end - p) < len) {
+            throw std::runtime_error("Deserialize: unexpected end of data");
+        }
+        const uint8_t* r = p;
+        p += len;
+        return r;
+    }
+
+    uint8_t ReadU8() { return *Read(1); }
+
+    uint32_t ReadLE32() {
+        const uint8_t* b = Read(4);
+        return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+    }
+
+    uint64_t ReadLE64() {
+        const uint8_t* b = Read(8);
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--) v = (v << 8) | b[i];
+        return v;
+    }
+
+    uint256 ReadUint256() {
+        uint256 h;
+        memcpy(h.data(), Read(32), 32);
+        return h;
+    }
+
+    uint160 ReadUint160() {
+        uint160 h;
+        memcpy(h.data(), Read(20), 20);
+        return h;
+    }
+
+    // 拒绝非最短编码，保证同一个值只有一种序列化结果 (否则 txid 可以被第三方改变)
+    uint64_t ReadCompactSize() {
+        uint8_t tag = ReadU8();
+        uint64_t n;
+        if (tag < 0xFD) return tag;
+        if (tag == 0xFD) {
+            const uint8_t* b = Read(2);
+            n = b[0] | (b[1] << 8);
+            if (n < 0xFD) throw std::runtime_error("Deserialize: non-canonical CompactSize");
+        }
+        else if (tag == 0xFE) {
+            n = ReadLE32();
+            if (n <= 0xFFFF) throw std::runtime_error("Deserialize: non-canonical CompactSize");
+        }
+        else {
+            n = ReadLE64();
+            if (n <= 0xFFFFFFFF) throw std::runtime_error("Deserialize: non-canonical CompactSize");
+        }
+        return n;
+    }
+
+    // 长度前缀 + 数据，返回指向源缓冲区的视图
+    ByteView ReadVarBytes() {
+        uint64_t len = ReadCompactSize();
+        if (len > MAX_SERIALIZED_SIZE) throw std::runtime_error("Deserialize: field too large");
+        const uint8_t* data = Read(static_cast<size_t>(len));
+        return ByteView(data, static_cast<size_t>(len));
+    }
+
+    const uint8_t* Position() const { return p; }
+    size_t Remaining() const { return end - p; }
+    bool Empty() const { return p == end; }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+#endif //BITCOIN_CORE_SERIALIZE_H
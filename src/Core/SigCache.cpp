@@ -0,0 +1,72 @@
+﻿#include "SigCache.h"
+#include <mutex>
+#include <stdexcept>
+#include <openssl/rand.h>
+
+SigCache::SigCache(size_t maxEntries) : maxEntries(maxEntries == 0 ? 1 : maxEntries) {
+    // 盐正好一个压缩块，写入后 salted 的状态相当于一个 midstate
+    uint8_t salt[64];
+    if (RAND_bytes(salt, sizeof(salt)) != 1) {
+        throw std::runtime_error("OpenSSL: Failed to generate signature cache salt");
+    }
+    salted.Write(salt, sizeof(salt));
+    entries.reserve(this->maxEntries);
+}
+
+uint256 SigCache::ComputeEntry(const uint256& sighash, const Bytes& pubKey, const Bytes& signature) const {
+    Sha256Hasher hasher = salted;
+    // 公钥带长度前缀，保证 (公钥, 签名) 的拆分方式唯一
+    uint8_t pubLen = static_cast<uint8_t>(pubKey.size());
+    hasher.Write(sighash.data(), sighash.size());
+    hasher.Write(&pubLen, 1);
+    hasher.Write(pubKey.data(), pubKey.size());
+    hasher.Write(signature.data(), signature.size());
+
+    uint256 entry;
+    hasher.Finalize(entry.data());
+    return entry;
+}
+
+bool SigCache::Contains(const uint256& sighash, const Bytes& pubKey, const Bytes& signature) const {
+    if (pubKey.size() > 0xFF) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint256 entry = ComputeEntry(sighash, pubKey, signature);
+    bool found;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        found = entries.count(entry) != 0;
+    }
+    (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+void SigCache::Insert(const uint256& sighash, const Bytes& pubKey, const Bytes& signature) {
+    if (pubKey.size() > 0xFF) return; // 不是合法公钥，也不可能验证成功
+    uint256 entry = ComputeEntry(sighash, pubKey, signature);
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (!entries.insert(entry).second) return;
+    order.push_back(entry);
+    while (order.size() > maxEntries) {
+        entries.erase(order.front());
+        order.pop_front();
+    }
+}
+
+void SigCache::Clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.clear();
+    order.clear();
+}
+
+size_t SigCache::Size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+SigCache& SigCache::Shared() {
+    static SigCache cache;
+    return cache;
+}
@@ -0,0 +1,47 @@
+﻿#ifndef BITCOIN_CORE_SIGCACHE_H
+#define BITCOIN_CORE_SIGCACHE_H
+
+#include "../Crypto/Hash.h"
+#include "../Crypto/Sha256.h"
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_set>
+
+// 验证成功过的签名 (签名哈希, 公钥, 签名) 的缓存
+// 交易进入内存池时验证一次并记下来，之后出现在区块里就不必再做 ECDSA。
+// 条目以 SHA256(随机盐 || 数据) 为键：盐在进程启动时随机生成，外人无法构造碰撞或针对哈希表的攻击。
+// 容量有上限，满了以后按插入顺序淘汰最老的条目。多线程可以同时查询。
+class SigCache {
+public:
+    explicit SigCache(size_t maxEntries = 1 << 16);
+
+    // 查询，命中/未命中计入计数器
+    bool Contains(const uint256& sighash, const Bytes& pubKey, const Bytes& signature) const;
+
+    // 记下一次验证成功的签名
+    void Insert(const uint256& sighash, const Bytes& pubKey, const Bytes& signature);
+
+    void Clear();
+
+    size_t Size() const;
+    size_t MaxEntries() const { return maxEntries; }
+    uint64_t Hits() const { return hits.load(); }
+    uint64_t Misses() const { return misses.load(); }
+
+    // 进程内共享的缓存 (Blockchain 默认使用)
+    static SigCache& Shared();
+
+private:
+    uint256 ComputeEntry(const uint256& sighash, const Bytes& pubKey, const Bytes& signature) const;
+
+    size_t maxEntries;
+    Sha256Hasher salted;               // 已经写入 64 字节随机盐，每次复制一份再写数据
+    std::unordered_set<uint256> entries;
+    std::deque<uint256> order;         // 插入顺序，用于淘汰
+    mutable std::shared_mutex mutex;
+    mutable std::atomic<uint64_t> hits{0};
+    mutable std::atomic<uint64_t> misses{0};
+};
+
+#endif //BITCOIN_CORE_SIGCACHE_H
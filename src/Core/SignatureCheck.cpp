@@ -0,0 +1,77 @@
+﻿#include "SignatureCheck.h"
+#include "SigCache.h"
+#include "Transaction.h"
+#include "../Utils/ThreadPool.h"
+#include "../Wallet/Wallet.h"
+#include <algorithm>
+
+bool SignatureCheck::Verify() const {
+    if (cache && cache->Contains(hash, *publicKey, *signature)) return true;
+    if (!Wallet::Verify(*publicKey, hash, *signature)) return false;
+    if (cache && store) cache->Insert(hash, *publicKey, *signature);
+    return true;
+}
+
+bool CheckTransactionSignatures(const Transaction& tx, SigCache* cache) {
+    if (tx.IsCoinBase()) return true;
+    uint256 sighash = tx.GetSignatureHash();
+    for (const auto& in : tx.inputs) {
+        SignatureCheck check;
+        check.publicKey = &in.publicKey;
+        check.signature = &in.signature;
+        check.hash = sighash;
+        check.cache = cache;
+        check.store = true;
+        if (!check.Verify()) return false;
+    }
+    return true;
+}
+
+void SignatureCheckQueue::State::Run() {
+    // 一次只领一个：单个 ECDSA 验证远比一次原子加法贵，领得越细负载越均衡、失败后停得越快
+    while (!stop.load(std::memory_order_relaxed)) {
+        size_t i = next.fetch_add(1);
+        if (i >= checks.size()) return;
+        if (!checks[i].Verify()) {
+            // 多个线程同时失败时只记录第一个
+            if (!failed.exchange(true)) failedTx = checks[i].txIndex;
+            stop = true;
+        }
+    }
+}
+
+SignatureCheckQueue::SignatureCheckQueue(ThreadPool* pool, std::vector<SignatureCheck> checks)
+    : state(std::make_shared<State>()) {
+    state->checks = std::move(checks);
+    if (!pool || state->checks.size() < 2) return;
+
+    // 调用线程在 Wait() 里也会参与，所以最多再找 n - 1 个帮手
+    size_t count = std::min(pool->Size(), state->checks.size() - 1);
+    for (size_t i = 0; i < count; i++) {
+        auto s = state;
+        helpers.push_back(pool->Submit([s]() { s->Run(); }));
+    }
+}
+
+SignatureCheckQueue::~SignatureCheckQueue() {
+    if (!finished) {
+        Cancel();
+        Wait();
+    }
+}
+
+bool SignatureCheckQueue::Wait() {
+    state->Run();
+    for (auto& f : helpers) f.wait();
+    helpers.clear();
+    finished = true;
+    return !state->failed.load();
+}
+
+void SignatureCheckQueue::Cancel() {
+    state->stop = true;
+}
+
+size_t SignatureCheckQueue::FailedTx() const {
+    return state->failedTx.load();
+}
@@ -0,0 +1,70 @@
+﻿#ifndef BITCOIN_CORE_SIGNATURECHECK_H
+#define BITCOIN_CORE_SIGNATURECHECK_H
+
+#include "../Crypto/Hash.h"
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <vector>
+
+class SigCache;
+class ThreadPool;
+class Transaction;
+
+// 一个输入的签名检查：(公钥, 签名哈希, 签名)
+// 公钥和签名只保存指针，指向的区块数据在检查结束前必须一直有效
+struct SignatureCheck {
+    const Bytes* publicKey = nullptr;
+    const Bytes* signature = nullptr;
+    uint256 hash;
+    size_t txIndex = 0;   // 所在交易在区块中的位置 (报错用)
+    SigCache* cache = nullptr;  // 非空时先查缓存，命中就跳过 ECDSA
+    bool store = false;         // 验证成功后是否写入缓存
+
+    bool Verify() const;
+};
+
+// 验证一笔交易所有输入的签名 (串行)，成功的签名写入 cache (可以为 nullptr)
+// 供交易进入内存池时使用；之后同一笔交易出现在区块里时，AddBlock 直接命中缓存
+bool CheckTransactionSignatures(const Transaction& tx, SigCache* cache);
+
+// 并行验证一批签名
+// 构造时就把检查分发到线程池，调用线程可以先去做别的 (不依赖签名的) 检查，最后调用 Wait() 取结果。
+// 任意一个签名失败后，还没开始的检查全部跳过 (fail fast)。
+// pool 为 nullptr 时所有检查都在 Wait() 里由调用线程完成。
+class SignatureCheckQueue {
+public:
+    SignatureCheckQueue(ThreadPool* pool, std::vector<SignatureCheck> checks);
+    // 析构时取消剩下的检查并等待已经开始的检查结束
+    ~SignatureCheckQueue();
+
+    SignatureCheckQueue(const SignatureCheckQueue&) = delete;
+    SignatureCheckQueue& operator=(const SignatureCheckQueue&) = delete;
+
+    // 调用线程也参与验证，全部完成 (或失败) 后返回；true = 所有签名有效
+    bool Wait();
+
+    // 放弃剩下的检查 (例如区块已经因为别的原因被拒绝)
+    void Cancel();
+
+    // 第一个被发现无效的签名所在的交易位置 (Wait() 返回 false 后有效)
+    size_t FailedTx() const;
+
+private:
+    struct State {
+        std::vector<SignatureCheck> checks;
+        std::atomic<size_t> next{0};
+        std::atomic<bool> stop{false};
+        std::atomic<bool> failed{false};
+        std::atomic<size_t> failedTx{0};
+
+        void Run();
+    };
+
+    std::shared_ptr<State> state;
+    std::vector<std::future<void>> helpers;
+    bool finished = false;
+};
+
+#endif //BITCOIN_CORE_SIGNATURECHECK_H
@@ -1,41 +1,82 @@
 ﻿#include "Transaction.h"
-#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include "../Wallet/Wallet.h"
 
-// 辅助工具：写入整数
-void PushUInt32(Bytes& data, uint32_t v) {
-    data.push_back(v & 0xFF); data.push_back((v >> 8) & 0xFF);
-    data.push_back((v >> 16) & 0xFF); data.push_back((v >> 24) & 0xFF);
+TxOut::TxOut(int64_t value, const std::string& address) : value(value) {
+    if (!Wallet::PubKeyHashFromAddress(address, pubKeyHash)) {
+        throw std::runtime_error("Invalid address: " + address);
+    }
 }
-void PushInt64(Bytes& data, int64_t v) {
-    for (int i = 0; i < 8; i++) data.push_back((v >> (i * 8)) & 0xFF);
+
+std::string TxOut::GetAddress() const {
+    return Wallet::AddressFromPubKeyHash(pubKeyHash);
 }
 
 Bytes Transaction::Serialize() const {
-    Bytes data;
-    // 简化的序列化格式:
-    // [InCount] [In1] [In2]... [OutCount] [Out1] [Out2]...
-
-    // 1. Inputs
-    PushUInt32(data, inputs.size());
-    for (const auto& in : inputs) {
-        data.insert(data.end(), in.prevTxId.begin(), in.prevTxId.end());
-        PushUInt32(data, in.prevIndex);
-        // 注意：计算交易ID时，签名部分通常需要特殊处理(置空)，这里为了演示最简逻辑，暂包含进去
-        // 在正式比特币中，TxID 的计算不包含 Witness 数据，但包含 ScriptSig
-    }
+    Bytes data(GetSerializeSize());
+    SpanWriter writer(data.data(), data.size());
+    SerializeTransaction(writer, *this);
+    return data;
+}
 
-    // 2. Outputs
-    PushUInt32(data, outputs.size());
-    for (const auto& out : outputs) {
-        PushInt64(data, out.value);
-        // 简单把地址放进去作为 ScriptPubKey
-        Bytes addrBytes = ToBytes(out.address);
-        data.insert(data.end(), addrBytes.begin(), addrBytes.end());
-    }
+size_t Transaction::GetSerializeSize() const {
+    SizeComputer size;
+    SerializeTransaction(size, *this);
+    return size.Size();
+}
 
-    return data;
+uint256 Transaction::GetId() const {
+    return frozen ? cachedId : ComputeId();
+}
+
+uint256 Transaction::GetSignatureHash() const {
+    return frozen ? cachedSignatureHash : ComputeSignatureHash();
+}
+
+uint256 Transaction::ComputeId() const {
+    HashWriter hasher;
+    SerializeTransaction(hasher, *this, true);
+    return hasher.GetHash();
+}
+
+uint256 Transaction::ComputeSignatureHash() const {
+    HashWriter hasher;
+    SerializeTransaction(hasher, *this, false);
+    return hasher.GetHash();
+}
+
+void Transaction::Freeze() {
+    // 已经冻结说明字段没变过，缓存仍然有效
+    if (frozen) return;
+    cachedId = ComputeId();
+    cachedSignatureHash = ComputeSignatureHash();
+    frozen = true;
+}
+
+Transaction DeserializeTransaction(SpanReader& reader) {
+    Transaction tx;
+    uint64_t inCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < inCount; i++) {
+        TxIn in;
+        in.prevTxId = reader.ReadUint256();
+        in.prevIndex = reader.ReadLE32();
+        in.signature = reader.ReadVarBytes().ToBytes();
+        in.publicKey = reader.ReadVarBytes().ToBytes();
+        tx.inputs.push_back(std::move(in));
+    }
+    uint64_t outCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < outCount; i++) {
+        TxOut out;
+        out.value = static_cast<int64_t>(reader.ReadLE64());
+        out.pubKeyHash = reader.ReadUint160();
+        tx.outputs.push_back(std::move(out));
+    }
+    tx.lockTime = reader.ReadLE32();
+    tx.Freeze();
+    return tx;
 }
 
-Bytes Transaction::GetId() const {
-    return Hash256(Serialize());
+bool Transaction::IsCoinBase() const {
+    return inputs.size() == 1 && inputs[0].prevTxId.IsNull() && inputs[0].prevIndex == 0xFFFFFFFF;
 }
\ No newline at end of file
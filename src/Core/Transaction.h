@@ -5,19 +5,41 @@
 #include <string>
 #include <cstdint>
 #include "../Crypto/Hash.h"
+#include "Serialize.h"
+
+// 金额单位 (对应 v0.1.5 main.h)
+static const int64_t COIN = 100000000;              // 1 BTC = 1 亿 Satoshi
+static const int64_t MAX_MONEY = 21000000 * COIN;    // 总量上限
+
+inline bool MoneyRange(int64_t value) { return value >= 0 && value <= MAX_MONEY; }
 
 // 交易输入: 引用上一笔钱
 struct TxIn {
-    Bytes prevTxId; // 上一笔交易的 Hash (32字节)
+    uint256 prevTxId;     // 上一笔交易的 Hash (32字节)
     uint32_t prevIndex;   // 上一笔交易的第几个输出 (0, 1, ...)
     Bytes signature;      // 解锁脚本(ScriptSig): 这里简化，只存签名
     Bytes publicKey;      // 公钥
 };
 
 // 交易输出: 定义这笔钱给谁
+// 锁定脚本(ScriptPubKey) 简化为 P2PKH：只存收款人公钥的 Hash160 (定长 20 字节，不占堆内存)，
+// Base58 地址只在 API 边界 (构造、显示) 转换，UTXO、序列化和公钥核对都直接用这 20 字节。
 struct TxOut {
-    int64_t value;        // 金额 (单位: Satoshi)
-    std::string address;  // 锁定脚本(ScriptPubKey): 这里简化，直接存对方地址
+    int64_t value = 0;    // 金额 (单位: Satoshi)
+    uint160 pubKeyHash;   // 收款人公钥的 Hash160
+
+    TxOut() {}
+    TxOut(int64_t value, const uint160& pubKeyHash) : value(value), pubKeyHash(pubKeyHash) {}
+
+    // 从 Base58Check 地址构造，地址不合法时抛异常
+    TxOut(int64_t value, const std::string& address);
+    TxOut(int64_t value, const char* address) : TxOut(value, std::string(address)) {}
+
+    // 转回 Base58Check 地址 (显示用)
+    std::string GetAddress() const;
+
+    friend bool operator==(const TxOut& a, const TxOut& b) { return a.value == b.value && a.pubKeyHash == b.pubKeyHash; }
+    friend bool operator!=(const TxOut& a, const TxOut& b) { return !(a == b); }
 };
 
 class Transaction {
@@ -26,11 +48,70 @@ public:
     std::vector<TxOut> outputs;
     uint32_t lockTime = 0;
 
-    // 序列化 (用于传输和计算Hash)
+    // 序列化 (用于传输和计算Hash)：先算出准确长度，一次分配、一次写完
     Bytes Serialize() const;
 
-    // 计算交易 ID (即 Hash256(Serialize))
-    Bytes GetId() const;
+    // 序列化后的字节数
+    size_t GetSerializeSize() const;
+
+    // 计算交易 ID (即 Hash256(Serialize))，包含签名和公钥
+    // 序列化结果直接流进哈希函数，不生成中间的字节数组；冻结后直接返回缓存
+    uint256 GetId() const;
+
+    // 签名哈希：所有输入的签名和公钥置空后的 Hash256
+    // 每个输入都对它签名，所以填入签名不会改变它；冻结后直接返回缓存
+    uint256 GetSignatureHash() const;
+
+    // coinbase 交易：唯一的输入不引用任何已有输出 (prevTxId 全 0，prevIndex = 0xFFFFFFFF)
+    bool IsCoinBase() const;
+
+    // --- 哈希缓存 ---
+    // Freeze() 算好 txid 和签名哈希并缓存，之后可以被多个线程同时读取，不会再哈希第二次。
+    // 冻结的交易不能再修改字段 (缓存不会自动失效)：要修改先 Thaw()，改完再 Freeze()。
+    // 区块里的交易 (Block::AddTransaction) 和反序列化得到的交易都是冻结的，拷贝会连同缓存一起拷贝。
+    void Freeze();
+    void Thaw() { frozen = false; }
+    bool IsFrozen() const { return frozen; }
+
+private:
+    uint256 ComputeId() const;
+    uint256 ComputeSignatureHash() const;
+
+    bool frozen = false;
+    uint256 cachedId;
+    uint256 cachedSignatureHash;
 };
 
+// 序列化格式:
+// [CompactSize 输入数] { [prevTxId 32] [prevIndex 4] [签名 (CompactSize 长度 + 数据)] [公钥 (同上)] } ...
+// [CompactSize 输出数] { [金额 8] [公钥哈希 20] } ...
+// [lockTime 4]
+// withScriptSig = false 时签名和公钥写成空串 (用于计算签名哈希)
+template <typename Stream>
+void SerializeTransaction(Stream& s, const Transaction& tx, bool withScriptSig = true) {
+    WriteCompactSize(s, tx.inputs.size());
+    for (const auto& in : tx.inputs) {
+        WriteBlob(s, in.prevTxId);
+        WriteLE32(s, in.prevIndex);
+        // 和比特币一样，TxID 包含解锁脚本 (签名 + 公钥)；签名哈希则把它们置空
+        if (withScriptSig) {
+            WriteVarBytes(s, in.signature);
+            WriteVarBytes(s, in.publicKey);
+        }
+        else {
+            WriteCompactSize(s, 0);
+            WriteCompactSize(s, 0);
+        }
+    }
+    WriteCompactSize(s, tx.outputs.size());
+    for (const auto& out : tx.outputs) {
+        WriteLE64(s, static_cast<uint64_t>(out.value));
+        WriteBlob(s, out.pubKeyHash);
+    }
+    WriteLE32(s, tx.lockTime);
+}
+
+// 从流中解析一笔交易，格式不对时抛异常
+Transaction DeserializeTransaction(SpanReader& reader);
+
 #endif //BITCOIN_CORE_TRANSACTION_H
\ No newline at end of file
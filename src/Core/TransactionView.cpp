@@ -0,0 +1,131 @@
+﻿#include "TransactionView.h"
+#include "Merkle.h"
+#include <stdexcept>
+
+TransactionView::TransactionView(SpanReader& reader) {
+    Parse(reader);
+}
+
+TransactionView::TransactionView(ByteView source) {
+    SpanReader reader(source);
+    Parse(reader);
+    if (!reader.Empty()) throw std::runtime_error("Deserialize: trailing data after transaction");
+}
+
+void TransactionView::Parse(SpanReader& reader) {
+    const uint8_t* begin = reader.Position();
+
+    // 只跳过各个字段并记下位置，数据本身不拷贝
+    uint64_t inCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < inCount; i++) {
+        inputs.push_back(reader.Position());
+        reader.Read(32 + 4);
+        reader.ReadVarBytes();
+        reader.ReadVarBytes();
+    }
+    outputSection = reader.Position();
+    uint64_t outCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < outCount; i++) {
+        outputs.push_back(reader.Position());
+        reader.Read(8 + 20);
+    }
+    lockTime = reader.ReadLE32();
+
+    data = ByteView(begin, reader.Position() - begin);
+}
+
+TransactionView::Input TransactionView::GetInput(size_t i) const {
+    // 构造时已经检查过格式，这里的读取不会越界
+    SpanReader reader(inputs[i], data.data + data.size - inputs[i]);
+    Input in;
+    in.prevTxId = reader.ReadUint256();
+    in.prevIndex = reader.ReadLE32();
+    in.signature = reader.ReadVarBytes();
+    in.publicKey = reader.ReadVarBytes();
+    return in;
+}
+
+TransactionView::Output TransactionView::GetOutput(size_t i) const {
+    SpanReader reader(outputs[i], data.data + data.size - outputs[i]);
+    Output out;
+    out.value = static_cast<int64_t>(reader.ReadLE64());
+    out.pubKeyHash = reader.ReadUint160();
+    return out;
+}
+
+uint256 TransactionView::GetId() const {
+    return Hash256(data.data, data.size);
+}
+
+uint256 TransactionView::GetSignatureHash() const {
+    // 与 SerializeTransaction(withScriptSig = false) 逐字节相同
+    HashWriter hasher;
+    WriteCompactSize(hasher, inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        hasher.Write(inputs[i], 32 + 4); // prevTxId + prevIndex 原样写入
+        WriteCompactSize(hasher, 0);
+        WriteCompactSize(hasher, 0);
+    }
+    // 输出和 lockTime 在原始数据里是连续的，整段写入
+    hasher.Write(outputSection, data.data + data.size - outputSection);
+    return hasher.GetHash();
+}
+
+bool TransactionView::IsCoinBase() const {
+    if (inputs.size() != 1) return false;
+    Input in = GetInput(0);
+    return in.prevTxId.IsNull() && in.prevIndex == 0xFFFFFFFF;
+}
+
+Transaction TransactionView::ToTransaction() const {
+    SpanReader reader(data);
+    return DeserializeTransaction(reader);
+}
+
+BlockView::BlockView(ByteView source) : data(source) {
+    SpanReader reader(source);
+    reader.Read(Block::HEADER_SIZE);
+    uint64_t txCount = reader.ReadCompactSize();
+    for (uint64_t i = 0; i < txCount; i++) {
+        transactions.emplace_back(reader);
+    }
+    if (!reader.Empty()) throw std::runtime_error("Deserialize: trailing data after block");
+}
+
+int32_t BlockView::Version() const {
+    return static_cast<int32_t>(SpanReader(data.data, 4).ReadLE32());
+}
+
+uint256 BlockView::PrevBlockHash() const {
+    return SpanReader(data.data + 4, 32).ReadUint256();
+}
+
+uint256 BlockView::MerkleRoot() const {
+    return SpanReader(data.data + 36, 32).ReadUint256();
+}
+
+uint32_t BlockView::Timestamp() const {
+    return SpanReader(data.data + 68, 4).ReadLE32();
+}
+
+uint32_t BlockView::Bits() const {
+    return SpanReader(data.data + 72, 4).ReadLE32();
+}
+
+uint32_t BlockView::Nonce() const {
+    return SpanReader(data.data + 76, 4).ReadLE32();
+}
+
+uint256 BlockView::GetHash() const {
+    return Hash256(data.data, Block::HEADER_SIZE);
+}
+
+uint256 BlockView::ComputeMerkleRoot() const {
+    MerkleFrontier tree;
+    for (const auto& tx : transactions) tree.Append(tx.GetId());
+    return tree.Root();
+}
+
+Block BlockView::ToBlock() const {
+    return DeserializeBlock(data);
+}
@@ -0,0 +1,92 @@
+﻿#ifndef BITCOIN_CORE_TRANSACTIONVIEW_H
+#define BITCOIN_CORE_TRANSACTIONVIEW_H
+
+#include "Block.h"
+#include "Serialize.h"
+#include <vector>
+
+// 交易的只读视图：字段直接指向源缓冲区 (收到的网络数据、内存映射的区块文件)，不拷贝签名和公钥。
+// 构造时完整检查一遍格式并记下每个输入/输出的位置，之后按下标访问不需要再解析。
+// 源缓冲区必须比视图活得久。
+class TransactionView {
+public:
+    struct Input {
+        uint256 prevTxId;
+        uint32_t prevIndex = 0;
+        ByteView signature;
+        ByteView publicKey;
+    };
+
+    struct Output {
+        int64_t value = 0;
+        uint160 pubKeyHash;
+    };
+
+    // 从 reader 的当前位置解析一笔交易，reader 前进到交易末尾
+    explicit TransactionView(SpanReader& reader);
+
+    // data 必须正好是一笔交易
+    explicit TransactionView(ByteView data);
+
+    size_t InputCount() const { return inputs.size(); }
+    size_t OutputCount() const { return outputs.size(); }
+    Input GetInput(size_t i) const;
+    Output GetOutput(size_t i) const;
+    uint32_t LockTime() const { return lockTime; }
+
+    // 原始序列化字节
+    ByteView Data() const { return data; }
+
+    // 与 Transaction::GetId 相同：直接对原始字节做 Hash256
+    uint256 GetId() const;
+
+    // 与 Transaction::GetSignatureHash 相同
+    uint256 GetSignatureHash() const;
+
+    bool IsCoinBase() const;
+
+    // 需要可修改的对象时再拷贝出来
+    Transaction ToTransaction() const;
+
+private:
+    void Parse(SpanReader& reader);
+
+    ByteView data;
+    std::vector<const uint8_t*> inputs;   // 每个输入在源缓冲区中的起点
+    std::vector<const uint8_t*> outputs;  // 每个输出在源缓冲区中的起点
+    const uint8_t* outputSection = nullptr; // 输出数量字段的起点 (其后直到末尾都是输出和 lockTime)
+    uint32_t lockTime = 0;
+};
+
+// 区块的只读视图，区块头和全部交易都指向源缓冲区
+class BlockView {
+public:
+    // data 必须正好是一个区块 (Block::Serialize 的格式)
+    explicit BlockView(ByteView data);
+
+    const uint8_t* Header() const { return data.data; }
+    int32_t Version() const;
+    uint256 PrevBlockHash() const;
+    uint256 MerkleRoot() const;
+    uint32_t Timestamp() const;
+    uint32_t Bits() const;
+    uint32_t Nonce() const;
+
+    // 对 80 字节区块头做 Hash256，与 Block::GetHash 相同
+    uint256 GetHash() const;
+
+    size_t TransactionCount() const { return transactions.size(); }
+    const TransactionView& GetTransaction(size_t i) const { return transactions[i]; }
+
+    // 按交易的原始字节重新计算默克尔根 (与区块头里的比较即可发现篡改)
+    uint256 ComputeMerkleRoot() const;
+
+    ByteView Data() const { return data; }
+    Block ToBlock() const;
+
+private:
+    ByteView data;
+    std::vector<TransactionView> transactions;
+};
+
+#endif //BITCOIN_CORE_TRANSACTIONVIEW_H
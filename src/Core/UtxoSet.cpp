@@ -0,0 +1,116 @@
+﻿#include "UtxoSet.h"
+#include <cstdint>
+#include <random>
+
+namespace {
+
+const uint8_t CTRL_EMPTY = 0x00;
+const uint8_t CTRL_DELETED = 0x01;
+const uint8_t CTRL_FULL = 0x80; // 最高位为 1 表示占用，低 7 位是哈希指纹
+
+inline uint64_t Mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 超过 size_t 能表示的最大 2 的幂时停在那里 (分配会失败并抛异常)，不会移位溢出成 0 后死循环
+inline size_t RoundUpPow2(size_t n) {
+    const size_t maxCap = ~(SIZE_MAX >> 1);
+    size_t cap = 16;
+    while (cap < n && cap < maxCap) cap <<= 1;
+    return cap;
+}
+
+} // namespace
+
+UtxoSet::UtxoSet(size_t initialCapacity) {
+    std::random_device rd;
+    salt[0] = ((uint64_t)rd() << 32) | rd();
+    salt[1] = ((uint64_t)rd() << 32) | rd();
+    size_t cap = RoundUpPow2(initialCapacity);
+    ctrl.assign(cap, CTRL_EMPTY);
+    slots.resize(cap);
+}
+
+uint64_t UtxoSet::HashOf(const OutPoint& outpoint) const {
+    return Mix64(outpoint.txid.GetUint64(0) ^ salt[0]) ^ Mix64(outpoint.txid.GetUint64(1) + salt[1] + outpoint.index);
+}
+
+size_t UtxoSet::Find(const OutPoint& outpoint, uint64_t hash) const {
+    const size_t mask = ctrl.size() - 1;
+    const uint8_t tag = CTRL_FULL | (uint8_t)(hash >> 57);
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        uint8_t c = ctrl[i];
+        if (c == CTRL_EMPTY) return SIZE_MAX;
+        if (c == tag && slots[i].key == outpoint) return i;
+    }
+}
+
+const Coin* UtxoSet::Get(const OutPoint& outpoint) const {
+    size_t i = Find(outpoint, HashOf(outpoint));
+    return i == SIZE_MAX ? nullptr : &slots[i].coin;
+}
+
+bool UtxoSet::Add(const OutPoint& outpoint, const Coin& coin) {
+    // 装载率 (含墓碑) 超过 7/8 就重建：元素多就扩容，否则原尺寸重建以清理墓碑
+    if ((live + tombstones + 1) * 8 > ctrl.size() * 7) {
+        Rehash(live * 2 + 2 > ctrl.size() ? ctrl.size() * 2 : ctrl.size());
+    }
+
+    uint64_t hash = HashOf(outpoint);
+    if (Find(outpoint, hash) != SIZE_MAX) return false;
+
+    const size_t mask = ctrl.size() - 1;
+    size_t i = hash & mask;
+    while (ctrl[i] & CTRL_FULL) i = (i + 1) & mask;
+    if (ctrl[i] == CTRL_DELETED) tombstones--;
+    ctrl[i] = CTRL_FULL | (uint8_t)(hash >> 57);
+    slots[i].key = outpoint;
+    slots[i].coin = coin;
+    live++;
+    return true;
+}
+
+bool UtxoSet::Spend(const OutPoint& outpoint, Coin* spent) {
+    size_t i = Find(outpoint, HashOf(outpoint));
+    if (i == SIZE_MAX) return false;
+    if (spent) *spent = std::move(slots[i].coin);
+    slots[i].coin = Coin();
+
+    // 下一个槽是空的话，这个槽不在任何探测链中间，可以直接置空而不留墓碑
+    const size_t mask = ctrl.size() - 1;
+    if (ctrl[(i + 1) & mask] == CTRL_EMPTY) {
+        ctrl[i] = CTRL_EMPTY;
+    }
+    else {
+        ctrl[i] = CTRL_DELETED;
+        tombstones++;
+    }
+    live--;
+    return true;
+}
+
+void UtxoSet::Rehash(size_t newCapacity) {
+    std::vector<uint8_t> oldCtrl;
+    std::vector<Slot> oldSlots;
+    oldCtrl.swap(ctrl);
+    oldSlots.swap(slots);
+
+    ctrl.assign(newCapacity, CTRL_EMPTY);
+    slots.resize(newCapacity);
+    tombstones = 0;
+
+    const size_t mask = newCapacity - 1;
+    for (size_t j = 0; j < oldCtrl.size(); j++) {
+        if (!(oldCtrl[j] & CTRL_FULL)) continue;
+        uint64_t hash = HashOf(oldSlots[j].key);
+        size_t i = hash & mask;
+        while (ctrl[i] != CTRL_EMPTY) i = (i + 1) & mask;
+        ctrl[i] = oldCtrl[j];
+        slots[i] = std::move(oldSlots[j]);
+    }
+}
@@ -0,0 +1,82 @@
+﻿#ifndef BITCOIN_CORE_UTXOSET_H
+#define BITCOIN_CORE_UTXOSET_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Transaction.h"
+
+// 交易输出的引用：哪笔交易的第几个输出 (对应 v0.1.5 main.h 中的 COutPoint)
+struct OutPoint {
+    uint256 txid;
+    uint32_t index = 0;
+
+    OutPoint() {}
+    OutPoint(const uint256& id, uint32_t n) : txid(id), index(n) {}
+
+    friend bool operator==(const OutPoint& a, const OutPoint& b) { return a.index == b.index && a.txid == b.txid; }
+    friend bool operator!=(const OutPoint& a, const OutPoint& b) { return !(a == b); }
+};
+
+// 一个未花费的输出
+struct Coin {
+    TxOut out;
+    uint32_t height = 0;    // 所在区块高度
+    bool coinbase = false;  // 是否来自 coinbase 交易
+};
+
+// 区块撤销数据：连接区块时被花掉的币 (按花费顺序记录)
+// 断开区块时按相反顺序放回去，代价与区块大小成正比
+struct BlockUndo {
+    std::vector<std::pair<OutPoint, Coin>> spent;
+};
+
+// 内存中的 UTXO 集合
+// 开放寻址哈希表：控制字节 (1 字节/槽) 与数据槽分开存放，
+// 查找时先在紧凑的控制字节数组里线性探测，只有 7 位指纹匹配时才去读 36 字节的 key，
+// 大部分探测都落在同一条缓存行内。
+class UtxoSet {
+public:
+    explicit UtxoSet(size_t initialCapacity = 1024);
+
+    // 查找，不存在返回 nullptr (指针在下一次修改前有效)
+    const Coin* Get(const OutPoint& outpoint) const;
+
+    bool Contains(const OutPoint& outpoint) const { return Get(outpoint) != nullptr; }
+
+    // 加入一个新输出，已存在则返回 false
+    bool Add(const OutPoint& outpoint, const Coin& coin);
+
+    // 花掉一个输出，被花掉的币写入 spent (可为 nullptr)；不存在返回 false
+    bool Spend(const OutPoint& outpoint, Coin* spent = nullptr);
+
+    // 遍历全部未花费输出 (顺序不固定)，保存快照时使用
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (size_t i = 0; i < ctrl.size(); i++) {
+            if (ctrl[i] & 0x80) f(slots[i].key, slots[i].coin);
+        }
+    }
+
+    size_t Size() const { return live; }
+    size_t Capacity() const { return ctrl.size(); }
+
+private:
+    struct Slot {
+        OutPoint key;
+        Coin coin;
+    };
+
+    uint64_t HashOf(const OutPoint& outpoint) const;
+    // 找到 key 所在的槽位，不存在返回 SIZE_MAX
+    size_t Find(const OutPoint& outpoint, uint64_t hash) const;
+    void Rehash(size_t newCapacity);
+
+    std::vector<uint8_t> ctrl;  // 每个槽的状态：EMPTY / DELETED / 0x80 | 7 位指纹
+    std::vector<Slot> slots;
+    size_t live = 0;            // 有效元素数
+    size_t tombstones = 0;      // 已删除但还占着探测链的槽
+    uint64_t salt[2];           // 随机盐，防止有人刻意构造碰撞的 txid 拖慢查找
+};
+
+#endif //BITCOIN_CORE_UTXOSET_H
@@ -0,0 +1,185 @@
+﻿#include "WorkUnit.h"
+#include "Blockchain.h"
+#include "Mempool.h"
+#include "../Utils/Metrics.h"
+#include <stdexcept>
+
+static MetricCounter& workIssued = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_work_units_issued_total", "Work units handed out by WorkManager::GetWork");
+static MetricCounter& workTemplates = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_work_templates_total", "Block templates built for work units");
+static MetricCounter& solutionsAccepted = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_work_solutions_total", "Solutions submitted to WorkManager::SubmitWork", "result=\"accepted\"");
+static MetricCounter& solutionsStale = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_work_solutions_total", "", "result=\"stale\"");
+static MetricCounter& solutionsInvalid = MetricsRegistry::Shared().GetCounter(
+    "mybitcoin_work_solutions_total", "", "result=\"invalid\"");
+
+// coinbase 序列化中 extranonce 的位置：输入个数 + prevTxId + prevIndex + 脚本长度 + 4 字节高度
+static const size_t COINBASE_EXTRANONCE_OFFSET = 1 + 32 + 4 + 1 + 4;
+
+uint256 WorkUnit::CoinbaseId(uint64_t extraNonce) const {
+    HashWriter hasher;
+    hasher.Write(coinbasePrefix.data(), coinbasePrefix.size());
+    WriteLE64(hasher, extraNonce);
+    hasher.Write(coinbaseSuffix.data(), coinbaseSuffix.size());
+    return hasher.GetHash();
+}
+
+uint256 WorkUnit::MerkleRoot(uint64_t extraNonce) const {
+    return ComputeMerkleRootFromBranch(CoinbaseId(extraNonce), merkleBranch, 0);
+}
+
+Block WorkUnit::Header(uint64_t extraNonce) const {
+    return Block(version, prevBlockHash, MerkleRoot(extraNonce), timestamp, bits);
+}
+
+bool MineWorkUnit(const WorkUnit& work, WorkSolution& solution, unsigned threads, const std::atomic<bool>* stop) {
+    for (uint64_t extraNonce = work.extraNonceBegin; extraNonce < work.extraNonceEnd; extraNonce++) {
+        if (stop && stop->load()) return false;
+        Block header = work.Header(extraNonce);
+        MiningStats stats;
+        if (!header.TryMine(stats, threads, stop)) continue;
+        solution.workId = work.workId;
+        solution.extraNonce = extraNonce;
+        solution.nonce = header.nonce;
+        solution.time = header.timestamp;
+        return true;
+    }
+    return false;
+}
+
+WorkManager::WorkManager(Mempool& pool, const Blockchain& chain, const uint160& payoutPubKeyHash,
+                         uint64_t extraNonceRange)
+    : pool(pool), chain(chain), payout(payoutPubKeyHash), extraNonceRange(extraNonceRange) {
+    if (extraNonceRange == 0) throw std::invalid_argument("WorkManager: empty extranonce range");
+}
+
+void WorkManager::NewTemplate(uint32_t timestamp) {
+    // 内存池的模板是增量维护的，这里只拷贝一份，再把 coinbase 换成带 extranonce 的版本
+    const Block& blockTemplate = pool.BuildBlockTemplate(payout, timestamp);
+
+    Template t;
+    t.workId = nextWorkId++;
+    t.block = blockTemplate;
+    t.height = chain.GetHeight() + 1;
+    t.coinbaseValue = blockTemplate.transactions[0].outputs[0].value;
+    t.poolSequence = pool.GetSequence();
+    t.merkleBranch = pool.GetTemplateCoinbaseBranch();
+    t.extraNonceBegin = t.extraNonceEnd = nextExtraNonce;
+
+    Transaction coinbase = MakeCoinbase(t.height, payout, t.coinbaseValue, 0);
+    coinbase.Freeze();
+    Bytes data = coinbase.Serialize();
+    if (data.size() < COINBASE_EXTRANONCE_OFFSET + 8 || data[COINBASE_EXTRANONCE_OFFSET - 5] != 4 + 8) {
+        throw std::logic_error("WorkManager: unexpected coinbase layout");
+    }
+    t.coinbasePrefix.assign(data.begin(), data.begin() + COINBASE_EXTRANONCE_OFFSET);
+    t.coinbaseSuffix.assign(data.begin() + COINBASE_EXTRANONCE_OFFSET + 8, data.end());
+    t.block.transactions[0] = std::move(coinbase);
+
+    templates.push_back(std::move(t));
+    if (templates.size() > MAX_TEMPLATES) templates.pop_front();
+    workTemplates.Add();
+}
+
+const WorkManager::Template* WorkManager::FindTemplate(uint64_t workId) const {
+    for (const Template& t : templates) {
+        if (t.workId == workId) return &t;
+    }
+    return nullptr;
+}
+
+WorkUnit WorkManager::GetWork(uint32_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (templates.empty() || templates.back().block.prevBlockHash != chain.GetTip()->hash ||
+        templates.back().poolSequence != pool.GetSequence()) {
+        NewTemplate(timestamp);
+    }
+    Template& t = templates.back();
+    if (nextExtraNonce > UINT64_MAX - extraNonceRange) throw std::runtime_error("WorkManager: extranonce space exhausted");
+
+    WorkUnit work;
+    work.workId = t.workId;
+    work.version = t.block.version;
+    work.prevBlockHash = t.block.prevBlockHash;
+    work.timestamp = timestamp;
+    work.bits = t.block.bits;
+    work.coinbasePrefix = t.coinbasePrefix;
+    work.coinbaseSuffix = t.coinbaseSuffix;
+    work.merkleBranch = t.merkleBranch;
+    work.extraNonceBegin = nextExtraNonce;
+    work.extraNonceEnd = nextExtraNonce + extraNonceRange;
+    nextExtraNonce = work.extraNonceEnd;
+    t.extraNonceEnd = nextExtraNonce;
+    workIssued.Add();
+    return work;
+}
+
+bool WorkManager::SubmitWork(const WorkSolution& solution, Block& block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Template* t = FindTemplate(solution.workId);
+    if (!t || t->block.prevBlockHash != chain.GetTip()->hash) {
+        solutionsStale.Add();
+        return false;
+    }
+    if (solution.extraNonce < t->extraNonceBegin || solution.extraNonce >= t->extraNonceEnd) {
+        solutionsInvalid.Add();
+        return false;
+    }
+
+    // 1. 只重建区块头：coinbase txid + 分支 -> 默克尔根，不碰模板里的其他交易
+    WorkUnit work;
+    work.coinbasePrefix = t->coinbasePrefix;
+    work.coinbaseSuffix = t->coinbaseSuffix;
+    work.merkleBranch = t->merkleBranch;
+    Block header(t->block.version, t->block.prevBlockHash, work.MerkleRoot(solution.extraNonce), solution.time,
+                 t->block.bits);
+    header.nonce = solution.nonce;
+    if (!header.CheckPoW()) {
+        solutionsInvalid.Add();
+        return false;
+    }
+
+    // 2. PoW 合格才组装完整区块
+    block = t->block;
+    block.transactions[0] = MakeCoinbase(t->height, payout, t->coinbaseValue, solution.extraNonce);
+    block.transactions[0].Freeze();
+    block.version = header.version;
+    block.merkleRoot = header.merkleRoot;
+    block.timestamp = header.timestamp;
+    block.nonce = header.nonce;
+    block.Freeze();
+    solutionsAccepted.Add();
+    return true;
+}
+
+WorkUnit DeserializeWorkUnit(ByteView data) {
+    SpanReader reader(data);
+    WorkUnit work;
+    work.workId = reader.ReadLE64();
+    work.version = static_cast<int32_t>(reader.ReadLE32());
+    work.prevBlockHash = reader.ReadUint256();
+    work.timestamp = reader.ReadLE32();
+    work.bits = reader.ReadLE32();
+    work.coinbasePrefix = reader.ReadVarBytes().ToBytes();
+    work.coinbaseSuffix = reader.ReadVarBytes().ToBytes();
+    uint64_t branchSize = reader.ReadCompactSize();
+    if (branchSize > 32) throw std::runtime_error("Deserialize: merkle branch too long");
+    for (uint64_t i = 0; i < branchSize; i++) work.merkleBranch.push_back(reader.ReadUint256());
+    work.extraNonceBegin = reader.ReadLE64();
+    work.extraNonceEnd = reader.ReadLE64();
+    if (!reader.Empty()) throw std::runtime_error("Deserialize: trailing data after work unit");
+    return work;
+}
+
+WorkSolution DeserializeWorkSolution(ByteView data) {
+    if (data.size != WORK_SOLUTION_SIZE) throw std::runtime_error("Deserialize: bad work solution size");
+    SpanReader reader(data);
+    WorkSolution solution;
+    solution.workId = reader.ReadLE64();
+    solution.extraNonce = reader.ReadLE64();
+    solution.nonce = reader.ReadLE32();
+    solution.time = reader.ReadLE32();
+    return solution;
+}
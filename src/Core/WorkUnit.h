@@ -0,0 +1,137 @@
+﻿#ifndef BITCOIN_CORE_WORKUNIT_H
+#define BITCOIN_CORE_WORKUNIT_H
+
+#include "Block.h"
+#include "Serialize.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class Blockchain;
+class Mempool;
+
+// 挖矿工作单元 (类似 Stratum 协议的 mining.notify)
+// 矿工拿到的不是完整区块，而是区块头模板 + coinbase 的序列化前后两段 + coinbase 的默克尔分支，
+// 外加一段只属于它的 extranonce 区间。每个 extranonce 写进 coinbase 后得到不同的默克尔根，
+// 也就是一整个新的 2^32 nonce 空间；不同矿工的区间互不重叠，多个进程同时挖也不会做重复的工作。
+struct WorkUnit {
+    uint64_t workId = 0;
+    int32_t version = 1;
+    uint256 prevBlockHash;
+    uint32_t timestamp = 0;                 // 建议的时间戳 (矿工可以向前滚动)
+    uint32_t bits = 0;
+    Bytes coinbasePrefix;                   // coinbase 序列化 = prefix + extranonce (8 字节小端序) + suffix
+    Bytes coinbaseSuffix;
+    std::vector<uint256> merkleBranch;      // coinbase 到默克尔根路径上的兄弟节点
+    uint64_t extraNonceBegin = 0;           // 分给这个矿工的 extranonce 区间 [begin, end)
+    uint64_t extraNonceEnd = 0;
+
+    // 写入 extraNonce 后的 coinbase txid (直接对前后两段做 Hash256，不构造交易)
+    uint256 CoinbaseId(uint64_t extraNonce) const;
+
+    // 写入 extraNonce 后的默克尔根 (log2(n) 次哈希)
+    uint256 MerkleRoot(uint64_t extraNonce) const;
+
+    // 写入 extraNonce 后待挖的区块头 (交易列表为空，nonce = 0)
+    Block Header(uint64_t extraNonce) const;
+};
+
+// 矿工交回的解
+struct WorkSolution {
+    uint64_t workId = 0;
+    uint64_t extraNonce = 0;
+    uint32_t nonce = 0;
+    uint32_t time = 0;
+};
+
+// 在工作单元上挖矿：从 extraNonceBegin 开始，每个 extranonce 搜索一遍完整的 nonce 空间
+// 找到时填好 solution 返回 true；区间用完或 stop 被置位时返回 false
+bool MineWorkUnit(const WorkUnit& work, WorkSolution& solution, unsigned threads = 1,
+                  const std::atomic<bool>* stop = nullptr);
+
+// 节点这边：从内存池取区块模板，切成工作单元发给矿工，再检查交回的解
+// GetWork 和 SubmitWork 可以从多个线程调用 (内部加锁)；
+// GetWork 需要重建模板时会读内存池和链，这时它们不能同时被修改 (与 Mempool 的要求相同)
+class WorkManager {
+public:
+    // 每份工作默认的 extranonce 个数：每个都对应 2^32 个 nonce，足够一个矿工挖很久
+    static const uint64_t DEFAULT_EXTRANONCE_RANGE = 1ULL << 32;
+    // 最多保留的模板个数，更早模板上的解直接拒绝
+    static const size_t MAX_TEMPLATES = 16;
+
+    WorkManager(Mempool& pool, const Blockchain& chain, const uint160& payoutPubKeyHash,
+                uint64_t extraNonceRange = DEFAULT_EXTRANONCE_RANGE);
+
+    // 发一份新工作：链尾或内存池变化后重建模板，否则复用当前模板，只分配一段新的 extranonce 区间
+    WorkUnit GetWork(uint32_t timestamp);
+
+    // 检查解：只用 coinbase 分支重算默克尔根和 80 字节区块头，PoW 合格后才组装完整区块写进 block。
+    // 工作不存在或已过期 (链尾变了)、extranonce 不是发给这份工作的、PoW 不合格时返回 false。
+    // 返回的区块还要由调用方交给 Blockchain::AddBlock 做完整验证
+    bool SubmitWork(const WorkSolution& solution, Block& block);
+
+private:
+    struct Template {
+        uint64_t workId = 0;
+        Block block;                        // transactions[0] 是 extranonce = 0 的 coinbase
+        uint32_t height = 0;
+        int64_t coinbaseValue = 0;
+        uint64_t poolSequence = 0;
+        Bytes coinbasePrefix;
+        Bytes coinbaseSuffix;
+        std::vector<uint256> merkleBranch;
+        uint64_t extraNonceBegin = 0;       // 这个模板发出去的全部 extranonce [begin, end)
+        uint64_t extraNonceEnd = 0;
+
+        Template() : block(0, uint256(), uint256(), 0, 0) {}
+    };
+
+    void NewTemplate(uint32_t timestamp);
+    const Template* FindTemplate(uint64_t workId) const;
+
+    Mempool& pool;
+    const Blockchain& chain;
+    uint160 payout;
+    uint64_t extraNonceRange;
+
+    std::mutex mutex;
+    std::deque<Template> templates;         // 最新的在最后
+    uint64_t nextWorkId = 1;
+    uint64_t nextExtraNonce = 0;            // 所有模板共用，发出去的区间永远不重叠
+};
+
+// --- 序列化 (在进程之间传递工作和解) ---
+
+template <typename Stream>
+void SerializeWorkUnit(Stream& s, const WorkUnit& work) {
+    WriteLE64(s, work.workId);
+    WriteLE32(s, static_cast<uint32_t>(work.version));
+    WriteBlob(s, work.prevBlockHash);
+    WriteLE32(s, work.timestamp);
+    WriteLE32(s, work.bits);
+    WriteVarBytes(s, work.coinbasePrefix);
+    WriteVarBytes(s, work.coinbaseSuffix);
+    WriteCompactSize(s, work.merkleBranch.size());
+    for (const auto& h : work.merkleBranch) WriteBlob(s, h);
+    WriteLE64(s, work.extraNonceBegin);
+    WriteLE64(s, work.extraNonceEnd);
+}
+
+// data 必须正好是一个工作单元，格式不对时抛异常
+WorkUnit DeserializeWorkUnit(ByteView data);
+
+// 解固定 24 字节
+static const size_t WORK_SOLUTION_SIZE = 24;
+
+template <typename Stream>
+void SerializeWorkSolution(Stream& s, const WorkSolution& solution) {
+    WriteLE64(s, solution.workId);
+    WriteLE64(s, solution.extraNonce);
+    WriteLE32(s, solution.nonce);
+    WriteLE32(s, solution.time);
+}
+
+WorkSolution DeserializeWorkSolution(ByteView data);
+
+#endif //BITCOIN_CORE_WORKUNIT_H
@@ -0,0 +1,180 @@
+﻿#include "ArithUint256.h"
+#include "Hash.h"
+#include <stdexcept>
+
+ArithUint256::ArithUint256(uint64_t v) : pn{} {
+    pn[0] = static_cast<uint32_t>(v);
+    pn[1] = static_cast<uint32_t>(v >> 32);
+}
+
+ArithUint256::ArithUint256(const uint256& blob) {
+    const uint8_t* p = blob.data();
+    for (int i = 0; i < WIDTH; i++) {
+        pn[i] = p[4 * i] | (p[4 * i + 1] << 8) | (p[4 * i + 2] << 16) | ((uint32_t)p[4 * i + 3] << 24);
+    }
+}
+
+uint256 ArithUint256::ToUint256() const {
+    uint256 blob;
+    uint8_t* p = blob.data();
+    for (int i = 0; i < WIDTH; i++) {
+        p[4 * i] = static_cast<uint8_t>(pn[i]);
+        p[4 * i + 1] = static_cast<uint8_t>(pn[i] >> 8);
+        p[4 * i + 2] = static_cast<uint8_t>(pn[i] >> 16);
+        p[4 * i + 3] = static_cast<uint8_t>(pn[i] >> 24);
+    }
+    return blob;
+}
+
+unsigned ArithUint256::Bits() const {
+    for (int i = WIDTH - 1; i >= 0; i--) {
+        if (pn[i] == 0) continue;
+        unsigned bits = 32 * i;
+        for (uint32_t w = pn[i]; w; w >>= 1) bits++;
+        return bits;
+    }
+    return 0;
+}
+
+double ArithUint256::GetDouble() const {
+    double result = 0.0;
+    double factor = 1.0;
+    for (int i = 0; i < WIDTH; i++) {
+        result += factor * pn[i];
+        factor *= 4294967296.0;
+    }
+    return result;
+}
+
+std::string ArithUint256::ToString() const {
+    return ToHexReversed(ToUint256());
+}
+
+int ArithUint256::CompareTo(const ArithUint256& b) const {
+    for (int i = WIDTH - 1; i >= 0; i--) {
+        if (pn[i] < b.pn[i]) return -1;
+        if (pn[i] > b.pn[i]) return 1;
+    }
+    return 0;
+}
+
+ArithUint256 ArithUint256::operator~() const {
+    ArithUint256 r;
+    for (int i = 0; i < WIDTH; i++) r.pn[i] = ~pn[i];
+    return r;
+}
+
+ArithUint256& ArithUint256::operator+=(const ArithUint256& b) {
+    uint64_t carry = 0;
+    for (int i = 0; i < WIDTH; i++) {
+        uint64_t n = carry + pn[i] + b.pn[i];
+        pn[i] = static_cast<uint32_t>(n);
+        carry = n >> 32;
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::operator-=(const ArithUint256& b) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < WIDTH; i++) {
+        uint64_t n = (uint64_t)pn[i] - b.pn[i] - borrow;
+        pn[i] = static_cast<uint32_t>(n);
+        borrow = (n >> 32) & 1;
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::operator<<=(unsigned shift) {
+    ArithUint256 a(*this);
+    *this = ArithUint256();
+    int k = shift / 32;
+    shift %= 32;
+    for (int i = 0; i < WIDTH; i++) {
+        if (i + k + 1 < WIDTH && shift != 0) pn[i + k + 1] |= (a.pn[i] >> (32 - shift));
+        if (i + k < WIDTH) pn[i + k] |= (a.pn[i] << shift);
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::operator>>=(unsigned shift) {
+    ArithUint256 a(*this);
+    *this = ArithUint256();
+    int k = shift / 32;
+    shift %= 32;
+    for (int i = 0; i < WIDTH; i++) {
+        if (i - k - 1 >= 0 && shift != 0) pn[i - k - 1] |= (a.pn[i] << (32 - shift));
+        if (i - k >= 0) pn[i - k] |= (a.pn[i] >> shift);
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::operator*=(uint32_t b) {
+    uint64_t carry = 0;
+    for (int i = 0; i < WIDTH; i++) {
+        uint64_t n = carry + (uint64_t)b * pn[i];
+        pn[i] = static_cast<uint32_t>(n);
+        carry = n >> 32;
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::operator/=(const ArithUint256& b) {
+    // 逐位长除法：把除数左移到与被除数最高位对齐，再一位一位往回减
+    ArithUint256 div = b;
+    ArithUint256 num = *this;
+    *this = ArithUint256();
+    unsigned numBits = num.Bits();
+    unsigned divBits = div.Bits();
+    if (divBits == 0) throw std::domain_error("ArithUint256: division by zero");
+    if (divBits > numBits) return *this; // 结果为 0
+    int shift = static_cast<int>(numBits - divBits);
+    div <<= shift;
+    while (shift >= 0) {
+        if (num >= div) {
+            num -= div;
+            pn[shift / 32] |= (1u << (shift & 31));
+        }
+        div >>= 1;
+        shift--;
+    }
+    return *this;
+}
+
+ArithUint256& ArithUint256::SetCompact(uint32_t compact, bool* negative, bool* overflow) {
+    int size = compact >> 24;
+    uint32_t word = compact & 0x007fffff;
+    if (size <= 3) {
+        word >>= 8 * (3 - size);
+        *this = word;
+    }
+    else {
+        *this = word;
+        *this <<= 8 * (size - 3);
+    }
+    if (negative) *negative = word != 0 && (compact & 0x00800000) != 0;
+    if (overflow) {
+        *overflow = word != 0 && ((size > 34) ||
+                                  (word > 0xff && size > 33) ||
+                                  (word > 0xffff && size > 32));
+    }
+    return *this;
+}
+
+uint32_t ArithUint256::GetCompact(bool negative) const {
+    int size = (Bits() + 7) / 8;
+    uint32_t compact;
+    if (size <= 3) {
+        compact = static_cast<uint32_t>(GetLow64() << 8 * (3 - size));
+    }
+    else {
+        compact = static_cast<uint32_t>((*this >> 8 * (size - 3)).GetLow64());
+    }
+    // 尾数的第 24 位是符号位：已经占用时把尾数右移一个字节、指数加一
+    if (compact & 0x00800000) {
+        compact >>= 8;
+        size++;
+    }
+    compact |= size << 24;
+    compact |= (negative && (compact & 0x007fffff) ? 0x00800000 : 0);
+    return compact;
+}
@@ -0,0 +1,72 @@
+﻿#ifndef BITCOIN_CRYPTO_ARITHUINT256_H
+#define BITCOIN_CRYPTO_ARITHUINT256_H
+
+#include <cstdint>
+#include <string>
+#include "Uint256.h"
+
+// 256 位无符号整数 (对应 Bitcoin Core 的 arith_uint256)
+// uint256 只是一串哈希字节；难度目标和累计工作量需要真正的加、减、比较、乘除，用这个类型。
+// 内部是 8 个 32 位字，pn[0] 最低 —— 与 uint256 的小端序字节排列一致，两者可以直接互转。
+// 全部运算都在对象内部完成，不分配内存；溢出时按 2^256 取模 (与无符号整数一样回绕)。
+class ArithUint256 {
+public:
+    static const int WIDTH = 8;
+
+    ArithUint256() : pn{} {}
+    ArithUint256(uint64_t v);
+
+    // 把哈希 (小端序字节) 当作 256 位整数
+    explicit ArithUint256(const uint256& blob);
+    uint256 ToUint256() const;
+
+    // 第 i 个 32 位字 (0 最低)
+    uint32_t Word(int i) const { return pn[i]; }
+    uint64_t GetLow64() const { return pn[0] | (uint64_t)pn[1] << 32; }
+
+    // 最高有效位的位置 + 1 (值为 0 时返回 0)
+    unsigned Bits() const;
+
+    // 近似值 (显示难度、估算哈希次数用)
+    double GetDouble() const;
+
+    // 大端序十六进制 (与区块哈希的显示方式相同)
+    std::string ToString() const;
+
+    int CompareTo(const ArithUint256& b) const;
+    friend bool operator==(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) == 0; }
+    friend bool operator!=(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) != 0; }
+    friend bool operator<(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) < 0; }
+    friend bool operator<=(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) <= 0; }
+    friend bool operator>(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) > 0; }
+    friend bool operator>=(const ArithUint256& a, const ArithUint256& b) { return a.CompareTo(b) >= 0; }
+
+    ArithUint256 operator~() const;
+    ArithUint256& operator+=(const ArithUint256& b);
+    ArithUint256& operator-=(const ArithUint256& b);
+    ArithUint256& operator<<=(unsigned shift);
+    ArithUint256& operator>>=(unsigned shift);
+    ArithUint256& operator*=(uint32_t b);
+    // 除数为 0 时抛异常
+    ArithUint256& operator/=(const ArithUint256& b);
+
+    friend ArithUint256 operator+(ArithUint256 a, const ArithUint256& b) { return a += b; }
+    friend ArithUint256 operator-(ArithUint256 a, const ArithUint256& b) { return a -= b; }
+    friend ArithUint256 operator<<(ArithUint256 a, unsigned shift) { return a <<= shift; }
+    friend ArithUint256 operator>>(ArithUint256 a, unsigned shift) { return a >>= shift; }
+    friend ArithUint256 operator*(ArithUint256 a, uint32_t b) { return a *= b; }
+    friend ArithUint256 operator/(ArithUint256 a, const ArithUint256& b) { return a /= b; }
+
+    // --- compact 格式 (区块头里的 bits) ---
+    // 高 8 位是字节长度 (指数)，低 23 位是尾数，第 24 位是符号：值 = 尾数 * 256^(指数-3)。
+    // 例如 0x1d00ffff = 0xffff * 256^26。
+    // negative: 符号位为 1 且尾数非 0；overflow: 值超出 256 位。两者都可以传空指针。
+    ArithUint256& SetCompact(uint32_t compact, bool* negative = nullptr, bool* overflow = nullptr);
+    // 编码会丢掉尾数 3 字节以外的精度 (与 Bitcoin Core 相同的舍入方式)
+    uint32_t GetCompact(bool negative = false) const;
+
+private:
+    uint32_t pn[WIDTH];
+};
+
+#endif //BITCOIN_CRYPTO_ARITHUINT256_H
@@ -1,47 +1,128 @@
 ﻿#include "Hash.h"
-#include <openssl/sha.h>
-#include <openssl/ripemd.h>
-#include <iomanip>
-#include <sstream>
+#include "Sha256.h"
+#include <openssl/evp.h>
+#include <cstring>
+#include <stdexcept>
 
-// 1. 实现 SHA-256
+// 1. 实现 SHA-256 (Sha256.cpp 中的实现，运行时自动选用 SHA-NI 指令)
 Bytes Sha256(const Bytes& data) {
-    Bytes hash(SHA256_DIGEST_LENGTH); // 32 字节
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, data.data(), data.size());
-    SHA256_Final(hash.data(), &sha256);
+    Bytes hash(Sha256Hasher::OUTPUT_SIZE); // 32 字节
+    Sha256Hasher().Write(data.data(), data.size()).Finalize(hash.data());
     return hash;
 }
 
 // 2. 实现 Hash256 (Double SHA-256)
-Bytes Hash256(const Bytes& data) {
-    return Sha256(Sha256(data));
+uint256 Hash256(const Bytes& data) {
+    return Hash256(data.data(), data.size());
+}
+
+uint256 Hash256(const uint8_t* data, size_t len) {
+    uint256 hash;
+    Sha256D(hash.data(), data, len);
+    return hash;
 }
 
 // 3. 实现 RIPEMD-160
+// 旧的 RIPEMD160_Init/Update/Final 在 OpenSSL 3 中已弃用，改用 EVP 接口；
+// EVP_MD_fetch 要查提供者，开销不小，只取一次
+namespace {
+const EVP_MD* Ripemd160Md() {
+    static EVP_MD* md = EVP_MD_fetch(nullptr, "RIPEMD160", nullptr);
+    if (!md) throw std::runtime_error("RIPEMD160 is not available in OpenSSL");
+    return md;
+}
+
+void Ripemd160(const uint8_t* data, size_t len, uint8_t* out) {
+    unsigned int outLen = 0;
+    if (!EVP_Digest(data, len, out, &outLen, Ripemd160Md(), nullptr) || outLen != 20) {
+        throw std::runtime_error("RIPEMD160 failed");
+    }
+}
+} // namespace
+
 Bytes Ripemd160(const Bytes& data) {
-    Bytes hash(RIPEMD160_DIGEST_LENGTH); // 20 字节
-    RIPEMD160_CTX ripemd;
-    RIPEMD160_Init(&ripemd);
-    RIPEMD160_Update(&ripemd, data.data(), data.size());
-    RIPEMD160_Final(hash.data(), &ripemd);
+    Bytes hash(20); // 20 字节
+    Ripemd160(data.data(), data.size(), hash.data());
     return hash;
 }
 
 // 4. 实现 Hash160 (SHA256 + RIPEMD160)
-Bytes Hash160(const Bytes& data) {
-    return Ripemd160(Sha256(data));
+uint160 Hash160(const Bytes& data) {
+    uint8_t sha[32];
+    Sha256Hasher().Write(data.data(), data.size()).Finalize(sha);
+
+    uint160 hash;
+    Ripemd160(sha, sizeof(sha), hash.data());
+    return hash;
 }
 
 // 5. Hex 工具实现
-std::string ToHex(const Bytes& data) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (uint8_t byte : data) {
-        ss << std::setw(2) << (int)byte;
+// 编码表：每个字节直接查出两个字符；解码表：非 16 进制字符为 -1
+namespace {
+struct HexTables {
+    char encode[256][2];
+    int8_t decode[256];
+
+    HexTables() {
+        const char* digits = "0123456789abcdef";
+        for (int i = 0; i < 256; i++) {
+            encode[i][0] = digits[i >> 4];
+            encode[i][1] = digits[i & 15];
+            decode[i] = -1;
+        }
+        for (int i = 0; i < 10; i++) decode['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 6; i++) {
+            decode['a' + i] = static_cast<int8_t>(10 + i);
+            decode['A' + i] = static_cast<int8_t>(10 + i);
+        }
+    }
+};
+
+const HexTables hexTables;
+} // namespace
+
+void ToHex(const uint8_t* data, size_t len, char* out) {
+    for (size_t i = 0; i < len; i++) {
+        memcpy(out + 2 * i, hexTables.encode[data[i]], 2);
     }
-    return ss.str();
+}
+
+void ToHexReversed(const uint8_t* data, size_t len, char* out) {
+    for (size_t i = 0; i < len; i++) {
+        memcpy(out + 2 * i, hexTables.encode[data[len - 1 - i]], 2);
+    }
+}
+
+std::string ToHex(const uint8_t* data, size_t len) {
+    std::string s(2 * len, '\0');
+    ToHex(data, len, &s[0]);
+    return s;
+}
+
+std::string ToHexReversed(const uint8_t* data, size_t len) {
+    std::string s(2 * len, '\0');
+    ToHexReversed(data, len, &s[0]);
+    return s;
+}
+
+bool FromHex(const char* hex, size_t hexLen, uint8_t* out) {
+    if (hexLen % 2 != 0) return false;
+    for (size_t i = 0; i < hexLen / 2; i++) {
+        int hi = hexTables.decode[static_cast<uint8_t>(hex[2 * i])];
+        int lo = hexTables.decode[static_cast<uint8_t>(hex[2 * i + 1])];
+        if ((hi | lo) < 0) return false;
+        out[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+bool FromHex(const std::string& hex, Bytes& out) {
+    out.resize(hex.size() / 2);
+    return FromHex(hex.data(), hex.size(), out.data());
+}
+
+std::string ToHex(const Bytes& data) {
+    return ToHex(data.data(), data.size());
 }
 
 Bytes ToBytes(const std::string& str) {
@@ -1,9 +1,11 @@
 ﻿#ifndef BITCOIN_CRYPTO_HASH_H
 #define BITCOIN_CRYPTO_HASH_H
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include "Uint256.h"
 
 // 定义字节类型，方便阅读
 using Bytes = std::vector<uint8_t>;
@@ -13,18 +15,56 @@ Bytes Sha256(const Bytes& data);
 
 // 2. 双重 SHA-256 (对应 v0.1.5 util.h 中的 Hash 函数)
 // 用途：工作量证明(PoW)、区块哈希、交易ID
-Bytes Hash256(const Bytes& data);
+// 结果是定长的 uint256，计算过程不分配堆内存
+uint256 Hash256(const Bytes& data);
+uint256 Hash256(const uint8_t* data, size_t len);
 
 // 3. 基础 RIPEMD-160
 Bytes Ripemd160(const Bytes& data);
 
 // 4. Hash160 (先SHA256后RIPEMD160) (对应 v0.1.5 util.h 中的 Hash160 函数)
 // 用途：生成比特币地址
-Bytes Hash160(const Bytes& data);
+uint160 Hash160(const Bytes& data);
 
-// 5. 辅助工具：将字节转为16进制字符串
+// 5. 辅助工具：16 进制编解码 (查表实现，不经过 stringstream)
+// 写入调用方缓冲区的版本不分配内存：out 至少 2 * len 字节，不写结尾的 '\0'
+void ToHex(const uint8_t* data, size_t len, char* out);
+std::string ToHex(const uint8_t* data, size_t len);
 std::string ToHex(const Bytes& data);
 
+template <unsigned int BITS>
+std::string ToHex(const BaseBlob<BITS>& blob) {
+    return ToHex(blob.data(), blob.size());
+}
+
+// 按字节倒序输出：哈希在内存里是小端序，区块浏览器、RPC 习惯把它倒过来显示 (前导零在前面)
+void ToHexReversed(const uint8_t* data, size_t len, char* out);
+std::string ToHexReversed(const uint8_t* data, size_t len);
+
+template <unsigned int BITS>
+std::string ToHexReversed(const BaseBlob<BITS>& blob) {
+    return ToHexReversed(blob.data(), blob.size());
+}
+
+// 解码 hexLen 个字符到 out (hexLen / 2 字节)，大小写均可
+// 长度为奇数或含有非 16 进制字符时返回 false (此时 out 的内容不确定)
+bool FromHex(const char* hex, size_t hexLen, uint8_t* out);
+bool FromHex(const std::string& hex, Bytes& out);
+
+// 解码定长哈希，长度必须正好是 2 * WIDTH
+template <unsigned int BITS>
+bool FromHex(const std::string& hex, BaseBlob<BITS>& blob) {
+    return hex.size() == 2 * blob.size() && FromHex(hex.data(), hex.size(), blob.data());
+}
+
+// ToHexReversed 的逆操作
+template <unsigned int BITS>
+bool FromHexReversed(const std::string& hex, BaseBlob<BITS>& blob) {
+    if (!FromHex(hex, blob)) return false;
+    std::reverse(blob.begin(), blob.end());
+    return true;
+}
+
 // 6. 辅助工具：将字符串转为字节流
 Bytes ToBytes(const std::string& str);
 
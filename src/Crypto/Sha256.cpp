@@ -0,0 +1,386 @@
+﻿#include "Sha256.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHA256_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// 各指令集内核，分别在 Sha256Sse41/Avx2/Avx512/ShaNi.cpp 中用对应编译选项编译
+void Sha256TransformShaNi(uint32_t* s, const uint8_t* chunk, size_t blocks);
+void Sha256D64Sse41(uint8_t* out, const uint8_t* in);
+void Sha256D80Sse41(uint8_t* out, const uint8_t* in);
+void Sha256D80MidstateSse41(uint8_t* out, const uint32_t* midstate, const uint8_t* tails);
+void Sha256D64Avx2(uint8_t* out, const uint8_t* in);
+void Sha256D80Avx2(uint8_t* out, const uint8_t* in);
+void Sha256D80MidstateAvx2(uint8_t* out, const uint32_t* midstate, const uint8_t* tails);
+void Sha256D64Avx512(uint8_t* out, const uint8_t* in);
+void Sha256D80Avx512(uint8_t* out, const uint8_t* in);
+void Sha256D80MidstateAvx512(uint8_t* out, const uint32_t* midstate, const uint8_t* tails);
+#endif
+
+// 参考 FIPS 180-4 的标准实现
+namespace {
+
+inline uint32_t ReadBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+inline void WriteBE32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+inline void WriteBE64(uint8_t* p, uint64_t v) {
+    WriteBE32(p, (uint32_t)(v >> 32));
+    WriteBE32(p + 4, (uint32_t)v);
+}
+
+inline uint32_t Ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+inline uint32_t Ch(uint32_t x, uint32_t y, uint32_t z) { return z ^ (x & (y ^ z)); }
+inline uint32_t Maj(uint32_t x, uint32_t y, uint32_t z) { return (x & y) | (z & (x | y)); }
+inline uint32_t Sigma0(uint32_t x) { return Ror(x, 2) ^ Ror(x, 13) ^ Ror(x, 22); }
+inline uint32_t Sigma1(uint32_t x) { return Ror(x, 6) ^ Ror(x, 11) ^ Ror(x, 25); }
+inline uint32_t sigma0(uint32_t x) { return Ror(x, 7) ^ Ror(x, 18) ^ (x >> 3); }
+inline uint32_t sigma1(uint32_t x) { return Ror(x, 17) ^ Ror(x, 19) ^ (x >> 10); }
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+// 压缩函数 (纯 C++ 版本)：处理 blocks 个 64 字节块
+void TransformScalar(uint32_t* s, const uint8_t* chunk, size_t blocks) {
+    while (blocks--) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) w[i] = ReadBE32(chunk + 4 * i);
+        for (int i = 16; i < 64; i++) w[i] = sigma1(w[i - 2]) + w[i - 7] + sigma0(w[i - 15]) + w[i - 16];
+
+        uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + Sigma1(e) + Ch(e, f, g) + K[i] + w[i];
+            uint32_t t2 = Sigma0(a) + Maj(a, b, c);
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+        s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+        chunk += 64;
+    }
+}
+
+// --- 运行时分派 ---
+typedef void (*TransformFn)(uint32_t*, const uint8_t*, size_t);
+typedef void (*LanesFn)(uint8_t*, const uint8_t*);
+typedef void (*LanesMidstateFn)(uint8_t*, const uint32_t*, const uint8_t*);
+
+struct Backend {
+    std::string name;
+    TransformFn transform = TransformScalar; // 单条消息用的压缩函数
+    size_t lanes = 1;                        // 多路内核的通道数，1 表示没有多路内核
+    LanesFn d64 = nullptr;
+    LanesFn d80 = nullptr;
+    LanesMidstateFn d80Midstate = nullptr;
+};
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+    bool shani = false;
+};
+
+CpuFeatures DetectCpu() {
+    CpuFeatures f;
+#if defined(SHA256_X86)
+    uint32_t a = 0, b = 0, c = 0, d = 0;
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, 0, 0);
+    uint32_t maxLeaf = r[0];
+    __cpuidex(r, 1, 0);
+    c = r[2];
+#else
+    __cpuid_count(0, 0, a, b, c, d);
+    uint32_t maxLeaf = a;
+    __cpuid_count(1, 0, a, b, c, d);
+#endif
+    bool ssse3 = (c >> 9) & 1;
+    f.sse41 = (c >> 19) & 1;
+    bool osxsave = (c >> 27) & 1;
+
+    // 操作系统必须开启了 YMM/ZMM 寄存器的保存，否则 AVX 指令会出错
+    uint64_t xcr0 = 0;
+    if (osxsave) {
+#if defined(_MSC_VER)
+        xcr0 = _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = ((uint64_t)hi << 32) | lo;
+#endif
+    }
+
+    if (maxLeaf >= 7) {
+#if defined(_MSC_VER)
+        __cpuidex(r, 7, 0);
+        b = r[1];
+#else
+        __cpuid_count(7, 0, a, b, c, d);
+#endif
+        f.avx2 = ((b >> 5) & 1) && (xcr0 & 0x6) == 0x6;
+        f.avx512 = ((b >> 16) & 1) && (xcr0 & 0xE6) == 0xE6;
+        f.shani = ((b >> 29) & 1) && ssse3 && f.sse41;
+    }
+#endif
+    return f;
+}
+
+// 本机可用的全部实现，第一个是自动选择的结果 (可能是组合实现)
+std::vector<Backend> BuildBackends() {
+    CpuFeatures cpu = DetectCpu();
+    std::vector<Backend> all;
+
+    Backend scalar;
+    scalar.name = "scalar";
+
+#if defined(SHA256_X86)
+    Backend shani;
+    shani.name = "shani";
+    shani.transform = Sha256TransformShaNi;
+
+    Backend sse41;
+    sse41.name = "sse4.1";
+    sse41.lanes = 4;
+    sse41.d64 = Sha256D64Sse41;
+    sse41.d80 = Sha256D80Sse41;
+    sse41.d80Midstate = Sha256D80MidstateSse41;
+
+    Backend avx2;
+    avx2.name = "avx2";
+    avx2.lanes = 8;
+    avx2.d64 = Sha256D64Avx2;
+    avx2.d80 = Sha256D80Avx2;
+    avx2.d80Midstate = Sha256D80MidstateAvx2;
+
+    Backend avx512;
+    avx512.name = "avx512";
+    avx512.lanes = 16;
+    avx512.d64 = Sha256D64Avx512;
+    avx512.d80 = Sha256D80Avx512;
+    avx512.d80Midstate = Sha256D80MidstateAvx512;
+
+    if (cpu.shani) all.push_back(shani);
+    if (cpu.avx512) all.push_back(avx512);
+    if (cpu.avx2) all.push_back(avx2);
+    if (cpu.sse41) all.push_back(sse41);
+#endif
+    all.push_back(scalar);
+
+    // 自动选择：单条消息用 SHA-NI (有的话)，批量用最宽的多路内核。
+    // 实测批量场景下 SHA-NI 单路比 AVX2 8 路还慢，所以两者组合使用。
+    Backend best = all.front();
+    for (const auto& b : all) {
+        if (b.lanes > 1) {
+            best = b;
+            break;
+        }
+    }
+    if (cpu.shani && best.lanes > 1) {
+#if defined(SHA256_X86)
+        best.transform = Sha256TransformShaNi;
+        best.name = "shani+" + best.name;
+#endif
+    }
+    if (best.name != all.front().name) all.insert(all.begin(), best);
+    return all;
+}
+
+const std::vector<Backend>& Backends() {
+    static const std::vector<Backend> backends = BuildBackends();
+    return backends;
+}
+
+const Backend* g_forced = nullptr; // Sha256UseImplementation 强制指定的实现
+
+const Backend& Active() {
+    return g_forced ? *g_forced : Backends().front();
+}
+
+void Transform(uint32_t* s, const uint8_t* chunk, size_t blocks) {
+    Active().transform(s, chunk, blocks);
+}
+
+// 对 32 字节摘要再做一次 SHA-256 (第二轮，填充是固定的)
+void HashDigest32(uint8_t out[32], const uint8_t digest[32]) {
+    uint8_t chunk[64] = {0};
+    memcpy(chunk, digest, 32);
+    chunk[32] = 0x80;
+    chunk[62] = 0x01; // 长度 256 bit = 0x100
+    uint32_t s[8];
+    memcpy(s, IV, sizeof(s));
+    Transform(s, chunk, 1);
+    for (int i = 0; i < 8; i++) WriteBE32(out + 4 * i, s[i]);
+}
+
+} // namespace
+
+Sha256Hasher::Sha256Hasher() {
+    Reset();
+}
+
+Sha256Hasher& Sha256Hasher::Reset() {
+    memcpy(s, IV, sizeof(s));
+    bytes = 0;
+    return *this;
+}
+
+Sha256Hasher& Sha256Hasher::Write(const uint8_t* data, size_t len) {
+    size_t used = bytes % 64;
+    bytes += len;
+    // 先把缓冲区补满
+    if (used > 0) {
+        size_t take = (len < 64 - used) ? len : 64 - used;
+        memcpy(buf + used, data, take);
+        data += take;
+        len -= take;
+        if (used + take < 64) return *this;
+        Transform(s, buf, 1);
+    }
+    // 整块直接压缩，不经过缓冲区
+    if (len >= 64) {
+        size_t blocks = len / 64;
+        Transform(s, data, blocks);
+        data += blocks * 64;
+        len -= blocks * 64;
+    }
+    if (len > 0) memcpy(buf, data, len);
+    return *this;
+}
+
+void Sha256Hasher::Finalize(uint8_t hash[OUTPUT_SIZE]) {
+    static const uint8_t pad[64] = {0x80};
+    uint8_t sizedesc[8];
+    WriteBE64(sizedesc, bytes << 3);
+    Write(pad, 1 + ((119 - (bytes % 64)) % 64));
+    Write(sizedesc, 8);
+    for (int i = 0; i < 8; i++) WriteBE32(hash + 4 * i, s[i]);
+}
+
+void Sha256D(uint8_t out[32], const uint8_t* data, size_t len) {
+    uint8_t first[32];
+    Sha256Hasher().Write(data, len).Finalize(first);
+    HashDigest32(out, first);
+}
+
+void Sha256Midstate(uint32_t midstate[8], const uint8_t chunk[64]) {
+    memcpy(midstate, IV, sizeof(IV));
+    Transform(midstate, chunk, 1);
+}
+
+void Sha256D80Midstate(uint8_t out[32], const uint32_t midstate[8], const uint8_t tail[16]) {
+    // 第二个压缩块：16 字节尾部 + 填充 + 长度 (80 字节 = 640 bit = 0x280)
+    uint8_t chunk[64] = {0};
+    memcpy(chunk, tail, 16);
+    chunk[16] = 0x80;
+    chunk[62] = 0x02;
+    chunk[63] = 0x80;
+
+    uint32_t s[8];
+    memcpy(s, midstate, sizeof(s));
+    Transform(s, chunk, 1);
+
+    uint8_t first[32];
+    for (int i = 0; i < 8; i++) WriteBE32(first + 4 * i, s[i]);
+    HashDigest32(out, first);
+}
+
+
+void Sha256D64Batch(uint8_t* out, const uint8_t* in, size_t blocks) {
+    const Backend& b = Active();
+    if (b.d64) {
+        for (; blocks >= b.lanes; blocks -= b.lanes) {
+            b.d64(out, in);
+            out += 32 * b.lanes;
+            in += 64 * b.lanes;
+        }
+    }
+    // 剩下不够一批的逐条计算 (Sha256D 先读完输入再写输出，同样支持原地)
+    for (; blocks > 0; blocks--) {
+        Sha256D(out, in, 64);
+        out += 32;
+        in += 64;
+    }
+}
+
+void Sha256D80Batch(uint8_t* out, const uint8_t* in, size_t count) {
+    const Backend& b = Active();
+    if (b.d80) {
+        for (; count >= b.lanes; count -= b.lanes) {
+            b.d80(out, in);
+            out += 32 * b.lanes;
+            in += 80 * b.lanes;
+        }
+    }
+    for (; count > 0; count--) {
+        Sha256D(out, in, 80);
+        out += 32;
+        in += 80;
+    }
+}
+
+void Sha256D80MidstateBatch(uint8_t* out, const uint32_t midstate[8], const uint8_t* tails, size_t count) {
+    const Backend& b = Active();
+    if (b.d80Midstate) {
+        for (; count >= b.lanes; count -= b.lanes) {
+            b.d80Midstate(out, midstate, tails);
+            out += 32 * b.lanes;
+            tails += 16 * b.lanes;
+        }
+    }
+    for (; count > 0; count--) {
+        Sha256D80Midstate(out, midstate, tails);
+        out += 32;
+        tails += 16;
+    }
+}
+
+size_t Sha256BatchLanes() {
+    return Active().lanes;
+}
+
+std::string Sha256Implementation() {
+    return Active().name;
+}
+
+std::vector<std::string> Sha256AvailableImplementations() {
+    std::vector<std::string> names;
+    for (const auto& b : Backends()) names.push_back(b.name);
+    return names;
+}
+
+bool Sha256UseImplementation(const std::string& name) {
+    if (name == "auto") {
+        g_forced = nullptr;
+        return true;
+    }
+    for (const auto& b : Backends()) {
+        if (b.name == name) {
+            g_forced = &b;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+﻿#ifndef BITCOIN_CRYPTO_SHA256_H
+#define BITCOIN_CRYPTO_SHA256_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 不分配堆内存的 SHA-256 实现
+// Hash.h 里的 Sha256() 每次都要返回新的 Bytes，挖矿这种热路径用这里的接口
+
+class Sha256Hasher {
+public:
+    static const size_t OUTPUT_SIZE = 32;
+
+    Sha256Hasher();
+
+    // 追加数据 (可多次调用)
+    Sha256Hasher& Write(const uint8_t* data, size_t len);
+
+    // 输出 32 字节摘要，调用后需要 Reset() 才能复用
+    void Finalize(uint8_t hash[OUTPUT_SIZE]);
+
+    Sha256Hasher& Reset();
+
+private:
+    uint32_t s[8];      // 压缩函数状态
+    uint8_t buf[64];    // 尚未凑满 64 字节的数据
+    uint64_t bytes;     // 已写入的总字节数
+};
+
+// 双重 SHA-256 (结果写入 out，不分配内存)
+void Sha256D(uint8_t out[32], const uint8_t* data, size_t len);
+
+// --- 挖矿专用：midstate 复用 ---
+// 80 字节区块头 = 第一个 64 字节压缩块 (version + prevHash + merkleRoot 前 28 字节)
+//               + 16 字节尾部 (merkleRoot 后 4 字节 + timestamp + bits + nonce)
+// 挖矿时只有尾部在变，所以第一个块的压缩结果 (midstate) 只需算一次。
+
+// 计算前 64 字节的 midstate
+void Sha256Midstate(uint32_t midstate[8], const uint8_t chunk[64]);
+
+// 用 midstate + 16 字节尾部算出整个区块头的 Hash256 (只做 2 次压缩)
+void Sha256D80Midstate(uint8_t out[32], const uint32_t midstate[8], const uint8_t tail[16]);
+
+// --- 批量接口 (多路 SIMD) ---
+// 挖矿、Merkle 逐层归约、txid 计算都是大量互相独立的短消息，
+// 把它们放进 SIMD 寄存器的不同通道里一起算 (SSE4.1 4 路 / AVX2 8 路 / AVX-512 16 路)。
+// 运行时根据 CPUID 自动选择最快的实现，结果与逐条调用 Sha256D 完全一致。
+
+// 对 blocks 条相互独立的 64 字节输入分别做 Hash256 (每条输出 32 字节)
+// out 可以与 in 指向同一块内存 (原地计算，Merkle 逐层归约就是这么用的)
+void Sha256D64Batch(uint8_t* out, const uint8_t* in, size_t blocks);
+
+// 对 count 个 80 字节区块头分别做 Hash256
+void Sha256D80Batch(uint8_t* out, const uint8_t* in, size_t count);
+
+// 挖矿用：count 个区块头共享同一个 midstate，只有 16 字节尾部不同
+void Sha256D80MidstateBatch(uint8_t* out, const uint32_t midstate[8], const uint8_t* tails, size_t count);
+
+// 当前多路内核一次处理的消息条数 (调用方按这个大小凑批，效率最高)
+size_t Sha256BatchLanes();
+
+// 当前使用的实现，例如 "shani" / "avx2" / "scalar"
+std::string Sha256Implementation();
+
+// 本机 CPU 支持的全部实现 (测试和基准用)
+std::vector<std::string> Sha256AvailableImplementations();
+
+// 强制使用某个实现 ("auto" 恢复自动选择)；CPU 不支持时返回 false
+// 注意：不是线程安全的，只应在启动或测试时调用
+bool Sha256UseImplementation(const std::string& name);
+
+#endif //BITCOIN_CRYPTO_SHA256_H
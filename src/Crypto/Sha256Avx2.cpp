@@ -0,0 +1,33 @@
+﻿// AVX2 8 路并行 SHA-256 (需要 -mavx2 编译，运行时由 Sha256.cpp 根据 CPUID 决定是否调用)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <immintrin.h>
+#include "Sha256Lanes.h"
+
+namespace {
+
+struct VecAvx2 {
+    typedef __m256i Type;
+    static const int LANES = 8;
+    static Type Add(Type a, Type b) { return _mm256_add_epi32(a, b); }
+    static Type Xor(Type a, Type b) { return _mm256_xor_si256(a, b); }
+    static Type And(Type a, Type b) { return _mm256_and_si256(a, b); }
+    static Type Or(Type a, Type b) { return _mm256_or_si256(a, b); }
+    template <int N> static Type Shr(Type a) { return _mm256_srli_epi32(a, N); }
+    template <int N> static Type Shl(Type a) { return _mm256_slli_epi32(a, N); }
+    static Type Set1(uint32_t v) { return _mm256_set1_epi32((int)v); }
+    static Type Load(const uint32_t* p) { return _mm256_loadu_si256((const Type*)p); }
+    static void Store(uint32_t* p, Type v) { _mm256_storeu_si256((Type*)p, v); }
+};
+
+typedef Sha256Lanes<VecAvx2> Kernel;
+
+} // namespace
+
+void Sha256D64Avx2(uint8_t* out, const uint8_t* in) { Kernel::D64(out, in); }
+void Sha256D80Avx2(uint8_t* out, const uint8_t* in) { Kernel::D80(out, in); }
+void Sha256D80MidstateAvx2(uint8_t* out, const uint32_t* midstate, const uint8_t* tails) {
+    Kernel::D80Midstate(out, midstate, tails);
+}
+
+#endif
@@ -0,0 +1,33 @@
+﻿// AVX-512 16 路并行 SHA-256 (需要 -mavx512f 编译，运行时由 Sha256.cpp 根据 CPUID 决定是否调用)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <immintrin.h>
+#include "Sha256Lanes.h"
+
+namespace {
+
+struct VecAvx512 {
+    typedef __m512i Type;
+    static const int LANES = 16;
+    static Type Add(Type a, Type b) { return _mm512_add_epi32(a, b); }
+    static Type Xor(Type a, Type b) { return _mm512_xor_si512(a, b); }
+    static Type And(Type a, Type b) { return _mm512_and_si512(a, b); }
+    static Type Or(Type a, Type b) { return _mm512_or_si512(a, b); }
+    template <int N> static Type Shr(Type a) { return _mm512_srli_epi32(a, N); }
+    template <int N> static Type Shl(Type a) { return _mm512_slli_epi32(a, N); }
+    static Type Set1(uint32_t v) { return _mm512_set1_epi32((int)v); }
+    static Type Load(const uint32_t* p) { return _mm512_loadu_si512((const Type*)p); }
+    static void Store(uint32_t* p, Type v) { _mm512_storeu_si512((Type*)p, v); }
+};
+
+typedef Sha256Lanes<VecAvx512> Kernel;
+
+} // namespace
+
+void Sha256D64Avx512(uint8_t* out, const uint8_t* in) { Kernel::D64(out, in); }
+void Sha256D80Avx512(uint8_t* out, const uint8_t* in) { Kernel::D80(out, in); }
+void Sha256D80MidstateAvx512(uint8_t* out, const uint32_t* midstate, const uint8_t* tails) {
+    Kernel::D80Midstate(out, midstate, tails);
+}
+
+#endif
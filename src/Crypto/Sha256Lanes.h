@@ -0,0 +1,141 @@
+﻿#ifndef BITCOIN_CRYPTO_SHA256_LANES_H
+#define BITCOIN_CRYPTO_SHA256_LANES_H
+
+// 多路并行 SHA-256 内核模板 (仅供 Sha256Sse41/Avx2/Avx512.cpp 内部使用)
+// 每个 SIMD 寄存器的一个 32 位通道处理一条独立消息，V 提供向量运算:
+//   Type, LANES, Add, Xor, And, Or, Shr<N>, Shl<N>, Set1, Load, Store
+// 这些 .cpp 用不同的编译选项 (-msse4.1/-mavx2/...) 编译，
+// 所以整个模板放在匿名命名空间里，避免链接器把高指令集版本的内联函数混给其它翻译单元。
+
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+const uint32_t LANE_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+const uint32_t LANE_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+template <typename V>
+struct Sha256Lanes {
+    typedef typename V::Type T;
+    static const int LANES = V::LANES;
+
+    template <int N>
+    static T Ror(T x) { return V::Or(V::template Shr<N>(x), V::template Shl<32 - N>(x)); }
+
+    static T Ch(T x, T y, T z) { return V::Xor(z, V::And(x, V::Xor(y, z))); }
+    static T Maj(T x, T y, T z) { return V::Or(V::And(x, y), V::And(z, V::Or(x, y))); }
+    static T Sigma0(T x) { return V::Xor(V::Xor(Ror<2>(x), Ror<13>(x)), Ror<22>(x)); }
+    static T Sigma1(T x) { return V::Xor(V::Xor(Ror<6>(x), Ror<11>(x)), Ror<25>(x)); }
+    static T sigma0(T x) { return V::Xor(V::Xor(Ror<7>(x), Ror<18>(x)), V::template Shr<3>(x)); }
+    static T sigma1(T x) { return V::Xor(V::Xor(Ror<17>(x), Ror<19>(x)), V::template Shr<10>(x)); }
+
+    // s += 压缩(w)，w 会被就地改写为消息扩展
+    static void Compress(T s[8], T w[16]) {
+        T a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i++) {
+            if (i >= 16) {
+                w[i & 15] = V::Add(V::Add(sigma1(w[(i - 2) & 15]), w[(i - 7) & 15]),
+                                   V::Add(sigma0(w[(i - 15) & 15]), w[i & 15]));
+            }
+            T t1 = V::Add(V::Add(h, Sigma1(e)), V::Add(Ch(e, f, g), V::Add(V::Set1(LANE_K[i]), w[i & 15])));
+            T t2 = V::Add(Sigma0(a), Maj(a, b, c));
+            h = g; g = f; f = e; e = V::Add(d, t1);
+            d = c; c = b; b = a; a = V::Add(t1, t2);
+        }
+        s[0] = V::Add(s[0], a); s[1] = V::Add(s[1], b); s[2] = V::Add(s[2], c); s[3] = V::Add(s[3], d);
+        s[4] = V::Add(s[4], e); s[5] = V::Add(s[5], f); s[6] = V::Add(s[6], g); s[7] = V::Add(s[7], h);
+    }
+
+    static uint32_t ReadBE32(const uint8_t* p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+
+    // 把 LANES 条消息的第 0..count-1 个大端字转置进寄存器 (消息间隔 stride 字节)
+    static void LoadWords(T* w, const uint8_t* base, size_t stride, int count) {
+        for (int i = 0; i < count; i++) {
+            uint32_t tmp[LANES];
+            for (int l = 0; l < LANES; l++) tmp[l] = ReadBE32(base + l * stride + 4 * i);
+            w[i] = V::Load(tmp);
+        }
+    }
+
+    static void Broadcast(T s[8], const uint32_t init[8]) {
+        for (int i = 0; i < 8; i++) s[i] = V::Set1(init[i]);
+    }
+
+    // 第一轮结果 s (32 字节) 再做一次 SHA-256，结果按通道写回 out (每条 32 字节)
+    static void SecondHashAndStore(uint8_t* out, T s[8]) {
+        T w[16];
+        for (int i = 0; i < 8; i++) w[i] = s[i];
+        w[8] = V::Set1(0x80000000);
+        for (int i = 9; i < 15; i++) w[i] = V::Set1(0);
+        w[15] = V::Set1(0x100); // 256 bit
+        T r[8];
+        Broadcast(r, LANE_IV);
+        Compress(r, w);
+        for (int i = 0; i < 8; i++) {
+            uint32_t tmp[LANES];
+            V::Store(tmp, r[i]);
+            for (int l = 0; l < LANES; l++) {
+                uint8_t* p = out + 32 * l + 4 * i;
+                p[0] = tmp[l] >> 24; p[1] = tmp[l] >> 16; p[2] = tmp[l] >> 8; p[3] = tmp[l];
+            }
+        }
+    }
+
+    // LANES 条 64 字节消息的 Hash256；先全部读入再写出，所以 out 可以与 in 重叠
+    static void D64(uint8_t* out, const uint8_t* in) {
+        T s[8], w[16];
+        Broadcast(s, LANE_IV);
+        LoadWords(w, in, 64, 16);
+        Compress(s, w);
+        w[0] = V::Set1(0x80000000);
+        for (int i = 1; i < 15; i++) w[i] = V::Set1(0);
+        w[15] = V::Set1(0x200); // 512 bit
+        Compress(s, w);
+        SecondHashAndStore(out, s);
+    }
+
+    // LANES 条 80 字节消息 (区块头) 的 Hash256
+    static void D80(uint8_t* out, const uint8_t* in) {
+        T s[8], w[16];
+        Broadcast(s, LANE_IV);
+        LoadWords(w, in, 80, 16);
+        Compress(s, w);
+        LoadWords(w, in + 64, 80, 4);
+        w[4] = V::Set1(0x80000000);
+        for (int i = 5; i < 15; i++) w[i] = V::Set1(0);
+        w[15] = V::Set1(0x280); // 640 bit
+        Compress(s, w);
+        SecondHashAndStore(out, s);
+    }
+
+    // 共享同一个 midstate，LANES 个不同的 16 字节尾部 (挖矿时只有 nonce 不同)
+    static void D80Midstate(uint8_t* out, const uint32_t midstate[8], const uint8_t* tails) {
+        T s[8], w[16];
+        Broadcast(s, midstate);
+        LoadWords(w, tails, 16, 4);
+        w[4] = V::Set1(0x80000000);
+        for (int i = 5; i < 15; i++) w[i] = V::Set1(0);
+        w[15] = V::Set1(0x280);
+        Compress(s, w);
+        SecondHashAndStore(out, s);
+    }
+};
+
+} // namespace
+
+#endif //BITCOIN_CRYPTO_SHA256_LANES_H
@@ -0,0 +1,33 @@
+﻿// SSE4.1 4 路并行 SHA-256 (需要 -msse4.1 编译，运行时由 Sha256.cpp 根据 CPUID 决定是否调用)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <immintrin.h>
+#include "Sha256Lanes.h"
+
+namespace {
+
+struct VecSse41 {
+    typedef __m128i Type;
+    static const int LANES = 4;
+    static Type Add(Type a, Type b) { return _mm_add_epi32(a, b); }
+    static Type Xor(Type a, Type b) { return _mm_xor_si128(a, b); }
+    static Type And(Type a, Type b) { return _mm_and_si128(a, b); }
+    static Type Or(Type a, Type b) { return _mm_or_si128(a, b); }
+    template <int N> static Type Shr(Type a) { return _mm_srli_epi32(a, N); }
+    template <int N> static Type Shl(Type a) { return _mm_slli_epi32(a, N); }
+    static Type Set1(uint32_t v) { return _mm_set1_epi32((int)v); }
+    static Type Load(const uint32_t* p) { return _mm_loadu_si128((const Type*)p); }
+    static void Store(uint32_t* p, Type v) { _mm_storeu_si128((Type*)p, v); }
+};
+
+typedef Sha256Lanes<VecSse41> Kernel;
+
+} // namespace
+
+void Sha256D64Sse41(uint8_t* out, const uint8_t* in) { Kernel::D64(out, in); }
+void Sha256D80Sse41(uint8_t* out, const uint8_t* in) { Kernel::D80(out, in); }
+void Sha256D80MidstateSse41(uint8_t* out, const uint32_t* midstate, const uint8_t* tails) {
+    Kernel::D80Midstate(out, midstate, tails);
+}
+
+#endif
@@ -0,0 +1,101 @@
+﻿#ifndef BITCOIN_CRYPTO_UINT256_H
+#define BITCOIN_CRYPTO_UINT256_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+// 定长哈希值类型 (对应 v0.1.5 uint256.h 中的 base_uint)
+// 直接把字节存放在对象内部：没有堆分配，可以平凡拷贝，比较就是一次 memcmp。
+// 字节顺序与 Hash256() 的输出一致 (小端序，展示给人看时通常反转)。
+template <unsigned int BITS>
+class BaseBlob {
+public:
+    static constexpr size_t WIDTH = BITS / 8;
+
+protected:
+    std::array<uint8_t, WIDTH> m_data;
+
+public:
+    // 默认全 0
+    constexpr BaseBlob() : m_data{} {}
+
+    constexpr explicit BaseBlob(const std::array<uint8_t, WIDTH>& bytes) : m_data(bytes) {}
+
+    // 从字节流构造，长度不对直接抛异常
+    explicit BaseBlob(const std::vector<uint8_t>& bytes) {
+        if (bytes.size() != WIDTH) {
+            throw std::invalid_argument("BaseBlob: wrong byte length");
+        }
+        memcpy(m_data.data(), bytes.data(), WIDTH);
+    }
+
+    bool IsNull() const {
+        for (uint8_t b : m_data) {
+            if (b != 0) return false;
+        }
+        return true;
+    }
+
+    void SetNull() { m_data.fill(0); }
+
+    int Compare(const BaseBlob& other) const { return memcmp(m_data.data(), other.m_data.data(), WIDTH); }
+
+    friend bool operator==(const BaseBlob& a, const BaseBlob& b) { return a.Compare(b) == 0; }
+    friend bool operator!=(const BaseBlob& a, const BaseBlob& b) { return a.Compare(b) != 0; }
+    friend bool operator<(const BaseBlob& a, const BaseBlob& b) { return a.Compare(b) < 0; }
+
+    uint8_t* data() { return m_data.data(); }
+    const uint8_t* data() const { return m_data.data(); }
+    static constexpr size_t size() { return WIDTH; }
+
+    uint8_t* begin() { return m_data.data(); }
+    uint8_t* end() { return m_data.data() + WIDTH; }
+    const uint8_t* begin() const { return m_data.data(); }
+    const uint8_t* end() const { return m_data.data() + WIDTH; }
+
+    uint8_t& operator[](size_t i) { return m_data[i]; }
+    const uint8_t& operator[](size_t i) const { return m_data[i]; }
+
+    // 读取第 pos 个 64 位小端整数 (哈希本身已足够随机，可直接当散列值用)
+    uint64_t GetUint64(int pos) const {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--) v = (v << 8) | m_data[pos * 8 + i];
+        return v;
+    }
+
+    std::vector<uint8_t> ToBytes() const { return std::vector<uint8_t>(begin(), end()); }
+};
+
+// 160 位哈希 (Hash160 的结果，用于地址)
+class uint160 : public BaseBlob<160> {
+public:
+    constexpr uint160() {}
+    constexpr explicit uint160(const std::array<uint8_t, WIDTH>& bytes) : BaseBlob<160>(bytes) {}
+    explicit uint160(const std::vector<uint8_t>& bytes) : BaseBlob<160>(bytes) {}
+};
+
+// 256 位哈希 (区块哈希、交易 ID、默克尔根)
+class uint256 : public BaseBlob<256> {
+public:
+    constexpr uint256() {}
+    constexpr explicit uint256(const std::array<uint8_t, WIDTH>& bytes) : BaseBlob<256>(bytes) {}
+    explicit uint256(const std::vector<uint8_t>& bytes) : BaseBlob<256>(bytes) {}
+};
+
+// 让 uint256/uint160 可以直接作为 unordered_map 的 key
+namespace std {
+template <>
+struct hash<uint256> {
+    size_t operator()(const uint256& h) const { return static_cast<size_t>(h.GetUint64(0)); }
+};
+template <>
+struct hash<uint160> {
+    size_t operator()(const uint160& h) const { return static_cast<size_t>(h.GetUint64(0)); }
+};
+} // namespace std
+
+#endif //BITCOIN_CRYPTO_UINT256_H
@@ -0,0 +1,35 @@
+﻿#ifndef BITCOIN_UTILS_MAPPEDFILE_H
+#define BITCOIN_UTILS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读内存映射文件
+// 映射的是打开时文件的长度；文件之后被追加的部分要重新打开一个映射才能看到。
+// 指针在对象析构前一直有效，读取不需要拷贝。
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射整个文件，失败 (文件不存在等) 抛异常；空文件也算成功，Data() 为空
+    void Open(const std::string& path);
+    void Close();
+
+    const uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
+
+#endif //BITCOIN_UTILS_MAPPEDFILE_H
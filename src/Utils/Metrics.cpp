@@ -0,0 +1,272 @@
+﻿#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// 对方提前断开时不要收到 SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+// 套接字导出时一次 send 最多等多久 (秒)
+static const int SEND_TIMEOUT_SECONDS = 1;
+
+const double MetricHistogram::BOUNDS[MetricHistogram::BUCKETS] = {
+    1e-6, 4e-6, 1.6e-5, 6.4e-5, 2.56e-4, 1.024e-3, 4.096e-3, 1.6384e-2, 6.5536e-2, 0.262144, 1.048576, 4.194304,
+};
+
+size_t MetricShardIndex() {
+    // 线程按出现顺序轮流分配分片，同时活跃的线程不超过分片数时互不共享缓存行
+    static std::atomic<size_t> next{0};
+    static thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed) % MetricCounter::SHARDS;
+    return shard;
+}
+
+uint64_t MetricCounter::Value() const {
+    uint64_t sum = 0;
+    for (const Shard& s : shards) sum += s.value.load(std::memory_order_relaxed);
+    return sum;
+}
+
+double MetricGauge::Value() const {
+    uint64_t bits = value.load(std::memory_order_relaxed);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+std::vector<uint64_t> MetricHistogram::BucketCounts() const {
+    std::vector<uint64_t> counts(BUCKETS + 1, 0);
+    for (const Shard& s : shards) {
+        for (size_t b = 0; b <= BUCKETS; b++) counts[b] += s.buckets[b].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+uint64_t MetricHistogram::Count() const {
+    uint64_t n = 0;
+    for (uint64_t c : BucketCounts()) n += c;
+    return n;
+}
+
+double MetricHistogram::Sum() const {
+    uint64_t nanos = 0;
+    for (const Shard& s : shards) nanos += s.sumNanos.load(std::memory_order_relaxed);
+    return nanos / 1e9;
+}
+
+MetricsRegistry& MetricsRegistry::Shared() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::Find(const std::string& name, const std::string& help, const std::string& labels, Type type) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& e : entries) {
+        if (e->name != name || e->labels != labels) continue;
+        if (e->type != type) throw std::runtime_error("Metrics: " + name + " registered with a different type");
+        return *e;
+    }
+    entries.push_back(std::make_unique<Entry>());
+    Entry& e = *entries.back();
+    e.name = name;
+    e.help = help;
+    e.labels = labels;
+    e.type = type;
+    if (type == COUNTER) e.counter = std::make_unique<MetricCounter>();
+    if (type == GAUGE) e.gauge = std::make_unique<MetricGauge>();
+    if (type == HISTOGRAM) e.histogram = std::make_unique<MetricHistogram>();
+    return e;
+}
+
+MetricCounter& MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const std::string& labels) {
+    return *Find(name, help, labels, COUNTER).counter;
+}
+
+MetricGauge& MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return *Find(name, help, labels, GAUGE).gauge;
+}
+
+MetricHistogram& MetricsRegistry::GetHistogram(const std::string& name, const std::string& help, const std::string& labels) {
+    return *Find(name, help, labels, HISTOGRAM).histogram;
+}
+
+// 一行样本：name{labels} value
+static void AppendSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    out += name;
+    if (!labels.empty()) out += "{" + labels + "}";
+    out += " ";
+    out += buf;
+    out += "\n";
+}
+
+static std::string JoinLabels(const std::string& a, const std::string& b) {
+    if (a.empty()) return b;
+    if (b.empty()) return a;
+    return a + "," + b;
+}
+
+std::string MetricsRegistry::Snapshot() const {
+    std::string out;
+#if MYBITCOIN_METRICS
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // 同名的指标排在一起 (注册顺序不一定相邻)
+    std::vector<const Entry*> sorted;
+    for (const auto& e : entries) sorted.push_back(e.get());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+    static const char* TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const Entry& e = *sorted[i];
+        if (i == 0 || sorted[i - 1]->name != e.name) {
+            out += "# HELP " + e.name + " " + e.help + "\n";
+            out += "# TYPE " + e.name + " " + TYPE_NAMES[e.type] + "\n";
+        }
+        if (e.type == COUNTER) {
+            AppendSample(out, e.name, e.labels, static_cast<double>(e.counter->Value()));
+        }
+        else if (e.type == GAUGE) {
+            AppendSample(out, e.name, e.labels, e.gauge->Value());
+        }
+        else {
+            // Prometheus 的桶是累计的
+            std::vector<uint64_t> counts = e.histogram->BucketCounts();
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b <= MetricHistogram::BUCKETS; b++) {
+                cumulative += counts[b];
+                char le[32];
+                if (b < MetricHistogram::BUCKETS) snprintf(le, sizeof(le), "le=\"%g\"", MetricHistogram::BOUNDS[b]);
+                else snprintf(le, sizeof(le), "le=\"+Inf\"");
+                AppendSample(out, e.name + "_bucket", JoinLabels(e.labels, le), static_cast<double>(cumulative));
+            }
+            AppendSample(out, e.name + "_sum", e.labels, e.histogram->Sum());
+            AppendSample(out, e.name + "_count", e.labels, static_cast<double>(cumulative));
+        }
+    }
+#endif
+    return out;
+}
+
+void MetricsRegistry::WriteToFile(const std::string& path) const {
+    std::string snapshot = Snapshot();
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(snapshot.data(), snapshot.size())) {
+            throw std::runtime_error("Metrics: cannot write " + tmp);
+        }
+    }
+    // Windows 上 rename 不能覆盖已有文件
+    std::remove(path.c_str());
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Metrics: cannot rename " + tmp + " to " + path);
+    }
+}
+
+MetricsFileExporter::MetricsFileExporter(const MetricsRegistry& registry, const std::string& path, std::chrono::milliseconds interval)
+    : registry(registry), path(path), interval(interval) {
+    registry.WriteToFile(path); // 路径不可写时在这里就抛异常
+    worker = std::thread([this]() { Loop(); });
+}
+
+MetricsFileExporter::~MetricsFileExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void MetricsFileExporter::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        bool stop = cv.wait_for(lock, interval, [this]() { return stopping; });
+        lock.unlock();
+        try {
+            registry.WriteToFile(path);
+        }
+        catch (const std::exception&) {
+            // 写失败 (磁盘满、目录被删) 不影响节点运行，下一轮再试
+        }
+        lock.lock();
+        if (stop) return;
+    }
+}
+
+#ifdef _WIN32
+
+MetricsSocketServer::MetricsSocketServer(const MetricsRegistry& registry, const std::string& socketPath)
+    : registry(registry), socketPath(socketPath) {
+    throw std::runtime_error("Metrics: Unix socket export is not supported on Windows");
+}
+
+MetricsSocketServer::~MetricsSocketServer() {}
+
+void MetricsSocketServer::Loop() {}
+
+#else
+
+MetricsSocketServer::MetricsSocketServer(const MetricsRegistry& registry, const std::string& socketPath)
+    : registry(registry), socketPath(socketPath) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Metrics: socket path too long: " + socketPath);
+    }
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) throw std::runtime_error("Metrics: cannot create socket");
+    unlink(socketPath.c_str()); // 上次异常退出留下的套接字文件
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenFd, 8) != 0) {
+        close(listenFd);
+        throw std::runtime_error("Metrics: cannot listen on " + socketPath);
+    }
+    worker = std::thread([this]() { Loop(); });
+}
+
+MetricsSocketServer::~MetricsSocketServer() {
+    stopping = true;
+    worker.join();
+    close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+void MetricsSocketServer::Loop() {
+    while (!stopping) {
+        // 用带超时的 poll 等连接，析构时最多等一个超时周期
+        pollfd p = { listenFd, POLLIN, 0 };
+        if (poll(&p, 1, 100) <= 0) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        // 连上却不读的客户端不能把循环 (和析构时的 join) 卡住：发送超时就放弃这个连接
+        timeval timeout = {};
+        timeout.tv_sec = SEND_TIMEOUT_SECONDS;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        std::string snapshot = registry.Snapshot();
+        size_t sent = 0;
+        while (sent < snapshot.size() && !stopping) {
+            ssize_t n = send(fd, snapshot.data() + sent, snapshot.size() - sent, SEND_FLAGS);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        close(fd);
+    }
+}
+
+#endif
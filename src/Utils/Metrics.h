@@ -0,0 +1,216 @@
+﻿#ifndef BITCOIN_UTILS_METRICS_H
+#define BITCOIN_UTILS_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 运行指标 (计数器 / 仪表 / 直方图)，快照为 Prometheus 文本格式
+// 热路径上的写入只是一次 relaxed 原子加：每个指标按线程分成若干片，各占一条缓存行，
+// 不同线程写不同的分片，互不争用；只有读快照时才把分片加起来。
+// 编译开关：MYBITCOIN_METRICS=0 时所有写入都是空的内联函数 (计时器也不读时钟)，快照为空。
+// 指标对象由 MetricsRegistry 持有，地址在进程内不变，通常在 .cpp 里用 static 引用保存。
+
+#ifndef MYBITCOIN_METRICS
+#define MYBITCOIN_METRICS 1
+#endif
+
+// 当前线程使用的分片号 (线程第一次写指标时分配)
+size_t MetricShardIndex();
+
+class MetricCounter {
+public:
+    static const size_t SHARDS = 16;
+
+    void Add(uint64_t n = 1) {
+#if MYBITCOIN_METRICS
+        shards[MetricShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+#else
+        (void)n;
+#endif
+    }
+
+    uint64_t Value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards[SHARDS];
+};
+
+// 仪表：只保存最近一次设置的值 (例如最近一次挖矿的哈希率、链高度)
+class MetricGauge {
+public:
+    void Set(double v) {
+#if MYBITCOIN_METRICS
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        value.store(bits, std::memory_order_relaxed);
+#else
+        (void)v;
+#endif
+    }
+
+    double Value() const;
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// 耗时直方图 (单位：秒)，桶的上界从 1 微秒起每档乘 4，最后一档约 4 秒，再加 +Inf
+class MetricHistogram {
+public:
+    static const size_t BUCKETS = 12;
+    static const double BOUNDS[BUCKETS];
+
+    void Observe(double seconds) {
+#if MYBITCOIN_METRICS
+        size_t b = 0;
+        while (b < BUCKETS && seconds > BOUNDS[b]) b++;
+        Shard& s = shards[MetricShardIndex() % SHARDS];
+        s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+        s.sumNanos.fetch_add(static_cast<uint64_t>(seconds * 1e9), std::memory_order_relaxed);
+#else
+        (void)seconds;
+#endif
+    }
+
+    // 各桶 (非累计) 计数，最后一个是 +Inf
+    std::vector<uint64_t> BucketCounts() const;
+    uint64_t Count() const;
+    double Sum() const;
+
+private:
+    static const size_t SHARDS = 4;   // 直方图比计数器大得多，分片少一些
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[BUCKETS + 1] = {};
+        std::atomic<uint64_t> sumNanos{0};
+    };
+    Shard shards[SHARDS];
+};
+
+// 作用域计时：析构时把经过的时间记入直方图
+class ScopedMetricTimer {
+public:
+#if MYBITCOIN_METRICS
+    explicit ScopedMetricTimer(MetricHistogram& h) : histogram(h), start(std::chrono::steady_clock::now()) {}
+    ~ScopedMetricTimer() { histogram.Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()); }
+
+private:
+    MetricHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+#else
+    explicit ScopedMetricTimer(MetricHistogram&) {}
+#endif
+
+public:
+    ScopedMetricTimer(const ScopedMetricTimer&) = delete;
+    ScopedMetricTimer& operator=(const ScopedMetricTimer&) = delete;
+};
+
+// 顺序阶段计时：每次 Lap 把距上一次 Lap (或构造) 经过的时间记入给定的直方图
+class MetricStopwatch {
+public:
+#if MYBITCOIN_METRICS
+    MetricStopwatch() : last(std::chrono::steady_clock::now()) {}
+    void Lap(MetricHistogram& h) {
+        auto now = std::chrono::steady_clock::now();
+        h.Observe(std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+#else
+    void Lap(MetricHistogram&) {}
+#endif
+};
+
+// 指标注册表
+// 同名不同标签的指标 (例如 stage="pow" / stage="merkle") 在快照里归成一组，HELP/TYPE 只输出一次。
+// 注册和读快照加锁，写指标不加锁。
+class MetricsRegistry {
+public:
+    // 取出 (第一次调用时创建) 指标；labels 形如 stage="pow"，可以为空
+    MetricCounter& GetCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricGauge& GetGauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricHistogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Prometheus 文本格式的快照 (按名字排序)
+    std::string Snapshot() const;
+
+    // 先写临时文件再改名，读的一方不会看到写了一半的文件；失败时抛异常
+    void WriteToFile(const std::string& path) const;
+
+    // 进程内共享的注册表 (代码里埋的指标都在这里)
+    static MetricsRegistry& Shared();
+
+private:
+    enum Type { COUNTER, GAUGE, HISTOGRAM };
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    Entry& Find(const std::string& name, const std::string& help, const std::string& labels, Type type);
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+};
+
+// 后台线程每隔 interval 把快照写到文件 (给 node_exporter 的 textfile 收集器之类的工具读)，析构时再写一次
+class MetricsFileExporter {
+public:
+    MetricsFileExporter(const MetricsRegistry& registry, const std::string& path, std::chrono::milliseconds interval);
+    ~MetricsFileExporter();
+
+    MetricsFileExporter(const MetricsFileExporter&) = delete;
+    MetricsFileExporter& operator=(const MetricsFileExporter&) = delete;
+
+private:
+    void Loop();
+
+    const MetricsRegistry& registry;
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread worker;
+};
+
+// 在本地 Unix 域套接字上提供快照：每个连接写一份快照后关闭 (例如 socat - UNIX-CONNECT:path)
+// 连接逐个处理；对方不读导致发送超时 (1 秒) 时直接关闭连接，不会卡住后面的连接和析构。
+// Windows 上不支持，构造时抛异常。
+class MetricsSocketServer {
+public:
+    MetricsSocketServer(const MetricsRegistry& registry, const std::string& socketPath);
+    ~MetricsSocketServer();
+
+    MetricsSocketServer(const MetricsSocketServer&) = delete;
+    MetricsSocketServer& operator=(const MetricsSocketServer&) = delete;
+
+private:
+    void Loop();
+
+    const MetricsRegistry& registry;
+    std::string socketPath;
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
+
+#endif //BITCOIN_UTILS_METRICS_H
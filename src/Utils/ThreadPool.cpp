@@ -0,0 +1,142 @@
+﻿#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+// 当前线程属于哪个线程池的第几个工作线程 (外部线程为 nullptr)
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local size_t currentIndex = 0;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    // 队列全部建好之后再启动线程，线程会去偷其他队列的任务
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+    size_t target = (currentPool == this) ? currentIndex : nextQueue.fetch_add(1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // pending 在 sleepMutex 下增加，睡眠中的线程不会错过这次唤醒
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending.fetch_add(1);
+    }
+    cv.notify_one();
+}
+
+bool ThreadPool::TryPop(size_t self, std::function<void()>& task) {
+    // 先取自己队列尾部最新的任务
+    {
+        WorkQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    // 再从其他队列头部偷最老的任务
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkQueue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t self) {
+    currentPool = this;
+    currentIndex = self;
+    while (true) {
+        std::function<void()> task;
+        if (TryPop(self, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        cv.wait(lock, [this]() { return stopping || pending.load() > 0; });
+        // 退出前先把队列里剩下的任务做完
+        if (stopping && pending.load() == 0) return;
+    }
+}
+
+void ThreadPool::ParallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (n == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (n + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        fn(0, n);
+        return;
+    }
+
+    // 共享状态放在堆上：来晚的帮手任务可能在本函数返回之后才开始跑
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    // 每个参与者循环领取下一块，直到领完
+    auto run = [state, n, grain, chunks, &fn]() {
+        while (true) {
+            size_t c = state->next.fetch_add(1);
+            if (c >= chunks) return;
+            try {
+                fn(c * grain, std::min(n, (c + 1) * grain));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) state->error = std::current_exception();
+            }
+            if (state->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    // 帮手任务只引用 state 和 fn；fn 在所有块完成前一直有效，
+    // 块全部领完之后帮手不会再碰 fn
+    size_t helpers = std::min(workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        Enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done.load() == chunks; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,67 @@
+﻿#ifndef BITCOIN_UTILS_THREADPOOL_H
+#define BITCOIN_UTILS_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的 work-stealing 线程池
+// 用于 txid 计算、Merkle、签名验证等可以拆成独立小块的批量工作。
+// 每个工作线程有自己的任务队列：池内线程提交的任务放进自己的队列 (后进先出，缓存友好)，
+// 外部线程提交的任务轮流分给各个队列；线程自己的队列空了就从别人队列的另一头偷任务。
+class ThreadPool {
+public:
+    // threads = 0 表示使用全部 CPU 核心
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 工作线程数
+    size_t Size() const { return workers.size(); }
+
+    // 提交一个任务，通过 future 取结果 (任务抛出的异常也会从 future 里抛出)
+    template <typename F>
+    auto Submit(F&& fn) -> std::future<decltype(fn())> {
+        auto task = std::make_shared<std::packaged_task<decltype(fn())()>>(std::forward<F>(fn));
+        auto result = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    // 把 [0, n) 按 grain 大小切块并行执行 fn(begin, end)
+    // 调用线程自己也参与计算，所以在池内任务里嵌套调用也不会死锁。
+    // 所有块完成后才返回；任意一块抛出的第一个异常会在这里重新抛出。
+    void ParallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+    // 进程内共享的线程池 (第一次使用时创建，线程数 = CPU 核心数)
+    static ThreadPool& Shared();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void Enqueue(std::function<void()> task);
+    bool TryPop(size_t self, std::function<void()>& task);
+    void WorkerLoop(size_t self);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;  // 与 workers 一一对应
+    std::atomic<size_t> nextQueue{0};                // 外部提交时轮流选择的队列
+    std::atomic<size_t> pending{0};                  // 已入队、还没被取走的任务数
+    std::mutex sleepMutex;                           // 只用于空闲线程睡眠/唤醒
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+#endif //BITCOIN_UTILS_THREADPOOL_H
@@ -1,57 +1,209 @@
 #include "Base58.h"
+#include "../Crypto/Sha256.h"
+#include "../Utils/ThreadPool.h"
 #include <algorithm>
+#include <array>
+#include <cstring>
 
 // رұ׼ĸ (ȥ 0, O, I, l)
 static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
-std::string EncodeBase58(const Bytes& input) {
+// ַ -> ֵĸ -1
+static const std::array<int8_t, 256> mapBase58 = [] {
+    std::array<int8_t, 256> table;
+    table.fill(-1);
+    for (int i = 0; i < 58; i++) table[(uint8_t)pszBase58[i]] = (int8_t)i;
+    return table;
+}();
+
+// ʱһλ58^5 < 2^30 2^32 ټӽλҲᳬ 64 λ
+static const uint64_t BASE58_LIMB = 656356768ULL; // 58^5
+static const size_t BASE58_LIMB_DIGITS = 5;
+
+// ӿÿ
+static const size_t BASE58_BATCH_GRAIN = 1024;
+
+// ˳ data  suffix ֽ (Base58Check УͲƴӵ»)
+struct ByteSource {
+    const uint8_t* data;
+    size_t len;
+    const uint8_t* suffix;
+    size_t suffixLen;
+
+    size_t Size() const { return len + suffixLen; }
+    uint8_t operator[](size_t i) const { return i < len ? data[i] : suffix[i - len]; }
+};
+
+static std::string EncodeBase58(const ByteSource& input) {
+    size_t size = input.Size();
+
     // 1. ǰ 0 (Base58 ԣǰ 0 Ϊ '1')
-    int zeros = 0;
-    while (zeros < input.size() && input[zeros] == 0) {
+    size_t zeros = 0;
+    while (zeros < size && input[zeros] == 0) {
         zeros++;
     }
 
-    // 2. ֽתΪ (ü򵥵ģЧʵ͵߼)
-    std::vector<unsigned char> b58;
-    Bytes data = input; // һ
+    // 2. ת 58^5 ΪĴ (limbs[0] λ)
+    // n ֽҪ n * log(256) / log(58)  n * 1.366 ַ
+    size_t maxDigits = (size - zeros) * 138 / 100 + 1;
+    std::vector<uint32_t> limbs;
+    limbs.reserve(maxDigits / BASE58_LIMB_DIGITS + 1);
+
+    size_t i = zeros;
+    size_t head = (size - zeros) % 4; // һֻȡղ 4 ֽڵĲ֣֮ÿ 4 ֽ
+    while (i < size) {
+        size_t take = (head != 0) ? head : 4;
+        head = 0;
+        uint64_t carry = 0;
+        for (size_t k = 0; k < take; k++) carry = (carry << 8) | input[i + k];
+        i += take;
 
-    while (data.size() > zeros) { // ֻҪз0
-        int carry = 0;
-        //  byte  /58 һλ Base58 ַ
-        for (size_t i = zeros; i < data.size(); i++) {
-            int current = (carry << 8) + data[i]; // һλ*256 + ǰλ
-            data[i] = current / 58;
-            carry = current % 58;
+        // limbs = limbs * 256^take + carry
+        unsigned shift = static_cast<unsigned>(8 * take);
+        for (auto& limb : limbs) {
+            uint64_t v = (static_cast<uint64_t>(limb) << shift) + carry;
+            limb = static_cast<uint32_t>(v % BASE58_LIMB);
+            carry = v / BASE58_LIMB;
         }
-        // ȥĸλ 0
-        while (data.size() > zeros && data[zeros] == 0) {
-            zeros++;
+        while (carry) {
+            limbs.push_back(static_cast<uint32_t>(carry % BASE58_LIMB));
+            carry /= BASE58_LIMB;
         }
-        b58.push_back(carry);
     }
 
-    // 3. תַ
-    std::string str;
-    // ǰ '1'
-    for (int i = 0; i < input.size() && input[i] == 0; i++) {
-        str += pszBase58[0];
+    // 3. ׼ȷȣһηĩβǰ
+    size_t topDigits = 0;
+    if (!limbs.empty()) {
+        for (uint32_t top = limbs.back(); top; top /= 58) topDigits++;
     }
-    // Ӽַ (עǷ)
-    for (auto it = b58.rbegin(); it != b58.rend(); ++it) {
-        str += pszBase58[*it];
+    size_t digits = limbs.empty() ? 0 : (limbs.size() - 1) * BASE58_LIMB_DIGITS + topDigits;
+
+    std::string str(zeros + digits, pszBase58[0]); // ǰ 0 Ӧ '1' Ѿ
+    size_t pos = str.size();
+    for (size_t l = 0; l < limbs.size(); l++) {
+        uint32_t limb = limbs[l];
+        size_t count = (l + 1 == limbs.size()) ? topDigits : BASE58_LIMB_DIGITS;
+        for (size_t k = 0; k < count; k++) {
+            str[--pos] = pszBase58[limb % 58];
+            limb /= 58;
+        }
     }
     return str;
 }
 
-std::string EncodeBase58Check(const Bytes& data) {
+std::string EncodeBase58(const uint8_t* data, size_t len) {
+    return EncodeBase58(ByteSource{ data, len, nullptr, 0 });
+}
+
+std::string EncodeBase58(const Bytes& input) {
+    return EncodeBase58(input.data(), input.size());
+}
+
+std::string EncodeBase58Check(const uint8_t* data, size_t len) {
     // 1. УͣDouble SHA256 ȡǰ 4 ֽ
-    Bytes hash = Hash256(data);
-    Bytes checksum(hash.begin(), hash.begin() + 4);
+    uint8_t hash[32];
+    Sha256D(hash, data, len);
+
+    // 2. 룺 + У (ֱӽں)
+    return EncodeBase58(ByteSource{ data, len, hash, 4 });
+}
+
+std::string EncodeBase58Check(const Bytes& data) {
+    return EncodeBase58Check(data.data(), data.size());
+}
+
+bool DecodeBase58(const std::string& str, Bytes& out) {
+    out.clear();
 
-    // 2. ƴӣ + У
-    Bytes result = data;
-    result.insert(result.end(), checksum.begin(), checksum.end());
+    // 1. ǰ '1' Ӧǰ 0 ֽ
+    size_t zeros = 0;
+    while (zeros < str.size() && str[zeros] == pszBase58[0]) {
+        zeros++;
+    }
+
+    // 2. ÿγԽ 5 ַ (ֵ < 58^5 < 2^30) 2^32 Ϊ (limbs[0] λ)
+    // n ַҪ n * log(58) / log(256)  n * 0.733 ֽ
+    size_t maxBytes = (str.size() - zeros) * 733 / 1000 + 1;
+    std::vector<uint32_t> limbs;
+    limbs.reserve(maxBytes / 4 + 1);
+
+    size_t i = zeros;
+    size_t head = (str.size() - zeros) % BASE58_LIMB_DIGITS;
+    while (i < str.size()) {
+        size_t take = (head != 0) ? head : BASE58_LIMB_DIGITS;
+        head = 0;
+        uint64_t carry = 0;
+        uint64_t mul = 1;
+        for (size_t k = 0; k < take; k++) {
+            int8_t digit = mapBase58[(uint8_t)str[i + k]];
+            if (digit < 0) return false;
+            carry = carry * 58 + digit;
+            mul *= 58;
+        }
+        i += take;
+
+        // limbs = limbs * 58^take + carry
+        for (auto& limb : limbs) {
+            uint64_t v = static_cast<uint64_t>(limb) * mul + carry;
+            limb = static_cast<uint32_t>(v);
+            carry = v >> 32;
+        }
+        while (carry) {
+            limbs.push_back(static_cast<uint32_t>(carry));
+            carry >>= 32;
+        }
+    }
+
+    // 3. дߵ limb ȥǰ 0 ֽ
+    size_t topBytes = 0;
+    if (!limbs.empty()) {
+        for (uint32_t top = limbs.back(); top; top >>= 8) topBytes++;
+    }
+    size_t bytes = limbs.empty() ? 0 : (limbs.size() - 1) * 4 + topBytes;
 
-    // 3. 
-    return EncodeBase58(result);
-}
\ No newline at end of file
+    out.assign(zeros + bytes, 0);
+    size_t pos = out.size();
+    for (size_t l = 0; l < limbs.size(); l++) {
+        uint32_t limb = limbs[l];
+        size_t count = (l + 1 == limbs.size()) ? topBytes : 4;
+        for (size_t k = 0; k < count; k++) {
+            out[--pos] = static_cast<uint8_t>(limb);
+            limb >>= 8;
+        }
+    }
+    return true;
+}
+
+bool DecodeBase58Check(const std::string& str, Bytes& out) {
+    if (!DecodeBase58(str, out) || out.size() < 4) {
+        out.clear();
+        return false;
+    }
+    size_t len = out.size() - 4;
+    uint8_t hash[32];
+    Sha256D(hash, out.data(), len);
+    if (memcmp(hash, out.data() + len, 4) != 0) {
+        out.clear();
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+
+std::vector<std::string> EncodeBase58CheckBatch(const std::vector<Bytes>& payloads) {
+    std::vector<std::string> result(payloads.size());
+    ThreadPool::Shared().ParallelFor(payloads.size(), BASE58_BATCH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) result[i] = EncodeBase58Check(payloads[i]);
+    });
+    return result;
+}
+
+std::vector<bool> DecodeBase58CheckBatch(const std::vector<std::string>& strs, std::vector<Bytes>& out) {
+    out.assign(strs.size(), Bytes());
+    // vector<bool> λ洢߳дͬһֽڲȫд char 
+    std::vector<char> valid(strs.size(), 0);
+    ThreadPool::Shared().ParallelFor(strs.size(), BASE58_BATCH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) valid[i] = DecodeBase58Check(strs[i], out[i]);
+    });
+    return std::vector<bool>(valid.begin(), valid.end());
+}
@@ -6,10 +6,27 @@
 #include "../Crypto/Hash.h" // Ҫõ bytes 
 
 //  Base58 
+//  58^5 ΪһλţÿγԽ 4 ֽڣֽڳ 58 Լ 20 㣻
+// ãһη䡣
+std::string EncodeBase58(const uint8_t* data, size_t len);
 std::string EncodeBase58(const Bytes& data);
 
 // Base58Check  (Base58 + 4ֽУ)
 // رҵַɵ
+std::string EncodeBase58Check(const uint8_t* data, size_t len);
 std::string EncodeBase58Check(const Bytes& data);
 
-#endif //BITCOIN_WALLET_BASE58_H
\ No newline at end of file
+// Base58  (Ӧ v0.1.5 base58.h е DecodeBase58)
+// ĸַ (հ) ʱ falseout 
+bool DecodeBase58(const std::string& str, Bytes& out);
+
+// Base58Check 룺УͲԻ򳤶Ȳ 4 ֽʱ falseɹʱ out У
+bool DecodeBase58Check(const std::string& str, Bytes& out);
+
+// ӿڣַ֮һҪַĳϣڹ̳߳ﲢ
+std::vector<std::string> EncodeBase58CheckBatch(const std::vector<Bytes>& payloads);
+
+// out һһӦ (ʧܵΪ)ÿһǷɹ
+std::vector<bool> DecodeBase58CheckBatch(const std::vector<std::string>& strs, std::vector<Bytes>& out);
+
+#endif //BITCOIN_WALLET_BASE58_H
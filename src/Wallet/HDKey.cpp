@@ -0,0 +1,105 @@
+﻿#include "HDKey.h"
+#include "../Utils/ThreadPool.h"
+#include <stdexcept>
+#include <openssl/bn.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+// secp256k1 的阶 n
+static const uint8_t CURVE_ORDER[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+    0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48, 0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41,
+};
+
+// HMAC-SHA512，结果拆成左右两半 (各 32 字节)
+static void HmacSha512(const uint8_t* key, size_t keyLen, const Bytes& data, uint256& left, uint256& right) {
+    uint8_t out[64];
+    unsigned int outLen = 0;
+    if (!HMAC(EVP_sha512(), key, static_cast<int>(keyLen), data.data(), data.size(), out, &outLen) || outLen != 64) {
+        throw std::runtime_error("OpenSSL: HMAC-SHA512 failed");
+    }
+    std::copy(out, out + 32, left.begin());
+    std::copy(out + 32, out + 64, right.begin());
+}
+
+// out = (a + b) mod n；tweak 本身 >= n 或结果为 0 时返回 false (BIP32 规定这个序号作废)
+static bool AddModOrder(const uint256& a, const uint256& tweak, uint256& out) {
+    BIGNUM* x = BN_bin2bn(a.data(), a.size(), nullptr);
+    BIGNUM* t = BN_bin2bn(tweak.data(), tweak.size(), nullptr);
+    BIGNUM* n = BN_bin2bn(CURVE_ORDER, sizeof(CURVE_ORDER), nullptr);
+    BIGNUM* r = BN_new();
+    BN_CTX* ctx = BN_CTX_new();
+
+    bool ok = x && t && n && r && ctx
+        && BN_cmp(t, n) < 0
+        && BN_mod_add(r, x, t, n, ctx) == 1
+        && !BN_is_zero(r)
+        && BN_bn2binpad(r, out.data(), out.size()) == static_cast<int>(out.size());
+
+    BN_CTX_free(ctx);
+    BN_clear_free(r);
+    BN_free(n);
+    BN_clear_free(t);
+    BN_clear_free(x);
+    return ok;
+}
+
+HDKey HDKey::FromSeed(const Bytes& seed) {
+    static const char SEED_KEY[] = "Bitcoin seed";
+    HDKey key;
+    HmacSha512(reinterpret_cast<const uint8_t*>(SEED_KEY), sizeof(SEED_KEY) - 1, seed, key.secret, key.chainCode);
+    key.pubKey = Wallet::ComputePublicKey(key.secret); // 私钥为 0 或 >= n 时抛异常
+    return key;
+}
+
+HDKey HDKey::Derive(uint32_t index) const {
+    // 强化派生：0x00 || 私钥 || 序号；普通派生：压缩公钥 || 序号 (序号大端序)
+    Bytes data;
+    data.reserve(37);
+    if (index >= HARDENED) {
+        data.push_back(0x00);
+        data.insert(data.end(), secret.begin(), secret.end());
+    }
+    else {
+        data.insert(data.end(), pubKey.begin(), pubKey.end());
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) data.push_back(static_cast<uint8_t>(index >> shift));
+
+    uint256 tweak;
+    HDKey child;
+    HmacSha512(chainCode.data(), chainCode.size(), data, tweak, child.chainCode);
+    if (!AddModOrder(secret, tweak, child.secret)) {
+        throw std::runtime_error("HDKey: invalid child key at index " + std::to_string(index));
+    }
+    child.pubKey = Wallet::ComputePublicKey(child.secret);
+    child.depth = depth + 1;
+    child.childNumber = index;
+    return child;
+}
+
+HDKey HDKey::DerivePath(const std::vector<uint32_t>& path) const {
+    HDKey key = *this;
+    for (uint32_t index : path) key = key.Derive(index);
+    return key;
+}
+
+std::vector<Wallet> HDKey::DeriveWallets(uint32_t first, size_t count) const {
+    std::vector<Wallet> wallets(count);
+    ThreadPool::Shared().ParallelFor(count, 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            try {
+                wallets[i] = Derive(first + static_cast<uint32_t>(i)).ToWallet();
+            }
+            catch (const std::runtime_error&) {
+                // 作废的序号留空
+            }
+        }
+    });
+    return wallets;
+}
+
+Wallet HDKey::ToWallet() const {
+    Wallet wallet;
+    wallet.ImportKey(secret, pubKey);
+    return wallet;
+}
@@ -0,0 +1,46 @@
+﻿#ifndef BITCOIN_WALLET_HDKEY_H
+#define BITCOIN_WALLET_HDKEY_H
+
+#include "Wallet.h"
+#include <vector>
+
+// 分层确定性密钥 (对应 BIP32 的扩展私钥)
+// 从一个种子派生出整棵密钥树：只要备份种子，就能恢复派生过的所有地址。
+// 对象只保存私钥、链码和缓存的压缩公钥 (可以随意复制)，需要签名时再用 ToWallet 生成 Wallet。
+class HDKey {
+public:
+    // 序号 >= HARDENED 的是强化派生 (用父私钥派生，子公钥无法由父公钥推出)
+    static const uint32_t HARDENED = 0x80000000;
+
+    // 由种子生成主密钥 m (HMAC-SHA512，密钥 "Bitcoin seed")；种子长度应为 16~64 字节
+    static HDKey FromSeed(const Bytes& seed);
+
+    // 派生第 index 个子密钥；极小概率遇到不合法的子密钥时抛异常 (调用方换下一个序号即可)
+    HDKey Derive(uint32_t index) const;
+
+    // 按路径连续派生，例如 { 44 | HARDENED, 0 | HARDENED, 0 }
+    HDKey DerivePath(const std::vector<uint32_t>& path) const;
+
+    // 并行派生 [first, first + count) 这些序号的子密钥并转换成 Wallet (地址已算好)
+    // 派生失败的序号对应的 Wallet 为空 (HasKey() == false)
+    std::vector<Wallet> DeriveWallets(uint32_t first, size_t count) const;
+
+    const uint256& GetPrivateKey() const { return secret; }
+    const uint256& GetChainCode() const { return chainCode; }
+    const Bytes& GetPublicKey() const { return pubKey; }
+    uint8_t GetDepth() const { return depth; }
+    uint32_t GetChildNumber() const { return childNumber; }
+
+    Wallet ToWallet() const;
+
+private:
+    HDKey() {}
+
+    uint256 secret;     // 私钥 (大端序)
+    uint256 chainCode;
+    Bytes pubKey;       // 33 字节压缩公钥
+    uint8_t depth = 0;
+    uint32_t childNumber = 0;
+};
+
+#endif //BITCOIN_WALLET_HDKEY_H
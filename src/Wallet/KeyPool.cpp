@@ -0,0 +1,103 @@
+﻿#include "KeyPool.h"
+#include <algorithm>
+
+// 每批生成的数量：足够分给所有核心，又不会让等待的 Take 等太久
+static const size_t REFILL_BATCH = 256;
+
+KeyPool::KeyPool(size_t targetSize) : targetSize(std::max<size_t>(targetSize, 1)) {
+    Start();
+}
+
+KeyPool::KeyPool(const HDKey& account, uint32_t nextIndex, size_t targetSize)
+    : targetSize(std::max<size_t>(targetSize, 1)), account(new HDKey(account)), deriveIndex(nextIndex), firstIndex(nextIndex) {
+    Start();
+}
+
+KeyPool::~KeyPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    refillCv.notify_all();
+    worker.join();
+}
+
+void KeyPool::Start() {
+    worker = std::thread([this]() { RefillLoop(); });
+}
+
+void KeyPool::RefillLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 降到一半以下才开始补，避免每取一个就唤醒一次
+        refillCv.wait(lock, [this]() { return stopping || (!error && keys.size() <= targetSize / 2); });
+        if (stopping) return;
+
+        while (!stopping && keys.size() < targetSize) {
+            size_t count = std::min(REFILL_BATCH, targetSize - keys.size());
+            uint32_t first = deriveIndex;
+            lock.unlock();
+
+            // 生成期间不持锁，Take 可以继续取已有的密钥
+            std::vector<Wallet> batch;
+            std::exception_ptr failure;
+            try {
+                if (account) {
+                    if (static_cast<uint64_t>(first) + count > HDKey::HARDENED) {
+                        throw std::runtime_error("KeyPool: derivation index exhausted");
+                    }
+                    batch = account->DeriveWallets(first, count);
+                }
+                else {
+                    batch = Wallet::GenerateBatch(count);
+                }
+            }
+            catch (...) {
+                failure = std::current_exception();
+            }
+
+            lock.lock();
+            if (failure) {
+                error = failure;
+                availableCv.notify_all();
+                break;
+            }
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (!batch[i].HasKey()) continue; // 作废的派生序号
+                keys.push_back({ std::move(batch[i]), first + static_cast<uint32_t>(i) });
+            }
+            deriveIndex = first + static_cast<uint32_t>(count);
+            availableCv.notify_all();
+        }
+    }
+}
+
+Wallet KeyPool::Take() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (keys.empty()) {
+        refillCv.notify_one();
+        availableCv.wait(lock, [this]() { return !keys.empty() || error; });
+        if (keys.empty()) std::rethrow_exception(error);
+    }
+
+    Entry entry = std::move(keys.front());
+    keys.pop_front();
+    firstIndex = entry.index + 1;
+    if (keys.size() <= targetSize / 2) refillCv.notify_one();
+    return std::move(entry.key);
+}
+
+uint32_t KeyPool::NextIndex() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keys.empty() ? firstIndex : keys.front().index;
+}
+
+void KeyPool::WaitUntilFull() {
+    std::unique_lock<std::mutex> lock(mutex);
+    availableCv.wait(lock, [this]() { return keys.size() >= targetSize || error; });
+}
+
+size_t KeyPool::Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keys.size();
+}
@@ -0,0 +1,69 @@
+﻿#ifndef BITCOIN_WALLET_KEYPOOL_H
+#define BITCOIN_WALLET_KEYPOOL_H
+
+#include "HDKey.h"
+#include "Wallet.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 预先生成好的密钥池 (对应 Bitcoin Core 的 keypool)
+// 分配地址时直接从池里取一个现成的 (地址已经算好)，不用当场做标量乘法。
+// 后台线程在池子降到一半以下时批量补充 (批量生成会用满所有核心)。
+// 两种来源：随机密钥，或者按顺序从一个 HDKey 派生的子密钥 (只需备份种子和用到的序号)。
+// 线程安全，多个线程可以同时 Take。
+class KeyPool {
+public:
+    static const size_t DEFAULT_SIZE = 1000;
+
+    // 随机密钥
+    explicit KeyPool(size_t targetSize = DEFAULT_SIZE);
+
+    // 从 account 的第 nextIndex 个子密钥开始依次派生 (普通派生，序号必须小于 HDKey::HARDENED)
+    KeyPool(const HDKey& account, uint32_t nextIndex, size_t targetSize = DEFAULT_SIZE);
+
+    ~KeyPool();
+
+    KeyPool(const KeyPool&) = delete;
+    KeyPool& operator=(const KeyPool&) = delete;
+
+    // 取出一个密钥；池子空了就等后台补充。后台生成失败时抛异常
+    // 派生模式下按序号从小到大交出 (派生失败的序号会被跳过)
+    Wallet Take();
+
+    // 派生模式下，下一次 Take 会交出的序号 (重启时从这里继续，地址不会重复)
+    uint32_t NextIndex() const;
+
+    // 等到池子补满 (或后台出错) 为止
+    void WaitUntilFull();
+
+    size_t Size() const;
+    size_t TargetSize() const { return targetSize; }
+
+private:
+    struct Entry {
+        Wallet key;
+        uint32_t index = 0;
+    };
+
+    void Start();
+    void RefillLoop();
+
+    const size_t targetSize;
+    std::unique_ptr<HDKey> account;   // 为空表示随机密钥
+    uint32_t deriveIndex = 0;         // 后台下一个要派生的序号 (只有后台线程访问)
+    uint32_t firstIndex = 0;          // 池子为空时 NextIndex 的返回值
+
+    mutable std::mutex mutex;
+    std::condition_variable refillCv;     // 通知后台线程补充
+    std::condition_variable availableCv;  // 通知等待的 Take / WaitUntilFull
+    std::deque<Entry> keys;
+    std::exception_ptr error;             // 后台生成失败的原因
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif //BITCOIN_WALLET_KEYPOOL_H
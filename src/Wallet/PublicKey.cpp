@@ -0,0 +1,112 @@
+﻿#include "PublicKey.h"
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+
+PublicKey::PublicKey(const Bytes& bytes) : data(bytes) {
+    if (data.size() != 33 && data.size() != 65) return;
+
+    OSSL_PARAM_BLD* bld = OSSL_PARAM_BLD_new();
+    OSSL_PARAM* params = nullptr;
+    EVP_PKEY_CTX* ctx = nullptr;
+    EVP_PKEY* key = nullptr;
+
+    if (bld
+        && OSSL_PARAM_BLD_push_utf8_string(bld, OSSL_PKEY_PARAM_GROUP_NAME, "secp256k1", 0)
+        && OSSL_PARAM_BLD_push_octet_string(bld, OSSL_PKEY_PARAM_PUB_KEY, data.data(), data.size())
+        && (params = OSSL_PARAM_BLD_to_param(bld)) != nullptr
+        && (ctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr)) != nullptr
+        && EVP_PKEY_fromdata_init(ctx) == 1
+        && EVP_PKEY_fromdata(ctx, &key, EVP_PKEY_PUBLIC_KEY, params) == 1) {
+        // fromdata 只解码点；再确认它在曲线上 (无穷远点、不在曲线上的点都会被拒绝)
+        EVP_PKEY_CTX* check = EVP_PKEY_CTX_new_from_pkey(nullptr, key, nullptr);
+        if (check && EVP_PKEY_public_check(check) == 1) {
+            pkey = key;
+            key = nullptr;
+        }
+        EVP_PKEY_CTX_free(check);
+    }
+
+    EVP_PKEY_free(key);
+    EVP_PKEY_CTX_free(ctx);
+    OSSL_PARAM_free(params);
+    OSSL_PARAM_BLD_free(bld);
+}
+
+PublicKey::~PublicKey() {
+    EVP_PKEY_free(pkey);
+}
+
+PublicKey::PublicKey(PublicKey&& other) noexcept : pkey(other.pkey), data(std::move(other.data)) {
+    other.pkey = nullptr;
+}
+
+PublicKey& PublicKey::operator=(PublicKey&& other) noexcept {
+    if (this != &other) {
+        EVP_PKEY_free(pkey);
+        pkey = other.pkey;
+        data = std::move(other.data);
+        other.pkey = nullptr;
+    }
+    return *this;
+}
+
+bool PublicKey::Verify(const uint256& hash, const Bytes& signature) const {
+    if (!pkey || signature.empty()) return false;
+
+    // EVP_PKEY 本身可以被多个线程共享，ctx 每次验证单独创建
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_pkey(nullptr, pkey, nullptr);
+    if (!ctx) return false;
+    int result = 0;
+    if (EVP_PKEY_verify_init(ctx) == 1) {
+        // 签名是 DER 编码，被签的是已经算好的 32 字节哈希 (不再做摘要)
+        result = EVP_PKEY_verify(ctx, signature.data(), signature.size(), hash.data(), hash.size());
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return result == 1;
+}
+
+PublicKeyCache::PublicKeyCache(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+std::shared_ptr<const PublicKey> PublicKeyCache::Get(const Bytes& serialized) {
+    std::string key(serialized.begin(), serialized.end());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            hits++;
+            return it->second->second;
+        }
+    }
+    misses++;
+
+    // 解析在锁外做，不挡住其他线程的命中
+    auto parsed = std::make_shared<const PublicKey>(serialized);
+    if (!parsed->IsValid()) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // 别的线程已经放进去了
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+    lru.emplace_front(key, parsed);
+    index[key] = lru.begin();
+    if (lru.size() > capacity) {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return parsed;
+}
+
+size_t PublicKeyCache::Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+PublicKeyCache& PublicKeyCache::Shared() {
+    static PublicKeyCache cache;
+    return cache;
+}
@@ -0,0 +1,70 @@
+﻿#ifndef BITCOIN_WALLET_PUBLICKEY_H
+#define BITCOIN_WALLET_PUBLICKEY_H
+
+#include "../Crypto/Hash.h"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+typedef struct evp_pkey_st EVP_PKEY;
+
+// 解析好的 secp256k1 公钥
+// 构造时解压并校验曲线上的点 (只做一次)，之后可以反复验证签名。
+// Verify 是 const 的，多个线程可以同时用同一个对象验证。
+class PublicKey {
+public:
+    PublicKey() = default;
+    // 解析 33 字节压缩或 65 字节非压缩公钥；不合法时 IsValid() 为 false
+    explicit PublicKey(const Bytes& data);
+    ~PublicKey();
+
+    PublicKey(PublicKey&& other) noexcept;
+    PublicKey& operator=(PublicKey&& other) noexcept;
+    PublicKey(const PublicKey&) = delete;
+    PublicKey& operator=(const PublicKey&) = delete;
+
+    bool IsValid() const { return pkey != nullptr; }
+
+    // 序列化形式 (构造时传入的字节)
+    const Bytes& GetBytes() const { return data; }
+
+    // 验证 DER 格式的 ECDSA 签名
+    bool Verify(const uint256& hash, const Bytes& signature) const;
+
+private:
+    EVP_PKEY* pkey = nullptr;
+    Bytes data;
+};
+
+// 已解析公钥的 LRU 缓存，键为序列化的公钥
+// 同一个地址的币常常被反复花，验证时可以省掉每次解压公钥的开销。
+class PublicKeyCache {
+public:
+    explicit PublicKeyCache(size_t capacity = 4096);
+
+    // 取出 (必要时解析并放入) 公钥；公钥不合法时返回 nullptr (不合法的不缓存)
+    std::shared_ptr<const PublicKey> Get(const Bytes& serialized);
+
+    size_t Size() const;
+    size_t Capacity() const { return capacity; }
+    uint64_t Hits() const { return hits.load(); }
+    uint64_t Misses() const { return misses.load(); }
+
+    // 进程内共享的缓存 (Wallet::Verify 使用)
+    static PublicKeyCache& Shared();
+
+private:
+    typedef std::pair<std::string, std::shared_ptr<const PublicKey>> Entry;
+
+    size_t capacity;
+    std::list<Entry> lru;   // 最近使用的在前面
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    mutable std::mutex mutex;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+#endif //BITCOIN_WALLET_PUBLICKEY_H
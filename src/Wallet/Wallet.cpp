@@ -1,7 +1,22 @@
 ﻿#include "Wallet.h"
 #include "Base58.h"
+#include "PublicKey.h"
+#include "../Utils/ThreadPool.h"
+#include <algorithm>
 #include <iostream>
-#include <openssl/ecdsa.h>
+#include <stdexcept>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/param_build.h>
+
+// secp256k1 曲线参数，进程内只创建一次 (只读，多线程共享安全)
+static const EC_GROUP* Secp256k1Group() {
+    static const EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+    return group;
+}
 
 Wallet::Wallet() {
     pKey = nullptr;
@@ -9,90 +24,183 @@ Wallet::Wallet() {
 
 Wallet::~Wallet() {
     if (pKey) {
-        EC_KEY_free(pKey);
+        EVP_PKEY_free(pKey);
     }
 }
 
-void Wallet::GenerateNewKey() {
-    // 1. 创建 secp256k1 曲线
-    pKey = EC_KEY_new_by_curve_name(NID_secp256k1);
-    if (!pKey) {
-        throw std::runtime_error("OpenSSL: Failed to create key structure");
-    }
+Wallet::Wallet(Wallet&& other) noexcept
+    : pKey(other.pKey), pubKey(std::move(other.pubKey)), pubKeyHash(other.pubKeyHash), address(std::move(other.address)) {
+    other.pKey = nullptr;
+}
 
-    // 2. 生成密钥对
-    if (!EC_KEY_generate_key(pKey)) {
-        throw std::runtime_error("OpenSSL: Failed to generate key");
+Wallet& Wallet::operator=(Wallet&& other) noexcept {
+    if (this != &other) {
+        if (pKey) EVP_PKEY_free(pKey);
+        pKey = other.pKey;
+        pubKey = std::move(other.pubKey);
+        pubKeyHash = other.pubKeyHash;
+        address = std::move(other.address);
+        other.pKey = nullptr;
     }
+    return *this;
+}
 
-    // 设置为压缩格式 (现代比特币标准，虽然 v0.1 是非压缩的，但我们用现代的更好)
-    EC_KEY_set_conv_form(pKey, POINT_CONVERSION_COMPRESSED);
+void Wallet::SetKey(EVP_PKEY* key, Bytes compressedPubKey) {
+    if (pKey) EVP_PKEY_free(pKey);
+    pKey = key;
+    pubKey = std::move(compressedPubKey);
+    pubKeyHash = Hash160(pubKey);
+    address = AddressFromPubKeyHash(pubKeyHash);
 }
 
-Bytes Wallet::GetPublicKey() const {
-    if (!pKey) return {};
+void Wallet::GenerateNewKey() {
+    // 1. 在 secp256k1 曲线上生成密钥对
+    EVP_PKEY* key = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "secp256k1");
+    if (!key) {
+        throw std::runtime_error("OpenSSL: Failed to generate key");
+    }
 
-    // 获取曲线上的点
-    const EC_GROUP* group = EC_KEY_get0_group(pKey);
-    const EC_POINT* point = EC_KEY_get0_public_key(pKey);
+    // 导出公钥点 (OpenSSL 3.0 不管设置什么格式都导出 65 字节非压缩形式: 04 || X || Y)
+    Bytes point(65);
+    size_t length = 0;
+    if (!EVP_PKEY_get_octet_string_param(key, OSSL_PKEY_PARAM_PUB_KEY, point.data(), point.size(), &length)) {
+        EVP_PKEY_free(key);
+        throw std::runtime_error("OpenSSL: Failed to export public key");
+    }
 
-    // 将点转换为字节流
-    int length = EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, nullptr, 0, nullptr);
-    Bytes pubKey(length);
-    EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, pubKey.data(), length, nullptr);
+    // 转换为压缩格式 (现代比特币标准，虽然 v0.1 是非压缩的，但我们用现代的更好)
+    // 压缩公钥 = (Y 为偶数 ? 02 : 03) || X
+    Bytes compressed(33);
+    if (length == 33) {
+        std::copy(point.begin(), point.begin() + 33, compressed.begin());
+    }
+    else {
+        compressed[0] = (point[64] & 1) ? 0x03 : 0x02;
+        std::copy(point.begin() + 1, point.begin() + 33, compressed.begin() + 1);
+    }
 
-    return pubKey;
+    // 2. 替换旧密钥，顺便算好公钥哈希和地址
+    SetKey(key, std::move(compressed));
 }
 
-std::string Wallet::GetAddress() const {
-    // 1. 获取公钥
-    Bytes pubKey = GetPublicKey();
+Bytes Wallet::ComputePublicKey(const uint256& secret) {
+    const EC_GROUP* group = Secp256k1Group();
+    BIGNUM* k = BN_bin2bn(secret.data(), secret.size(), nullptr);
+    EC_POINT* point = EC_POINT_new(group);
+    BN_CTX* ctx = BN_CTX_new();
+
+    Bytes result(33);
+    bool ok = k && point && ctx
+        && !BN_is_zero(k) && BN_cmp(k, EC_GROUP_get0_order(group)) < 0
+        && EC_POINT_mul(group, point, k, nullptr, nullptr, ctx) == 1
+        && EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, result.data(), result.size(), ctx) == 33;
+
+    BN_CTX_free(ctx);
+    EC_POINT_free(point);
+    BN_clear_free(k);
+    if (!ok) throw std::runtime_error("Invalid private key");
+    return result;
+}
 
-    // 2. 计算 Hash160 (SHA256 -> RIPEMD160)
-    Bytes pubKeyHash = Hash160(pubKey);
+void Wallet::SetPrivateKey(const uint256& secret) {
+    ImportKey(secret, ComputePublicKey(secret));
+}
 
-    // 3. 添加版本号 (主网地址以 0x00 开头)
-    Bytes versionedPayload;
-    versionedPayload.push_back(0x00); // Version byte
-    versionedPayload.insert(versionedPayload.end(), pubKeyHash.begin(), pubKeyHash.end());
+void Wallet::ImportKey(const uint256& secret, Bytes compressed) {
+    // 私钥和 (算好的) 公钥一起导入，OpenSSL 不用再算一遍
+    BIGNUM* k = BN_bin2bn(secret.data(), secret.size(), nullptr);
+    OSSL_PARAM_BLD* bld = OSSL_PARAM_BLD_new();
+    OSSL_PARAM* params = nullptr;
+    EVP_PKEY_CTX* ctx = nullptr;
+    EVP_PKEY* key = nullptr;
+
+    if (k && bld
+        && OSSL_PARAM_BLD_push_utf8_string(bld, OSSL_PKEY_PARAM_GROUP_NAME, "secp256k1", 0)
+        && OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_PRIV_KEY, k)
+        && OSSL_PARAM_BLD_push_octet_string(bld, OSSL_PKEY_PARAM_PUB_KEY, compressed.data(), compressed.size())
+        && (params = OSSL_PARAM_BLD_to_param(bld)) != nullptr
+        && (ctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr)) != nullptr
+        && EVP_PKEY_fromdata_init(ctx) == 1) {
+        EVP_PKEY_fromdata(ctx, &key, EVP_PKEY_KEYPAIR, params);
+    }
 
-    // 4. Base58Check 编码 (这一步会自动加校验和)
-    return EncodeBase58Check(versionedPayload);
-}
+    EVP_PKEY_CTX_free(ctx);
+    OSSL_PARAM_free(params);
+    OSSL_PARAM_BLD_free(bld);
+    BN_clear_free(k);
+    if (!key) throw std::runtime_error("OpenSSL: Failed to import private key");
 
+    SetKey(key, std::move(compressed));
+}
 
-Bytes Wallet::Sign(const Bytes& hash) const {
+uint256 Wallet::GetPrivateKey() const {
     if (!pKey) throw std::runtime_error("No private key");
 
-    // ECDSA 签名
-    ECDSA_SIG* sig = ECDSA_do_sign(hash.data(), hash.size(), pKey);
-    if (!sig) return {};
+    BIGNUM* k = nullptr;
+    uint256 secret;
+    bool ok = EVP_PKEY_get_bn_param(pKey, OSSL_PKEY_PARAM_PRIV_KEY, &k) == 1
+        && BN_bn2binpad(k, secret.data(), secret.size()) == static_cast<int>(secret.size());
+    BN_clear_free(k);
+    if (!ok) throw std::runtime_error("OpenSSL: Failed to export private key");
+    return secret;
+}
+
+std::vector<Wallet> Wallet::GenerateBatch(size_t count) {
+    // 每个密钥互相独立，按小块分给各个核心；单个密钥的生成 (一次标量乘法) 足够重，块不用太大
+    std::vector<Wallet> wallets(count);
+    ThreadPool::Shared().ParallelFor(count, 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) wallets[i].GenerateNewKey();
+    });
+    return wallets;
+}
 
-    // 将签名结构体序列化为 DER 字节流 (比特币标准格式)
-    int len = i2d_ECDSA_SIG(sig, nullptr);
-    Bytes derSig(len);
-    unsigned char* p = derSig.data();
-    i2d_ECDSA_SIG(sig, &p);
+std::string Wallet::AddressFromPublicKey(const Bytes& pubKey) {
+    // 2. 计算 Hash160 (SHA256 -> RIPEMD160)
+    return AddressFromPubKeyHash(Hash160(pubKey));
+}
 
-    ECDSA_SIG_free(sig);
-    return derSig;
+std::string Wallet::AddressFromPubKeyHash(const uint160& pubKeyHash) {
+    // 3. 添加版本号 (主网地址以 0x00 开头)，放在栈上的 21 字节缓冲区里
+    uint8_t versionedPayload[1 + 20];
+    versionedPayload[0] = 0x00; // Version byte
+    std::copy(pubKeyHash.begin(), pubKeyHash.end(), versionedPayload + 1);
+
+    // 4. Base58Check 编码 (这一步会自动加校验和)
+    return EncodeBase58Check(versionedPayload, sizeof(versionedPayload));
 }
 
-bool Wallet::Verify(const Bytes& pubKeyData, const Bytes& hash, const Bytes& signature) {
-    // 1. 还原公钥
-    const unsigned char* pPub = pubKeyData.data();
-    EC_KEY* key = EC_KEY_new_by_curve_name(NID_secp256k1);
-    o2i_ECPublicKey(&key, &pPub, pubKeyData.size());
+bool Wallet::PubKeyHashFromAddress(const std::string& address, uint160& hash) {
+    Bytes payload;
+    if (!DecodeBase58Check(address, payload)) return false;
+    if (payload.size() != 1 + 20 || payload[0] != 0x00) return false;
+    std::copy(payload.begin() + 1, payload.end(), hash.begin());
+    return true;
+}
 
-    // 2. 还原签名
-    const unsigned char* pSig = signature.data();
-    ECDSA_SIG* sig = d2i_ECDSA_SIG(nullptr, &pSig, signature.size());
 
-    // 3. 验证
-    int result = ECDSA_do_verify(hash.data(), hash.size(), sig, key);
+Bytes Wallet::Sign(const uint256& hash) const {
+    if (!pKey) throw std::runtime_error("No private key");
 
-    ECDSA_SIG_free(sig);
-    EC_KEY_free(key);
+    // ECDSA 签名 (对已经算好的哈希直接签名)，输出 DER 字节流 (比特币标准格式)
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_pkey(nullptr, pKey, nullptr);
+    Bytes derSig;
+    size_t len = 0;
+    if (ctx && EVP_PKEY_sign_init(ctx) == 1
+        && EVP_PKEY_sign(ctx, nullptr, &len, hash.data(), hash.size()) == 1) {
+        derSig.resize(len);
+        if (EVP_PKEY_sign(ctx, derSig.data(), &len, hash.data(), hash.size()) == 1) {
+            derSig.resize(len);
+        }
+        else {
+            derSig.clear();
+        }
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return derSig;
+}
 
-    return (result == 1);
-}
\ No newline at end of file
+bool Wallet::Verify(const Bytes& pubKeyData, const uint256& hash, const Bytes& signature) {
+    // 区块里的数据不可信：公钥解析失败也算验证失败
+    std::shared_ptr<const PublicKey> key = PublicKeyCache::Shared().Get(pubKeyData);
+    return key && key->Verify(hash, signature);
+}
@@ -2,31 +2,77 @@
 #define BITCOIN_WALLET_WALLET_H
 
 #include "../Crypto/Hash.h"
-#include <openssl/ec.h>
-#include <openssl/obj_mac.h> // NID_secp256k1
+
+#include <vector>
+
+typedef struct evp_pkey_st EVP_PKEY;
 
 class Wallet {
 private:
-    EC_KEY* pKey; // OpenSSL 的 ECC 密钥结构体
+    EVP_PKEY* pKey; // OpenSSL 3 的密钥对象 (secp256k1)
+
+    // 换密钥时一次算好：公钥、公钥哈希、地址都只算一次，之后直接返回
+    Bytes pubKey;
+    uint160 pubKeyHash;
+    std::string address;
+
+    // 接管 key 并刷新缓存
+    void SetKey(EVP_PKEY* key, Bytes compressedPubKey);
+
+    // 导入私钥和已经算好的公钥 (HDKey 派生时已经算过公钥，不必再做一次标量乘法)
+    void ImportKey(const uint256& secret, Bytes compressedPubKey);
+    friend class HDKey;
 
 public:
     Wallet();
     ~Wallet();
 
+    // 持有私钥，不允许复制 (复制会导致同一个密钥被释放两次)；可以移动 (放进容器、从密钥池取出)
+    Wallet(const Wallet&) = delete;
+    Wallet& operator=(const Wallet&) = delete;
+    Wallet(Wallet&& other) noexcept;
+    Wallet& operator=(Wallet&& other) noexcept;
+
     // 生成新的随机私钥
     void GenerateNewKey();
 
-    // 获取公钥 (字节流形式)
-    Bytes GetPublicKey() const;
+    // 使用给定的私钥 (32 字节大端序整数，必须在 [1, n-1] 之间，否则抛异常)
+    void SetPrivateKey(const uint256& secret);
+
+    // 导出私钥 (大端序)，用于备份和分层派生
+    uint256 GetPrivateKey() const;
+
+    bool HasKey() const { return pKey != nullptr; }
+
+    // 批量生成 count 个随机密钥，分散到共享线程池的所有核心上
+    static std::vector<Wallet> GenerateBatch(size_t count);
+
+    // 获取公钥 (33 字节压缩形式)
+    const Bytes& GetPublicKey() const { return pubKey; }
 
     // 获取钱包地址 (Base58Check 编码的公钥哈希)
-    std::string GetAddress() const;
+    const std::string& GetAddress() const { return address; }
+
+    // 公钥哈希 (Hash160)，交易输出里存的就是它，匹配自己的输出时直接比较这 20 字节
+    const uint160& GetPubKeyHash() const { return pubKeyHash; }
+
+    // 由私钥计算压缩公钥 (k*G)，私钥不合法时抛异常
+    static Bytes ComputePublicKey(const uint256& secret);
+
+    // 由公钥计算地址 (不需要私钥)
+    static std::string AddressFromPublicKey(const Bytes& pubKey);
+
+    // 地址与公钥哈希互转 (版本号 0x00 + Hash160 的 Base58Check)
+    static std::string AddressFromPubKeyHash(const uint160& hash);
+    // 地址不合法 (字符、校验和、长度或版本号不对) 时返回 false
+    static bool PubKeyHashFromAddress(const std::string& address, uint160& hash);
 
     // [新增] 使用私钥对数据哈希进行签名 (返回 DER 格式的签名)
-    Bytes Sign(const Bytes& hash) const;
+    Bytes Sign(const uint256& hash) const;
 
     // [新增] 静态函数：验证签名是否有效
-    static bool Verify(const Bytes& pubKey, const Bytes& hash, const Bytes& signature);
+    // 公钥经 PublicKeyCache 解析并缓存，同一个公钥反复验证时不再重复解压
+    static bool Verify(const Bytes& pubKey, const uint256& hash, const Bytes& signature);
 };
 
 #endif //BITCOIN_WALLET_WALLET_H
\ No newline at end of file
@@ -1,25 +1,141 @@
 #include "../src/Core/Block.h"
+#include "../src/Core/Pow.h"
+#include "../src/Core/TransactionView.h"
 #include <iostream>
 #include <cassert>
 
 void TestMining() {
     // һģ
-    Bytes prevHash(32, 0); // ٵǰϣ (ȫ0)
-    Bytes merkleRoot(32, 0); // ٵĬ˶ (ȫ0)
+    uint256 prevHash; // ٵǰϣ (ȫ0)
+    uint256 merkleRoot; // ٵĬ˶ (ȫ0)
 
-    // 飺汾1ʱ123456ѶҪ 2 ǰ (Ӧ 0x0000...)
-    Block block(1, prevHash, merkleRoot, 123456, 0);
+    // 飺汾1ʱ123456Ŀ 0x1f00ffff (ϣ 0000 ͷƽԼ 65536 )
+    // ע⣺ʽرҵĴ 0x1d00ffff
+    Block block(1, prevHash, merkleRoot, 123456, 0x1f00ffff);
 
-    // ʼڿѶΪ 2 (ϣֵ 0000 ͷ)
-    // ע⣺ʽرңѶȴ 18-19 
-    block.Mine(2);
+    // ʼڿ
+    block.Mine();
 
     // ֤
-    assert(block.CheckPoW(2) == true);
+    assert(block.CheckPoW() == true);
     std::cout << "Mining Test Passed!" << std::endl;
 }
 
+void TestParallelMining() {
+    uint256 prevHash(Bytes(32, 0x11));
+    uint256 merkleRoot(Bytes(32, 0x22));
+
+    // ͬһͷֱõ̺߳ 4 ߳
+    Block single(1, prevHash, merkleRoot, 123456, 0x1f00ffff);
+    Block parallel(1, prevHash, merkleRoot, 123456, 0x1f00ffff);
+
+    MiningStats s1 = single.Mine(1);
+    MiningStats s4 = parallel.Mine(4);
+
+    // ̱߳ҵ뵥߳ȫͬ nonce
+    assert(parallel.nonce == single.nonce);
+    assert(parallel.CheckPoW() == true);
+    assert(s1.threadHashes.size() == 1);
+    assert(s4.threadHashes.size() == 4);
+    assert(s4.totalHashes >= single.nonce + 1ULL);
+
+    for (size_t i = 0; i < s4.threadHashes.size(); i++) {
+        std::cout << "Thread " << i << ": " << s4.ThreadHashRate(i) << " H/s" << std::endl;
+    }
+    std::cout << "Parallel Mining Test Passed!" << std::endl;
+}
+
+void TestBlockSerialization() {
+    Block block(1, uint256(Bytes(32, 0x11)), uint256(), 123456, 2);
+    block.nonce = 42;
+    for (uint32_t i = 0; i < 300; i++) { //  252CompactSize  3 ֽ
+        Transaction tx;
+        tx.inputs.push_back({ uint256(Bytes(32, (uint8_t)i)), i, Bytes(71, 0xAA), Bytes(33, 0x02) });
+        tx.outputs.push_back({ 1000 + i, Hash160(ToBytes("addr" + std::to_string(i))) });
+        block.AddTransaction(tx);
+    }
+    block.merkleRoot = block.GetMerkleRoot();
+
+    // 1. ׼ȷͷͽ׶
+    Bytes data = block.Serialize();
+    assert(data.size() == block.GetSerializeSize());
+    Block back = DeserializeBlock(ByteView(data));
+    assert(back.GetHash() == block.GetHash() && back.nonce == 42);
+    assert(back.transactions.size() == 300);
+    assert(back.GetMerkleRoot() == block.merkleRoot);
+
+    // 2. ͼֱڻ϶ȡһ
+    BlockView view{ ByteView(data) };
+    assert(view.GetHash() == block.GetHash());
+    assert(view.PrevBlockHash() == block.prevBlockHash && view.Nonce() == 42 && view.Bits() == 2);
+    assert(view.TransactionCount() == 300);
+    assert(view.ComputeMerkleRoot() == block.merkleRoot);
+    const TransactionView& tx = view.GetTransaction(7);
+    assert(tx.GetId() == block.transactions[7].GetId());
+    assert(tx.GetOutput(0).pubKeyHash == Hash160(ToBytes("addr7")));
+    assert(tx.GetInput(0).signature.data >= data.data() && tx.GetInput(0).signature.data < data.data() + data.size());
+
+    // 3. ضϻݶҪܾ
+    for (size_t cut : { (size_t)10, (size_t)Block::HEADER_SIZE, data.size() - 1 }) {
+        bool thrown = false;
+        try { BlockView bad(ByteView(data.data(), cut)); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+    }
+    data.push_back(0);
+    bool thrown = false;
+    try { DeserializeBlock(ByteView(data)); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+    std::cout << "Block Serialization Test Passed!" << std::endl;
+}
+
+void TestProofOfWork() {
+    // 1. Ϸ bitsĿΪ 0
+    ArithUint256 target;
+    assert(DecodeTarget(0x1d00ffff, target));
+    assert(!DecodeTarget(0x04923456, target));
+    assert(!DecodeTarget(0xff123456, target));
+    assert(!DecodeTarget(0x01003456, target));
+    Block bad(1, uint256(), uint256(), 123456, 0x04923456);
+    assert(!bad.CheckPoW());
+    bool thrown = false;
+    try { bad.Mine(); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+
+    // 2. ϣĿҲϸ񣬴 1 Ͳϸ
+    DecodeTarget(0x1f00ffff, target);
+    assert(HashMeetsTarget(target.ToUint256().data(), target));
+    assert(!HashMeetsTarget((target + 1).ToUint256().data(), target));
+    assert(HashMeetsTarget((target - 1).ToUint256().data(), target));
+    assert(HashMeetsTarget(uint256().data(), target));
+    assert(!HashMeetsTarget((~ArithUint256()).ToUint256().data(), target));
+
+    // 3.  = 2^256 / (target + 1)
+    assert(GetBlockWork(0x1d00ffff) == ArithUint256(0x100010001ULL));
+    assert(GetBlockWork(0x1f00ffff) == ArithUint256(0x10001));
+    assert(GetBlockWork(0x04923456) == ArithUint256());
+
+    // 4. ѶȵĿ = Ŀ * ʵʺʱ / ʱ [1/4, 4] Ҳ
+    ConsensusParams params;
+    params.powLimitBits = 0x1f00ffff;
+    params.targetSpacing = 10;
+    params.retargetInterval = 20;
+    ArithUint256 old;
+    old.SetCompact(0x1e00ffff);
+    assert(CalculateNextWorkRequired(0x1e00ffff, 1000, 1200, 20, params) == 0x1e00ffff);
+    assert(CalculateNextWorkRequired(0x1e00ffff, 1000, 1100, 20, params) == (old >> 1).GetCompact());
+    assert(CalculateNextWorkRequired(0x1e00ffff, 1000, 1000, 20, params) == (old >> 2).GetCompact());
+    assert(CalculateNextWorkRequired(0x1e00ffff, 1000, 999999, 20, params) == (old << 2).GetCompact());
+    assert(CalculateNextWorkRequired(0x1f00ffff, 1000, 999999, 20, params) == 0x1f00ffff);
+    std::cout << "Proof of Work Test Passed!" << std::endl;
+}
+
 int main() {
     TestMining();
+    TestParallelMining();
+    TestBlockSerialization();
+    TestProofOfWork();
     return 0;
 }
\ No newline at end of file
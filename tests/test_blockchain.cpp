@@ -1,12 +1,68 @@
+#include "../src/Core/BlockImport.h"
 #include "../src/Core/Blockchain.h"
+#include "../src/Core/BlockStore.h"
+#include "../src/Core/Mempool.h"
+#include "../src/Core/Merkle.h"
+#include "../src/Core/SigCache.h"
+#include "../src/Core/SignatureCheck.h"
+#include "../src/Core/WorkUnit.h"
+#include "../src/Utils/Metrics.h"
 #include "../src/Wallet/Wallet.h"
 #include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// õĹ̶Ѷȣϣ 0000 ͷƽԼ 65536 
+static const uint32_t TEST_BITS = 0x1f00ffff;
+
+// ָǰһһ鲢ڳ
+// time Դ (ʱλ)
+Block MineBlockOn(const uint256& prev, const std::vector<Transaction>& txs, uint32_t time) {
+    Block block(1, prev, uint256(), GENESIS_TIMESTAMP + time, TEST_BITS);
+    for (const auto& tx : txs) block.AddTransaction(tx);
+    block.FinalizeAndMine();
+    return block;
+}
+
+// ڵǰβһ鲢ڳ
+Block MineBlock(const Blockchain& chain, const std::vector<Transaction>& txs, uint32_t time) {
+    return MineBlockOn(chain.GetTip()->hash, txs, time);
+}
+
+// ǮԿ׵ǩ
+void SignInputs(Transaction& tx, const Wallet& wallet) {
+    for (auto& in : tx.inputs) in.publicKey = wallet.GetPublicKey();
+    uint256 sighash = tx.GetSignatureHash();
+    for (auto& in : tx.inputs) in.signature = wallet.Sign(sighash);
+}
+
+// AddBlock Ƿ׳쳣 (鱻ܾ)
+bool IsRejected(Blockchain& chain, const Block& block) {
+    try {
+        chain.AddBlock(block);
+    }
+    catch (const std::exception& e) {
+        std::cout << "Rejected as expected: " << e.what() << std::endl;
+        return true;
+    }
+    return false;
+}
 
 void TestFullFlow() {
     std::cout << "=== Bitcoin System Starting ===" << std::endl;
 
     // 1. ʼ (ѶΪ 2ڿ)
-    Blockchain myChain(2);
+    Blockchain myChain(TEST_BITS);
 
     // 2. ģû
     Wallet alice, bob;
@@ -14,18 +70,23 @@ void TestFullFlow() {
     bob.GenerateNewKey();
     std::cout << "Alice Addr: " << alice.GetAddress() << std::endl;
 
+    // Alice һ飬õ coinbase 
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    myChain.AddBlock(MineBlock(myChain, { reward }, 20231000));
+
     // 3. һʽ: Alice -> Bob
     TxIn input;
-    input.prevTxId = Bytes(32, 0xFF); // ģ֮ǰǮ
+    input.prevTxId = reward.GetId(); //  Alice ڿ
     input.prevIndex = 0;
     input.publicKey = alice.GetPublicKey();
 
     Transaction tx1;
     tx1.inputs.push_back(input);
     tx1.outputs.push_back({ 100, bob.GetAddress() }); // ת 100 Satoshi
+    tx1.outputs.push_back({ GetBlockSubsidy(1) - 1000, alice.GetAddress() }); // 㣬ʣ 900 
 
-    // ǩ ()
-    tx1.inputs[0].signature = alice.Sign(tx1.GetId());
+    // ǩ (ǩϣǩǩ)
+    tx1.inputs[0].signature = alice.Sign(tx1.GetSignatureHash());
 
     // 4. 󹤴
     std::cout << "\n[Miner] Packing block..." << std::endl;
@@ -35,28 +96,1240 @@ void TestFullFlow() {
 
     // 
     // ע⣺MerkleRoot ʱգԺ Finalize Զ
-    Block newBlock(1, prevBlock.GetHash(), Bytes(32, 0), 20231001, 2);
+    Block newBlock(1, prevBlock.GetHash(), uint256(), prevBlock.timestamp + 1, TEST_BITS);
 
     // 뽻
     newBlock.AddTransaction(tx1);
 
     // 5. ڿ ( Merkle Root + PoW)
-    newBlock.FinalizeAndMine(2);
+    newBlock.FinalizeAndMine();
 
     // 6. 㲥
     std::cout << "\n[Network] Broadcasting block..." << std::endl;
+    bool added = false;
     try {
         myChain.AddBlock(newBlock);
+        added = true;
         std::cout << "SUCCESS: Block added to main chain!" << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "FAILED: " << e.what() << std::endl;
     }
+    assert(added);
 
     myChain.PrintChain();
 }
 
+void TestUtxoRules() {
+    std::cout << "\n=== UTXO Validation ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    chain.AddBlock(MineBlock(chain, { reward }, 1000));
+    OutPoint coin(reward.GetId(), 0);
+    assert(chain.GetUtxoSet().Contains(coin));
+
+    // Alice ѽȫת Bob
+    Transaction pay;
+    TxIn in;
+    in.prevTxId = reward.GetId();
+    in.prevIndex = 0;
+    pay.inputs.push_back(in);
+    pay.outputs.push_back({ GetBlockSubsidy(1), bob.GetAddress() });
+    SignInputs(pay, alice);
+
+    // 1. 
+    Transaction overspend = pay;
+    overspend.outputs[0].value += 1;
+    assert(IsRejected(chain, MineBlock(chain, { overspend }, 1001)));
+
+    // 2. òڵ
+    Transaction missing = pay;
+    missing.inputs[0].prevIndex = 7;
+    assert(IsRejected(chain, MineBlock(chain, { missing }, 1002)));
+
+    // 3. ͬһ˫ڶʧʱһʵ޸Ҳع
+    Transaction pay2 = pay;
+    pay2.outputs[0].pubKeyHash = alice.GetPubKeyHash();
+    SignInputs(pay2, alice);
+    assert(IsRejected(chain, MineBlock(chain, { pay, pay2 }, 1003)));
+    assert(chain.GetUtxoSet().Contains(coin));
+    assert(chain.GetHeight() == 1);
+
+    // 4. coinbase ܳ
+    Transaction greedy = MakeCoinbase(2, bob.GetAddress(), GetBlockSubsidy(2) + 1);
+    assert(IsRejected(chain, MineBlock(chain, { greedy }, 1004)));
+
+    // 5. ѣ֮ٻͬһ˫
+    size_t before = chain.GetUtxoSet().Size();
+    chain.AddBlock(MineBlock(chain, { pay }, 1005));
+    assert(!chain.GetUtxoSet().Contains(coin));
+    assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    assert(IsRejected(chain, MineBlock(chain, { pay2 }, 1006)));
+
+    // 6. Ͽ飺Bob ʧAlice ıһָ
+    chain.DisconnectTip();
+    assert(chain.GetHeight() == 1);
+    assert(chain.GetUtxoSet().Contains(coin));
+    assert(!chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    assert(chain.GetUtxoSet().Size() == before);
+
+    std::cout << "UTXO Validation Test Passed!" << std::endl;
+}
+
+void TestSignatures() {
+    std::cout << "\n=== Signature Validation ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    chain.SetVerificationThreads(4);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    // Alice ڵ 64 
+    const uint32_t PARTS = 64;
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    Transaction split;
+    split.inputs.push_back({ reward.GetId(), 0, {}, {} });
+    for (uint32_t i = 0; i < PARTS; i++) split.outputs.push_back({ GetBlockSubsidy(1) / PARTS, alice.GetAddress() });
+    SignInputs(split, alice);
+    chain.AddBlock(MineBlock(chain, { reward, split }, 2000));
+    assert(chain.GetUtxoSet().Size() == PARTS); // coinbase ͬһڻ
+
+    // 64 ʽ׸һݸ Bob
+    std::vector<Transaction> pays;
+    for (uint32_t i = 0; i < PARTS; i++) {
+        Transaction tx;
+        tx.inputs.push_back({ split.GetId(), i, {}, {} });
+        tx.outputs.push_back({ GetBlockSubsidy(1) / PARTS, bob.GetAddress() });
+        SignInputs(tx, alice);
+        pays.push_back(tx);
+    }
+
+    // 1. Bob ԼԿǩ Alice ıңԿַԲ
+    std::vector<Transaction> stolen = pays;
+    SignInputs(stolen[10], bob);
+    assert(IsRejected(chain, MineBlock(chain, stolen, 2001)));
+
+    // 2. ۸мһʽ׵ǩ̺߳Ͷ̶߳Ҫܾ UTXO 
+    std::vector<Transaction> forged = pays;
+    forged[37].inputs[0].signature.back() ^= 0x01;
+    Block forgedBlock = MineBlock(chain, forged, 2002);
+    for (unsigned threads : { 1u, 4u }) {
+        chain.SetVerificationThreads(threads);
+        assert(IsRejected(chain, forgedBlock));
+        assert(chain.GetHeight() == 1);
+        assert(chain.GetUtxoSet().Contains(OutPoint(split.GetId(), 37)));
+    }
+
+    // 3. ǩٸǩϣˣǩʧЧ
+    std::vector<Transaction> tampered = pays;
+    tampered[5].outputs[0].value -= 1;
+    assert(IsRejected(chain, MineBlock(chain, tampered, 2003)));
+
+    // 4. ȫϷ
+    chain.SetVerificationThreads(0);
+    chain.AddBlock(MineBlock(chain, pays, 2004));
+    assert(chain.GetHeight() == 2);
+    assert(!chain.GetUtxoSet().Contains(OutPoint(split.GetId(), 0)));
+    std::cout << "Signature Validation Test Passed!" << std::endl;
+}
+
+void TestSignatureCache() {
+    std::cout << "\n=== Signature Cache ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    SigCache cache;
+    chain.SetSignatureCache(&cache);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    const uint32_t PARTS = 8;
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    Transaction split;
+    split.inputs.push_back({ reward.GetId(), 0, {}, {} });
+    for (uint32_t i = 0; i < PARTS; i++) split.outputs.push_back({ GetBlockSubsidy(1) / PARTS, alice.GetAddress() });
+    SignInputs(split, alice);
+    chain.AddBlock(MineBlock(chain, { reward, split }, 3000));
+    // AddBlock ֻѯд
+    assert(cache.Misses() == 1 && cache.Hits() == 0 && cache.Size() == 0);
+
+    // 1. ׽ڴʱ֤һΣǩд뻺
+    std::vector<Transaction> pays;
+    for (uint32_t i = 0; i < PARTS; i++) {
+        Transaction tx;
+        tx.inputs.push_back({ split.GetId(), i, {}, {} });
+        tx.outputs.push_back({ GetBlockSubsidy(1) / PARTS, bob.GetAddress() });
+        SignInputs(tx, alice);
+        assert(CheckTransactionSignatures(tx, &cache));
+        pays.push_back(tx);
+    }
+    assert(cache.Size() == PARTS);
+
+    // 2. ۸Ĺǩ֤ʧܣ
+    Transaction forged = pays[3];
+    forged.inputs[0].signature.back() ^= 0x01;
+    assert(!CheckTransactionSignatures(forged, &cache));
+    assert(cache.Size() == PARTS);
+
+    // 3. ͬĽ׳ȫл
+    uint64_t hits = cache.Hits();
+    chain.AddBlock(MineBlock(chain, pays, 3001));
+    assert(cache.Hits() == hits + PARTS);
+
+    // 4. л治 UTXO 飺Alice ǩЧѻ棬 Bob ı
+    Transaction theft;
+    theft.inputs.push_back({ pays[0].GetId(), 0, {}, {} });
+    theft.outputs.push_back({ GetBlockSubsidy(1) / PARTS, alice.GetAddress() });
+    SignInputs(theft, alice);
+    assert(CheckTransactionSignatures(theft, &cache));
+    assert(IsRejected(chain, MineBlock(chain, { theft }, 3002)));
+
+    // 5. ޣ˳̭
+    SigCache small(4);
+    uint256 sighash = pays[0].GetSignatureHash();
+    for (uint8_t i = 0; i < 6; i++) small.Insert(sighash, pays[0].inputs[0].publicKey, Bytes(1, i));
+    assert(small.Size() == 4);
+    assert(!small.Contains(sighash, pays[0].inputs[0].publicKey, Bytes(1, 0)));
+    assert(small.Contains(sighash, pays[0].inputs[0].publicKey, Bytes(1, 5)));
+    std::cout << "Signature Cache Test Passed!" << std::endl;
+}
+
+void TestReorg() {
+    std::cout << "\n=== Block Index & Reorg ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+    uint256 genesis = chain.GetTip()->hash;
+
+    //  AAlice ڵ߶ 1
+    Transaction a1Reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    Block a1 = MineBlockOn(genesis, { a1Reward }, 4000);
+    chain.AddBlock(a1);
+    const BlockIndex* a1Index = chain.LookupBlock(a1.GetHash());
+    assert(a1Index && a1Index->height == 1 && chain.GetTip() == a1Index);
+    assert(chain.GetBlockAtHeight(1) == a1Index && chain.GetBlockAtHeight(2) == nullptr);
+
+    // 1. ֲ B ֻͬ
+    Transaction b1Reward = MakeCoinbase(1, bob.GetAddress(), GetBlockSubsidy(1));
+    Block b1 = MineBlockOn(genesis, { b1Reward }, 4100);
+    chain.AddBlock(b1);
+    const BlockIndex* b1Index = chain.LookupBlock(b1.GetHash());
+    assert(b1Index && !chain.IsInMainChain(b1Index));
+    assert(chain.GetTip() == a1Index && chain.GetBlockIndexSize() == 3);
+    assert(IsRejected(chain, b1)); // ظ
+
+    // 2. ֲ B 飬Alice ĽBob ĽЧ
+    Block b2 = MineBlockOn(b1.GetHash(), { MakeCoinbase(2, bob.GetAddress(), GetBlockSubsidy(2)) }, 4101);
+    chain.AddBlock(b2);
+    assert(chain.GetHeight() == 2 && chain.GetTip()->hash == b2.GetHash());
+    assert(chain.IsInMainChain(b1Index) && !chain.IsInMainChain(a1Index));
+    assert(chain.GetTip()->chainWork > a1Index->chainWork);
+    assert(!chain.GetUtxoSet().Contains(OutPoint(a1Reward.GetId(), 0)));
+    assert(chain.GetUtxoSet().Contains(OutPoint(b1Reward.GetId(), 0)));
+
+    // 3. ֲ A ׷ϲA ϵĽ׻ Alice Ľ
+    Transaction pay;
+    pay.inputs.push_back({ a1Reward.GetId(), 0, {}, {} });
+    pay.outputs.push_back({ GetBlockSubsidy(1), bob.GetAddress() });
+    SignInputs(pay, alice);
+    Block a2 = MineBlockOn(a1.GetHash(), { MakeCoinbase(2, alice.GetAddress(), GetBlockSubsidy(2)), pay }, 4001);
+    Block a3 = MineBlockOn(a2.GetHash(), { MakeCoinbase(3, alice.GetAddress(), GetBlockSubsidy(3)) }, 4002);
+    chain.AddBlock(a2);
+    assert(chain.GetTip()->hash == b2.GetHash());
+    chain.AddBlock(a3);
+    assert(chain.GetHeight() == 3 && chain.GetTip()->hash == a3.GetHash());
+    assert(chain.IsInMainChain(a1Index) && !chain.IsInMainChain(b1Index));
+    assert(!chain.GetUtxoSet().Contains(OutPoint(b1Reward.GetId(), 0)));
+    assert(!chain.GetUtxoSet().Contains(OutPoint(a1Reward.GetId(), 0)));
+    assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    size_t utxoBefore = chain.GetUtxoSet().Size();
+
+    // 4. ֲ C мһ coinbaseʧܣ UTXO ָԭ
+    Block c1 = MineBlockOn(genesis, { MakeCoinbase(1, bob.GetAddress(), GetBlockSubsidy(1)) }, 4200);
+    Block c2 = MineBlockOn(c1.GetHash(), { MakeCoinbase(2, bob.GetAddress(), GetBlockSubsidy(2) + 1) }, 4201);
+    Block c3 = MineBlockOn(c2.GetHash(), { MakeCoinbase(3, bob.GetAddress(), GetBlockSubsidy(3)) }, 4202);
+    Block c4 = MineBlockOn(c3.GetHash(), { MakeCoinbase(4, bob.GetAddress(), GetBlockSubsidy(4)) }, 4203);
+    chain.AddBlock(c1);
+    chain.AddBlock(c2);
+    chain.AddBlock(c3);
+    assert(IsRejected(chain, c4));
+    assert(chain.GetTip()->hash == a3.GetHash());
+    assert(chain.GetUtxoSet().Size() == utxoBefore);
+    assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    assert(chain.LookupBlock(c2.GetHash())->failed);
+    assert(chain.LookupBlock(c4.GetHash()) == nullptr);
+    // ЧֱӾܾ
+    assert(IsRejected(chain, MineBlockOn(c3.GetHash(), {}, 4204)));
+    // δ֪
+    assert(IsRejected(chain, MineBlockOn(c4.GetHash(), {}, 4205)));
+
+    chain.PrintChain();
+    std::cout << "Block Index & Reorg Test Passed!" << std::endl;
+}
+
+// õĿĿ¼
+std::string FreshDataDir(const std::string& name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
+
+void TestBlockStore() {
+    std::cout << "\n=== Block Store ===" << std::endl;
+    std::string dir = FreshDataDir("mybitcoin_test_blockstore");
+
+    // 1. ļ 1 KBдļдһ
+    std::vector<Block> blocks;
+    std::vector<BlockFilePos> positions;
+    BlockFilePos retried;
+    {
+        BlockStore store(dir, 1024);
+        uint256 prev;
+        for (uint32_t i = 0; i < 20; i++) {
+            Block b(1, prev, uint256(), 5000 + i, TEST_BITS);
+            b.AddTransaction(MakeCoinbase(i, Hash160(ToBytes("addr" + std::to_string(i))), 50));
+            b.merkleRoot = b.GetMerkleRoot();
+            positions.push_back(store.WriteBlock(b, b.GetHash()));
+            blocks.push_back(b);
+            prev = b.GetHash();
+        }
+        assert(store.FileCount() > 1);
+        for (size_t i = 0; i < blocks.size(); i++) {
+            Block back = store.ReadBlock(positions[i]);
+            assert(back.GetHash() == blocks[i].GetHash());
+            assert(back.transactions.size() == 1);
+            assert(back.transactions[0].GetId() == blocks[i].transactions[0].GetId());
+            // ֱӳڴ϶ȡ Block
+            BlockView view = store.ReadBlockView(positions[i]);
+            assert(view.GetHash() == blocks[i].GetHash() && view.ComputeMerkleRoot() == blocks[i].merkleRoot);
+        }
+        BlockUndo undo;
+        undo.spent.push_back({ OutPoint(blocks[3].transactions[0].GetId(), 0), Coin{ { 50, Hash160(ToBytes("addr3")) }, 3, true } });
+        BlockFilePos undoPos = store.WriteUndo(blocks[4].GetHash(), undo);
+        BlockUndo undoBack = store.ReadUndo(undoPos);
+        assert(undoBack.spent.size() == 1 && undoBack.spent[0].second.out.pubKeyHash == Hash160(ToBytes("addr3")));
+        store.MarkFailed(blocks[19].GetHash());
+    }
+
+    // 2. ļĩβһдһļ¼ (ģ)֮ǰ
+    {
+        std::FILE* f = std::fopen((std::filesystem::path(dir) / "index.dat").string().c_str(), "ab");
+        std::fputc('B', f);
+        std::fputc(0x42, f);
+        std::fclose(f);
+    }
+    {
+        BlockStore store(dir, 1024);
+        const auto& index = store.LoadedIndex();
+        assert(index.size() == blocks.size());
+        for (size_t i = 0; i < blocks.size(); i++) {
+            assert(index[i].hash == blocks[i].GetHash());
+            assert(index[i].header.GetHash() == blocks[i].GetHash());
+        }
+        assert(!index[4].undoPos.IsNull() && index[3].undoPos.IsNull());
+        assert(index[19].failed && !index[18].failed);
+        // ׷
+        Block extra(1, blocks.back().GetHash(), uint256(), 6000, TEST_BITS);
+        assert(store.ReadBlock(store.WriteBlock(extra, extra.GetHash())).GetHash() == extra.GetHash());
+        // Ч֤дһ
+        retried = store.WriteBlock(blocks[19], blocks[19].GetHash());
+    }
+
+    // 3. ͬһдļ¼ȡǰЧļ¼λò
+    {
+        BlockStore store(dir, 1024);
+        const auto& index = store.LoadedIndex();
+        assert(index.size() == blocks.size() + 1);
+        assert(index[19].hash == blocks[19].GetHash() && !index[19].failed);
+        assert(index[19].blockPos.file == retried.file && index[19].blockPos.offset == retried.offset);
+        assert(index[20].header.prevBlockHash == blocks[19].GetHash());
+    }
+
+#ifdef __linux__
+    // 4. ׷ٶдݣÿζҪӳ䣬滻ľӳһдʱӳд
+    {
+        BlockStore store(dir, 1 << 20);
+        for (size_t i = 0; i < 200; i++) {
+            const Block& b = blocks[i % blocks.size()];
+            assert(store.ReadBlock(store.WriteBlock(b, b.GetHash())).GetHash() == b.GetHash());
+        }
+        std::ifstream processMaps("/proc/self/maps");
+        std::string line;
+        size_t mappings = 0;
+        while (std::getline(processMaps, line)) {
+            if (line.find(dir) != std::string::npos) mappings++;
+        }
+        assert(mappings >= 1 && mappings <= store.FileCount() + 1);
+    }
+#endif
+    std::filesystem::remove_all(dir);
+    std::cout << "Block Store Test Passed!" << std::endl;
+}
+
+void TestPersistentChain() {
+    std::cout << "\n=== Persistent Chain ===" << std::endl;
+    std::string dir = FreshDataDir("mybitcoin_test_chain");
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    uint256 genesis, tip, side;
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    Transaction pay;
+    pay.inputs.push_back({ reward.GetId(), 0, {}, {} });
+    pay.outputs.push_back({ GetBlockSubsidy(1), bob.GetAddress() });
+    SignInputs(pay, alice);
+    size_t utxoSize;
+    {
+        Blockchain chain(TEST_BITS, dir);
+        genesis = chain.GetTip()->hash;
+        chain.AddBlock(MineBlock(chain, { reward }, 7000));
+        Block sideBlock = MineBlockOn(genesis, { MakeCoinbase(1, bob.GetAddress(), GetBlockSubsidy(1)) }, 7100);
+        chain.AddBlock(sideBlock);
+        side = sideBlock.GetHash();
+        chain.AddBlock(MineBlock(chain, { MakeCoinbase(2, alice.GetAddress(), GetBlockSubsidy(2)), pay }, 7001));
+        tip = chain.GetTip()->hash;
+        utxoSize = chain.GetUtxoSet().Size();
+    } // ʱ UTXO 
+
+    // 1. ڴ飬ֲ UTXO ȫָ
+    {
+        Blockchain chain(TEST_BITS, dir);
+        assert(chain.GetTip()->hash == tip && chain.GetHeight() == 2);
+        assert(chain.GetBlockAtHeight(0)->hash == genesis);
+        assert(chain.GetBlockIndexSize() == 4);
+        assert(chain.LookupBlock(side) && !chain.IsInMainChain(chain.LookupBlock(side)));
+        assert(chain.GetUtxoSet().Size() == utxoSize);
+        assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+        // 鱾尴ӳļ
+        assert(chain.GetLatestBlock().transactions.size() == 2);
+        assert(chain.GetLatestBlock().transactions[1].GetId() == pay.GetId());
+
+        // ԼϿ (ڴ) 
+        chain.DisconnectTip();
+        assert(chain.GetUtxoSet().Contains(OutPoint(reward.GetId(), 0)));
+        chain.AddBlock(MineBlock(chain, { MakeCoinbase(2, bob.GetAddress(), GetBlockSubsidy(2)), pay }, 7002));
+        tip = chain.GetTip()->hash;
+        chain.AddBlock(MineBlock(chain, { MakeCoinbase(3, bob.GetAddress(), GetBlockSubsidy(3)) }, 7003));
+        tip = chain.GetTip()->hash;
+        utxoSize = chain.GetUtxoSet().Size();
+
+        // ֻͷ (ռ)бļ
+        for (uint32_t h = 0; h <= chain.GetHeight(); h++) {
+            assert(chain.GetBlockAtHeight(h)->block.transactions.empty());
+        }
+        assert(chain.LookupBlock(side)->block.transactions.empty());
+        assert(chain.GetBlockData(chain.GetBlockAtHeight(2)).transactions[1].GetId() == pay.GetId());
+        assert(chain.GetBlockBytes(chain.GetTip()) == chain.GetLatestBlock().Serialize());
+    }
+
+    // 2. ûп (ϴû˳)ļطţһ
+    std::filesystem::remove(std::filesystem::path(dir) / "chainstate.dat");
+    {
+        Blockchain chain(TEST_BITS, dir);
+        assert(chain.GetTip()->hash == tip && chain.GetHeight() == 3);
+        assert(chain.GetUtxoSet().Size() == utxoSize);
+        assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    }
+
+    // 3.  UTXO  (󡢳˷)ûпգļط
+    for (uint64_t badCount : { UINT64_MAX, (uint64_t)1 << 61, (uint64_t)utxoSize + 1 }) {
+        {
+            std::fstream snapshot((std::filesystem::path(dir) / "chainstate.dat").string(),
+                                  std::ios::in | std::ios::out | std::ios::binary);
+            snapshot.seekp(4 + 32);
+            for (int i = 0; i < 8; i++) snapshot.put(static_cast<char>(badCount >> (8 * i)));
+        }
+        Blockchain chain(TEST_BITS, dir);
+        assert(chain.GetTip()->hash == tip && chain.GetHeight() == 3);
+        assert(chain.GetUtxoSet().Size() == utxoSize);
+    }
+    std::filesystem::remove_all(dir);
+    std::cout << "Persistent Chain Test Passed!" << std::endl;
+}
+
+void TestUtxoTable() {
+    // /ɾݺĹ
+    UtxoSet set(16);
+    std::vector<OutPoint> points;
+    for (uint32_t i = 0; i < 20000; i++) {
+        points.emplace_back(Hash256(ToBytes("tx" + std::to_string(i / 4))), i % 4);
+        Coin c;
+        c.out.value = i;
+        assert(set.Add(points.back(), c));
+    }
+    assert(set.Size() == 20000);
+    assert(!set.Add(points[123], Coin())); // ظ
+
+    for (uint32_t i = 0; i < 20000; i += 2) {
+        Coin spent;
+        assert(set.Spend(points[i], &spent));
+        assert(spent.out.value == i);
+    }
+    for (uint32_t i = 0; i < 20000; i++) {
+        const Coin* c = set.Get(points[i]);
+        assert((c != nullptr) == (i % 2 == 1));
+        if (c) assert(c->out.value == i);
+    }
+    assert(!set.Spend(points[0]));
+    assert(set.Size() == 10000);
+    std::cout << "UTXO Table Test Passed!" << std::endl;
+}
+
+//  prev ĵ index  value  to ()
+Transaction SpendOutput(const uint256& prev, uint32_t index, int64_t value, const Wallet& from, const std::string& to) {
+    Transaction tx;
+    tx.inputs.push_back({ prev, index, {}, {} });
+    tx.outputs.push_back({ value, to });
+    SignInputs(tx, from);
+    return tx;
+}
+
+void TestMempool() {
+    std::cout << "\n=== Mempool ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    Mempool pool(chain);
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    chain.AddBlock(MineBlock(chain, { reward }, 4000));
+
+    // 1.  4  10 BTC  1000
+    Transaction split;
+    split.inputs.push_back({ reward.GetId(), 0, {}, {} });
+    for (int i = 0; i < 4; i++) split.outputs.push_back({ 10 * COIN, alice.GetAddress() });
+    split.outputs.push_back({ GetBlockSubsidy(1) - 40 * COIN - 1000, alice.GetAddress() });
+    SignInputs(split, alice);
+    pool.AddTransaction(split);
+    assert(pool.Size() == 1 && pool.Get(split.GetId())->fee == 1000);
+    assert(pool.Get(split.GetId())->tx.IsFrozen());
+    assert(pool.GetSpender(OutPoint(reward.GetId(), 0))->txid == split.GetId());
+
+    // 2. ϷĽױܾز䣺ظ˫ڵǩ
+    auto rejected = [&](const Transaction& tx) {
+        try {
+            pool.AddTransaction(tx);
+        }
+        catch (const std::exception& e) {
+            std::cout << "Rejected as expected: " << e.what() << std::endl;
+            return true;
+        }
+        return false;
+    };
+    assert(rejected(split));
+    assert(rejected(SpendOutput(reward.GetId(), 0, COIN, alice, bob.GetAddress())));
+    assert(rejected(SpendOutput(split.GetId(), 9, COIN, alice, bob.GetAddress())));
+    assert(rejected(SpendOutput(split.GetId(), 0, 11 * COIN, alice, bob.GetAddress())));
+    Transaction forged = SpendOutput(split.GetId(), 0, COIN, alice, bob.GetAddress());
+    forged.inputs[0].signature.back() ^= 0x01;
+    assert(rejected(forged));
+    assert(pool.Size() == 1);
+
+    // 3.  / ͳƣlow Ѻܵͣӽ child Ѻܸ (Ϊ)
+    Transaction low = SpendOutput(split.GetId(), 0, 10 * COIN - 100, alice, alice.GetAddress());
+    Transaction high = SpendOutput(split.GetId(), 1, 10 * COIN - 50000, alice, bob.GetAddress());
+    pool.AddTransaction(low);
+    pool.AddTransaction(high);
+    Transaction child = SpendOutput(low.GetId(), 0, 10 * COIN - 100 - 100000, alice, bob.GetAddress());
+    pool.AddTransaction(child);
+    const MempoolEntry* root = pool.Get(split.GetId());
+    const MempoolEntry* c = pool.Get(child.GetId());
+    assert(root->descendantCount == 4 && root->descendantFee == 1000 + 100 + 50000 + 100000);
+    assert(c->ancestorCount == 3 && c->ancestorFee == 1000 + 100 + 100000);
+    assert(c->ancestorSize == root->size + pool.Get(low.GetId())->size + c->size);
+
+    // 4. ֻŵһΪѵİ (split + low + child) ߣ high ѡ
+    size_t chainSize = BLOCK_RESERVED_SIZE + c->ancestorSize;
+    Block small = pool.BuildBlockTemplate(alice.GetAddress(), GENESIS_TIMESTAMP + 4001, chainSize);
+    assert(small.transactions.size() == 4);
+    assert(small.transactions[1].GetId() == split.GetId());
+    assert(small.transactions[2].GetId() == low.GetId());
+    assert(small.transactions[3].GetId() == child.GetId());
+    assert(small.transactions[0].outputs[0].value == GetBlockSubsidy(2) + c->ancestorFee);
+
+    // 5. ģ壺ȫףǰڳܱ
+    Block full = pool.BuildBlockTemplate(alice.GetAddress(), GENESIS_TIMESTAMP + 4001);
+    assert(full.transactions.size() == 5);
+    assert(full.transactions[1].GetId() == split.GetId());
+    assert(full.transactions[0].outputs[0].value == GetBlockSubsidy(2) + root->descendantFee);
+    assert(full.merkleRoot == full.GetMerkleRoot() && full.prevBlockHash == chain.GetTip()->hash);
+    // û仯ʱѡȡֻ coinbase
+    Block again = pool.BuildBlockTemplate(bob.GetAddress(), GENESIS_TIMESTAMP + 4001);
+    assert(again.transactions.size() == 5 && again.merkleRoot == ComputeMerkleRoot(again.transactions));
+    assert(again.transactions[0].outputs[0].pubKeyHash == bob.GetPubKeyHash());
+
+    // ½׷ŵ£ֱ׷ӵģĩβĬ˶һ
+    Transaction extra = SpendOutput(split.GetId(), 2, 10 * COIN - 2000, alice, bob.GetAddress());
+    pool.AddTransaction(extra);
+    Block extended = pool.BuildBlockTemplate(alice.GetAddress(), GENESIS_TIMESTAMP + 4001);
+    assert(extended.transactions.size() == 6 && extended.transactions[5].GetId() == extra.GetId());
+    assert(extended.merkleRoot == ComputeMerkleRoot(extended.transactions));
+    assert(extended.transactions[0].outputs[0].value == GetBlockSubsidy(2) + root->descendantFee);
+
+    // 6. ֻ split⻹˳ high 룺split Ƴhigh ΪͻƳ
+    //    lowchild  extra £ͳȥ split
+    Transaction conflict = SpendOutput(split.GetId(), 1, 10 * COIN - 1, alice, alice.GetAddress());
+    Block mined = MineBlock(chain, { MakeCoinbase(2, alice.GetAddress(), GetBlockSubsidy(2)), split, conflict }, 4002);
+    chain.AddBlock(mined);
+    pool.RemoveForBlock(mined);
+    assert(pool.Size() == 3 && !pool.Contains(split.GetId()) && !pool.Contains(high.GetId()));
+    assert(pool.Get(child.GetId())->ancestorCount == 2);
+    assert(pool.Get(low.GetId())->parents.empty());
+    assert(pool.GetSpender(OutPoint(split.GetId(), 1)) == nullptr);
+
+    Block next = pool.BuildBlockTemplate(bob.GetAddress(), GENESIS_TIMESTAMP + 4003);
+    assert(next.transactions.size() == 4);
+    next.Mine();
+    chain.AddBlock(next);
+    pool.RemoveForBlock(next);
+    assert(pool.Size() == 0 && pool.TotalSize() == 0);
+
+    // 7. ʱ̭͵ (ͬ)
+    Transaction cheap = SpendOutput(split.GetId(), 4, split.outputs[4].value - 10, alice, bob.GetAddress());
+    Transaction rich = SpendOutput(split.GetId(), 3, 10 * COIN - 90000, alice, bob.GetAddress());
+    pool.AddTransaction(cheap);
+    pool.AddTransaction(rich);
+    pool.TrimToSize(pool.Get(rich.GetId())->size);
+    assert(pool.Size() == 1 && pool.Contains(rich.GetId()));
+    pool.Remove(rich.GetId());
+    assert(pool.Size() == 0 && pool.TotalSize() == 0);
+
+    // 8. ʱ£ÿμ / Ƴ֮ģ嶼³ؽĽͬ
+    Transaction fan;
+    fan.inputs.push_back({ split.GetId(), 3, {}, {} });
+    for (int i = 0; i < 40; i++) fan.outputs.push_back({ COIN / 4, alice.GetAddress() });
+    SignInputs(fan, alice);
+    chain.AddBlock(MineBlock(chain, { fan }, 4004));
+
+    std::vector<Transaction> added;
+    size_t txSize = SpendOutput(fan.GetId(), 0, COIN / 4, alice, bob.GetAddress()).GetSerializeSize();
+    size_t limit = BLOCK_RESERVED_SIZE + 8 * txSize;
+    auto checkTemplate = [&]() {
+        Block incremental = pool.BuildBlockTemplate(alice.GetAddress(), GENESIS_TIMESTAMP + 4005, limit);
+        Mempool fresh(chain);
+        for (const auto& tx : added) {
+            if (pool.Contains(tx.GetId())) fresh.AddTransaction(tx);
+        }
+        Block rebuilt = fresh.BuildBlockTemplate(alice.GetAddress(), GENESIS_TIMESTAMP + 4005, limit);
+        assert(incremental.transactions.size() == rebuilt.transactions.size());
+        assert(incremental.transactions[0].GetId() == rebuilt.transactions[0].GetId()); // ͬ
+        std::vector<uint256> a, b;
+        for (size_t i = 1; i < incremental.transactions.size(); i++) {
+            a.push_back(incremental.transactions[i].GetId());
+            b.push_back(rebuilt.transactions[i].GetId());
+        }
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        assert(a == b);
+        assert(incremental.merkleRoot == ComputeMerkleRoot(incremental.transactions));
+    };
+    for (uint32_t i = 0; i < 40; i++) {
+        // Ѹߵͽÿټһʻӽ
+        int64_t fee = 1000 + (i * 7919) % 37 * 500;
+        Transaction tx = SpendOutput(fan.GetId(), i, COIN / 4 - fee, alice, alice.GetAddress());
+        pool.AddTransaction(tx);
+        added.push_back(tx);
+        checkTemplate();
+        if (i % 5 == 4) {
+            Transaction kid = SpendOutput(tx.GetId(), 0, COIN / 4 - fee - 3000 * (i % 3), alice, bob.GetAddress());
+            pool.AddTransaction(kid);
+            added.push_back(kid);
+            checkTemplate();
+        }
+        if (i % 7 == 6) {
+            pool.Remove(added[added.size() / 2].GetId());
+            checkTemplate();
+        }
+    }
+
+    // 9. ʱͷʵӽףĸڵİȱ̭޸ĳ֮ǰ;ܾرֲ䣻
+    //    ߷ʵӽ׼İ
+    {
+        Transaction parent = SpendOutput(fan.GetId(), 0, COIN / 4 - 100, alice, alice.GetAddress());
+        Transaction other = SpendOutput(fan.GetId(), 1, COIN / 4 - 5000, alice, alice.GetAddress());
+        size_t capacity = parent.GetSerializeSize() + other.GetSerializeSize() + 10;
+        Mempool small(chain, capacity);
+        small.AddTransaction(parent);
+        small.AddTransaction(other);
+        size_t before = small.TotalSize();
+        uint64_t sequence = small.GetSequence();
+
+        Transaction cheapChild = SpendOutput(parent.GetId(), 0, COIN / 4 - 100 - 3000, alice, bob.GetAddress());
+        std::string reason;
+        try {
+            small.AddTransaction(cheapChild);
+        }
+        catch (const std::exception& e) {
+            reason = e.what();
+        }
+        assert(reason.find("pool full") != std::string::npos);
+        assert(small.Size() == 2 && small.Contains(parent.GetId()) && small.Contains(other.GetId()));
+        assert(small.TotalSize() == before && small.GetSequence() == sequence);
+        assert(small.Get(parent.GetId())->descendantCount == 1);
+
+        Transaction richChild = SpendOutput(parent.GetId(), 0, COIN / 4 - 100 - 50000, alice, bob.GetAddress());
+        small.AddTransaction(richChild);
+        assert(small.Size() == 2 && small.Contains(parent.GetId()) && small.Contains(richChild.GetId()));
+        assert(!small.Contains(other.GetId()) && small.TotalSize() <= capacity);
+    }
+    std::cout << "Mempool Test Passed!" << std::endl;
+}
+
+void TestMetrics() {
+#if MYBITCOIN_METRICS
+    std::cout << "\n=== Metrics ===" << std::endl;
+    MetricsRegistry& metrics = MetricsRegistry::Shared();
+    MetricCounter& hashes = metrics.GetCounter("mybitcoin_mining_hashes_total", "");
+    MetricCounter& accepted = metrics.GetCounter("mybitcoin_blocks_accepted_total", "");
+    MetricCounter& rejected = metrics.GetCounter("mybitcoin_blocks_rejected_total", "");
+    MetricHistogram& powStage = metrics.GetHistogram("mybitcoin_validation_stage_seconds", "", "stage=\"pow\"");
+    uint64_t hashesBefore = hashes.Value(), acceptedBefore = accepted.Value(), rejectedBefore = rejected.Value();
+    uint64_t powBefore = powStage.Count();
+
+    // 1. ڿ֤㣺ϣ MiningStats һ£ / ֱܾ
+    Blockchain chain(TEST_BITS);
+    Wallet alice;
+    alice.GenerateNewKey();
+    Block block(1, chain.GetTip()->hash, uint256(), GENESIS_TIMESTAMP + 9001, TEST_BITS);
+    block.AddTransaction(MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1)));
+    uint64_t afterGenesis = hashes.Value();
+    MiningStats stats = block.FinalizeAndMine();
+    assert(hashes.Value() - afterGenesis == stats.totalHashes);
+    chain.AddBlock(block);
+    assert(IsRejected(chain, block)); // ظ
+    assert(accepted.Value() == acceptedBefore + 1 && rejected.Value() == rejectedBefore + 1);
+    assert(powStage.Count() == powBefore + 1);
+    assert(hashes.Value() > hashesBefore);
+
+    // 2. ߳ͬʱд
+    MetricCounter& counter = metrics.GetCounter("test_concurrent_total", "Test counter");
+    assert(&counter == &metrics.GetCounter("test_concurrent_total", ""));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&counter]() { for (int i = 0; i < 100000; i++) counter.Add(); });
+    }
+    for (auto& t : threads) t.join();
+    assert(counter.Value() == 400000);
+
+    // 3. ֱͼͰۼƵ
+    MetricHistogram& h = metrics.GetHistogram("test_latency_seconds", "Test histogram", "path=\"a\"");
+    h.Observe(0.5e-6);
+    h.Observe(3e-3);
+    h.Observe(100);
+    assert(h.Count() == 3 && h.Sum() > 100);
+    std::string snapshot = metrics.Snapshot();
+    assert(snapshot.find("# TYPE test_concurrent_total counter\ntest_concurrent_total 400000\n") != std::string::npos);
+    assert(snapshot.find("test_latency_seconds_bucket{path=\"a\",le=\"1e-06\"} 1\n") != std::string::npos);
+    assert(snapshot.find("test_latency_seconds_bucket{path=\"a\",le=\"0.004096\"} 2\n") != std::string::npos);
+    assert(snapshot.find("test_latency_seconds_bucket{path=\"a\",le=\"+Inf\"} 3\n") != std::string::npos);
+    assert(snapshot.find("test_latency_seconds_count{path=\"a\"} 3\n") != std::string::npos);
+    assert(snapshot.find("mybitcoin_validation_stage_seconds_bucket{stage=\"signatures\"") != std::string::npos);
+    // ָͬ HELP ֻһ
+    size_t first = snapshot.find("# HELP mybitcoin_validation_stage_seconds");
+    assert(first != std::string::npos && snapshot.find("# HELP mybitcoin_validation_stage_seconds", first + 1) == std::string::npos);
+
+    // 4. ļ
+    std::string dir = FreshDataDir("mybitcoin_test_metrics");
+    std::filesystem::create_directories(dir);
+    std::string path = dir + "/metrics.prom";
+    {
+        MetricsFileExporter exporter(metrics, path, std::chrono::milliseconds(10));
+        counter.Add(5);
+    }
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    assert(content.str().find("test_concurrent_total 400005\n") != std::string::npos);
+
+#ifndef _WIN32
+    // 5. ׽֣Ͼյһݿ
+    std::string socketPath = dir + "/metrics.sock";
+    MetricsSocketServer server(metrics, socketPath);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    assert(fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::string received;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) received.append(buf, n);
+    close(fd);
+    assert(received.find("test_concurrent_total 400005\n") != std::string::npos);
+
+    // 6. ȴĿͻˣձ׽ֻ󣬷ͳʱӺӰ
+    {
+        MetricsRegistry big;
+        big.GetGauge("test_big_gauge", std::string(4 << 20, 'x'));
+        std::string bigPath = dir + "/big.sock";
+        MetricsSocketServer bigServer(big, bigPath);
+        sockaddr_un bigAddr = {};
+        bigAddr.sun_family = AF_UNIX;
+        strncpy(bigAddr.sun_path, bigPath.c_str(), sizeof(bigAddr.sun_path) - 1);
+        int stalled = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(stalled >= 0 && connect(stalled, reinterpret_cast<sockaddr*>(&bigAddr), sizeof(bigAddr)) == 0);
+        int reader = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(reader >= 0 && connect(reader, reinterpret_cast<sockaddr*>(&bigAddr), sizeof(bigAddr)) == 0);
+        size_t total = 0;
+        while ((n = read(reader, buf, sizeof(buf))) > 0) total += static_cast<size_t>(n);
+        close(reader);
+        assert(total > (4u << 20));
+        close(stalled);
+    }
+#endif
+
+    std::cout << "Metrics Test Passed!" << std::endl;
+#endif
+}
+
+void TestDifficultyRetarget() {
+    // ÿ 4 һѶȣ 600 һ飻ѶԼ 256 ιϣ
+    ConsensusParams params;
+    params.powLimitBits = 0x2000ffff;
+    params.targetSpacing = 600;
+    params.retargetInterval = 4;
+    Blockchain chain(params);
+    Wallet miner;
+    miner.GenerateNewKey();
+
+    auto mineNext = [&](uint32_t time, uint32_t bits) {
+        uint32_t height = chain.GetHeight() + 1;
+        Block block(1, chain.GetTip()->hash, uint256(), time, bits);
+        block.AddTransaction(MakeCoinbase(height, miner.GetPubKeyHash(), GetBlockSubsidy(height)));
+        block.FinalizeAndMine();
+        return block;
+    };
+
+    // 1. ֮ǰޣbits Ե (¹) ܾ
+    uint32_t time = chain.GetLatestBlock().timestamp;
+    assert(IsRejected(chain, mineNext(time + 60, 0x1f00ffff)));
+    for (int i = 1; i <= 3; i++) {
+        assert(chain.GetNextWorkRequired() == params.powLimitBits);
+        chain.AddBlock(mineNext(time + 60 * i, chain.GetNextWorkRequired()));
+    }
+
+    // 2. ߶ 43 ֻ 180  ( 1800)ʵʺʱ 1/4 ⶥĿԼС 1/4
+    uint32_t harder = chain.GetNextWorkRequired();
+    ArithUint256 limit, target;
+    DecodeTarget(params.powLimitBits, limit);
+    DecodeTarget(harder, target);
+    assert(target < limit && target > (limit >> 3));
+    assert(IsRejected(chain, mineNext(time + 240, params.powLimitBits)));
+    const BlockIndex* before = chain.GetTip();
+    chain.AddBlock(mineNext(time + 240, harder));
+    assert(chain.GetHeight() == 4 && chain.GetLatestBlock().CheckPoW());
+    assert(chain.GetTip()->chainWork == before->chainWork + GetBlockWork(harder));
+    assert(GetBlockWork(harder) > GetBlockWork(params.powLimitBits));
+
+    // 3. ֮Ѷȣһεʱ̫ĿŴ 4  (ص޸)
+    for (int i = 5; i <= 7; i++) {
+        assert(chain.GetNextWorkRequired() == harder);
+        chain.AddBlock(mineNext(time + 240 + 100000 * (i - 4), harder));
+    }
+    DecodeTarget(chain.GetNextWorkRequired(), target);
+    assert(target <= limit && target > (limit >> 1));
+
+    // 4. ʱޣ 11  (ȫ 8 ) λڸ
+    assert(chain.GetMedianTimePast() == time + 240);
+    assert(IsRejected(chain, mineNext(time + 240, chain.GetNextWorkRequired())));
+    chain.AddBlock(mineNext(time + 241, chain.GetNextWorkRequired()));
+    assert(chain.GetHeight() == 8);
+
+    // 5. ʱޣȱʱ䳬ǰ 2 Сʱܾ鲻Ժ󻹿ύ
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    Block future = mineNext(now + MAX_FUTURE_BLOCK_TIME + 600, chain.GetNextWorkRequired());
+    assert(IsRejected(chain, future));
+    assert(!chain.LookupBlock(future.GetHash()));
+    chain.AddBlock(mineNext(now + 60, chain.GetNextWorkRequired()));
+    assert(chain.GetHeight() == 9);
+
+    // 6. ϷѶ
+    ConsensusParams invalid;
+    invalid.powLimitBits = 0x04923456;
+    bool thrown = false;
+    try { Blockchain broken(invalid); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+    std::cout << "Difficulty Retarget Test Passed!" << std::endl;
+}
+
+void TestWorkUnits() {
+    std::cout << "\n=== Work Units ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    Mempool pool(chain);
+    Wallet alice, miner;
+    alice.GenerateNewKey();
+    miner.GenerateNewKey();
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    chain.AddBlock(MineBlock(chain, { reward }, 5000));
+    Transaction pay = SpendOutput(reward.GetId(), 0, GetBlockSubsidy(1) - 5000, alice, alice.GetAddress());
+    pool.AddTransaction(pay);
+
+    WorkManager manager(pool, chain, miner.GetPubKeyHash(), 1000);
+
+    // 1. ͬһģϵĹ workIdextranonce 以صcoinbase ƴ coinbase
+    WorkUnit a = manager.GetWork(GENESIS_TIMESTAMP + 5001);
+    WorkUnit b = manager.GetWork(GENESIS_TIMESTAMP + 5001);
+    assert(a.workId == b.workId && a.prevBlockHash == chain.GetTip()->hash && a.bits == TEST_BITS);
+    assert(a.extraNonceEnd - a.extraNonceBegin == 1000 && b.extraNonceBegin == a.extraNonceEnd);
+    assert(a.CoinbaseId(7) == MakeCoinbase(2, miner.GetPubKeyHash(), GetBlockSubsidy(2) + 5000, 7).GetId());
+    assert(a.MerkleRoot(7) != a.MerkleRoot(8));
+
+    // 2. л (ڽ֮䴫)
+    Bytes data;
+    VectorWriter writer(data);
+    SerializeWorkUnit(writer, a);
+    WorkUnit copy = DeserializeWorkUnit(ByteView(data));
+    assert(copy.workId == a.workId && copy.prevBlockHash == a.prevBlockHash && copy.bits == a.bits);
+    assert(copy.coinbasePrefix == a.coinbasePrefix && copy.coinbaseSuffix == a.coinbaseSuffix);
+    assert(copy.merkleBranch == a.merkleBranch && copy.extraNonceEnd == a.extraNonceEnd);
+    data.push_back(0);
+    bool thrown = false;
+    try { DeserializeWorkUnit(ByteView(data)); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+
+    // 3. ͬʱڸԵĹ
+    WorkSolution solA, solB;
+    bool foundA = false, foundB = false;
+    std::thread minerA([&]() { foundA = MineWorkUnit(copy, solA); });
+    std::thread minerB([&]() { foundB = MineWorkUnit(b, solB); });
+    minerA.join();
+    minerB.join();
+    assert(foundA && foundB && solA.workId == a.workId);
+    assert(solA.extraNonce >= a.extraNonceBegin && solA.extraNonce < a.extraNonceEnd);
+    assert(solB.extraNonce >= b.extraNonceBegin && solB.extraNonce < b.extraNonceEnd);
+
+    Bytes solutionData;
+    VectorWriter solutionWriter(solutionData);
+    SerializeWorkSolution(solutionWriter, solA);
+    assert(solutionData.size() == WORK_SOLUTION_SIZE);
+    WorkSolution solCopy = DeserializeWorkSolution(ByteView(solutionData));
+    assert(solCopy.workId == solA.workId && solCopy.extraNonce == solA.extraNonce);
+    assert(solCopy.nonce == solA.nonce && solCopy.time == solA.time);
+
+    // 4. αĽⱻܾextranonce ǷݹġworkId ڡPoW ϸ
+    Block block(0, uint256(), uint256(), 0, 0);
+    WorkSolution forged = solA;
+    forged.extraNonce = b.extraNonceEnd;
+    assert(!manager.SubmitWork(forged, block));
+    forged = solA;
+    forged.workId += 100;
+    assert(!manager.SubmitWork(forged, block));
+    forged = solA;
+    Block forgedHeader = a.Header(solA.extraNonce);
+    do {
+        forgedHeader.nonce = ++forged.nonce;
+    } while (forgedHeader.CheckPoW());
+    assert(!manager.SubmitWork(forged, block));
+
+    // 5. ϸĽװ飬ܣͬһģһ󹤵Ľ֮
+    assert(manager.SubmitWork(solCopy, block));
+    assert(block.IsFrozen() && block.transactions.size() == 2 && block.transactions[1].GetId() == pay.GetId());
+    assert(block.merkleRoot == ComputeMerkleRoot(block.transactions));
+    assert(block.transactions[0].outputs[0].value == GetBlockSubsidy(2) + 5000);
+    chain.AddBlock(block);
+    pool.RemoveForBlock(block);
+    assert(chain.GetHeight() == 2 && pool.Size() == 0);
+    assert(!manager.SubmitWork(solB, block));
+
+    // 6. β仯ģ壬extranonce 
+    WorkUnit c = manager.GetWork(GENESIS_TIMESTAMP + 5002);
+    assert(c.workId != a.workId && c.prevBlockHash == chain.GetTip()->hash);
+    assert(c.extraNonceBegin >= b.extraNonceEnd && c.merkleBranch.empty());
+
+    // 7. stop λ
+    std::atomic<bool> stop(true);
+    WorkSolution none;
+    assert(!MineWorkUnit(c, none, 1, &stop));
+    MiningStats stats;
+    Block header = c.Header(c.extraNonceBegin);
+    assert(!header.TryMine(stats, 2, &stop) && stats.totalHashes == 0);
+    std::cout << "Work Unit Test Passed!" << std::endl;
+}
+
+void TestDuplicateTransactions() {
+    std::cout << "\n=== Duplicate Transactions (CVE-2012-2459) ===" << std::endl;
+    std::string dir = FreshDataDir("mybitcoin_test_duplicate_tx");
+    uint256 validHash, sideHash;
+    {
+        Blockchain chain(TEST_BITS, dir);
+        Wallet alice, bob;
+        alice.GenerateNewKey();
+        bob.GenerateNewKey();
+
+        Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+        Transaction split;
+        split.inputs.push_back({ reward.GetId(), 0, {}, {} });
+        for (int i = 0; i < 2; i++) split.outputs.push_back({ GetBlockSubsidy(1) / 2, alice.GetAddress() });
+        SignInputs(split, alice);
+        chain.AddBlock(MineBlock(chain, { reward, split }, 21000));
+        uint256 forkPoint = chain.GetTip()->hash;
+
+        Transaction a = SpendOutput(split.GetId(), 0, GetBlockSubsidy(1) / 2, alice, bob.GetAddress());
+        Transaction b = SpendOutput(split.GetId(), 1, GetBlockSubsidy(1) / 2, alice, bob.GetAddress());
+
+        // [cb, a, b]  [cb, a, b, b] Ĭ˶ͬͷ (ϣ) Ҳͬ
+        auto mutate = [&](const Block& valid) {
+            Block mutated = valid;
+            mutated.transactions.push_back(b);
+            assert(ComputeMerkleRoot(mutated.transactions) == valid.merkleRoot);
+            assert(mutated.GetHash() == valid.GetHash());
+            return mutated;
+        };
+
+        // 1. ȵһΪβܾܰϣǳЧ
+        Block valid = MineBlock(chain, { MakeCoinbase(2, bob.GetAddress(), GetBlockSubsidy(2)), a, b }, 21001);
+        assert(IsRejected(chain, mutate(valid)));
+        assert(!chain.LookupBlock(valid.GetHash()));
+        chain.AddBlock(valid);
+        assert(chain.GetTip()->hash == valid.GetHash());
+
+        // 2. ȵֻܷڷֲϣռסϣϷճ浽ֲ
+        Block side = MineBlockOn(forkPoint, { MakeCoinbase(2, alice.GetAddress(), GetBlockSubsidy(2)), a, b }, 21002);
+        assert(IsRejected(chain, mutate(side)));
+        chain.AddBlock(side);
+        assert(chain.LookupBlock(side.GetHash()) && !chain.LookupBlock(side.GetHash())->failed);
+        assert(chain.GetTip()->hash == valid.GetHash());
+        validHash = valid.GetHash();
+        sideHash = side.GetHash();
+    }
+
+    // 3. Ҳû±Ч
+    {
+        Blockchain chain(TEST_BITS, dir);
+        assert(chain.GetTip()->hash == validHash && chain.GetHeight() == 2);
+        assert(chain.LookupBlock(sideHash) && !chain.LookupBlock(sideHash)->failed);
+    }
+    std::filesystem::remove_all(dir);
+    std::cout << "Duplicate Transactions Test Passed!" << std::endl;
+}
+
+void TestStaleHashCaches() {
+    std::cout << "\n=== Stale Hash Caches ===" << std::endl;
+    Blockchain chain(TEST_BITS);
+    Wallet alice, bob, mallory;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+    mallory.GenerateNewKey();
+
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    chain.AddBlock(MineBlock(chain, { reward }, 20000));
+
+    // Alice  BobĽǶģtxid ǩϣѻ
+    Transaction pay = SpendOutput(reward.GetId(), 0, GetBlockSubsidy(1), alice, bob.GetAddress());
+    Block block = MineBlock(chain, { pay }, 20001);
+    assert(block.transactions[0].IsFrozen());
+
+    //  Thaw() ֱӰտַĳ Mallory txid ǩϣԭģ
+    // ͷĬ˶ҲԵϻ棬AddBlock 밴ԭʼֶ¼ܷ
+    Block redirected = block;
+    redirected.transactions[0].outputs[0].pubKeyHash = mallory.GetPubKeyHash();
+    assert(redirected.transactions[0].GetId() == pay.GetId());
+    assert(IsRejected(chain, redirected));
+    assert(chain.GetHeight() == 1);
+    assert(!chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+
+    // ԭ鲻Ӱ
+    chain.AddBlock(block);
+    assert(chain.GetHeight() == 2);
+    assert(chain.GetUtxoSet().Contains(OutPoint(pay.GetId(), 0)));
+    std::cout << "Stale Hash Cache Test Passed!" << std::endl;
+}
+
+void TestBlockImport() {
+    std::cout << "\n=== Block Import ===" << std::endl;
+    std::string dir = FreshDataDir("mybitcoin_test_import");
+    Wallet alice, bob;
+    alice.GenerateNewKey();
+    bob.GenerateNewKey();
+
+    // Դڵ㣺8  (ǩת) һֲ飬浽
+    Transaction reward = MakeCoinbase(1, alice.GetAddress(), GetBlockSubsidy(1));
+    std::vector<Block> blocks;
+    std::string exported;
+    uint256 tip;
+    size_t utxoSize = 0;
+    {
+        Blockchain source(TEST_BITS, dir);
+        source.AddBlock(MineBlock(source, { reward }, 3000));
+        uint256 prev = reward.GetId();
+        for (uint32_t h = 2; h <= 8; h++) {
+            Transaction pay = SpendOutput(prev, 0, GetBlockSubsidy(1), alice, alice.GetAddress());
+            source.AddBlock(MineBlock(source, { MakeCoinbase(h, bob.GetAddress(), GetBlockSubsidy(h)), pay }, 3000 + h));
+            prev = pay.GetId();
+        }
+        source.AddBlock(MineBlockOn(source.GetBlockAtHeight(7)->hash, { MakeCoinbase(8, alice.GetAddress(), GetBlockSubsidy(8)) }, 4000));
+        for (uint32_t h = 1; h <= 8; h++) blocks.push_back(source.GetBlockData(source.GetBlockAtHeight(h)));
+        tip = source.GetTip()->hash;
+        utxoSize = source.GetUtxoSet().Size();
+
+        std::ostringstream out(std::ios::binary);
+        ExportBlocks(source, out);
+        exported = out.str();
+    }
+
+    // 1. ԭ룺Դڵͬٵһȫظ
+    {
+        Blockchain chain(TEST_BITS);
+        ImportOptions options;
+        options.threads = 4;
+        options.queueSize = 2;
+        std::istringstream in(exported);
+        ImportStats stats = ImportBlocks(chain, in, options);
+        assert(stats.read == 8 && stats.accepted == 8);
+        assert(stats.duplicate == 0 && stats.invalid == 0 && stats.orphaned == 0);
+        assert(chain.GetTip()->hash == tip && chain.GetHeight() == 8);
+        assert(chain.GetUtxoSet().Size() == utxoSize);
+
+        std::istringstream again(exported);
+        stats = ImportBlocks(chain, again, options);
+        assert(stats.read == 8 && stats.duplicate == 8 && stats.accepted == 0);
+    }
+
+    // 2. 򡢼ͻ̺߳Ͷ߳̽ͬ
+    auto record = [](std::string& s, const Bytes& data) {
+        uint8_t header[8];
+        SpanWriter writer(header, sizeof(header));
+        WriteLE32(writer, BLOCK_FILE_MAGIC);
+        WriteLE32(writer, static_cast<uint32_t>(data.size()));
+        s.append(reinterpret_cast<const char*>(header), sizeof(header));
+        s.append(data.begin(), data.end());
+    };
+    // ǩ۸ (״̬ܷ)
+    //  Thaw() ٸģĬ˶۸ĺĽ׼㣬ֻǩܷ
+    Transaction forgedPay = blocks[4].transactions[1];
+    forgedPay.Thaw();
+    forgedPay.inputs[0].signature.back() ^= 0x01;
+    Block forged = MineBlockOn(blocks[3].GetHash(), { blocks[4].transactions[0], forgedPay }, 5000);
+    assert(forged.transactions[1].GetId() != blocks[4].transactions[1].GetId());
+    assert(DeserializeBlock(ByteView(forged.Serialize())).GetMerkleRoot() == forged.merkleRoot);
+    {
+        Blockchain chain(TEST_BITS);
+        for (size_t i = 0; i < 4; i++) chain.AddBlock(blocks[i]);
+        std::string reason;
+        try {
+            chain.AddBlock(forged);
+        }
+        catch (const std::exception& e) {
+            reason = e.what();
+        }
+        assert(reason.find("bad signature") != std::string::npos);
+    }
+    // ظ reward (Ӧõʱܷ)
+    Block doubleSpend = MineBlockOn(blocks[7].GetHash(), { MakeCoinbase(9, bob.GetAddress(), GetBlockSubsidy(9)),
+        SpendOutput(reward.GetId(), 0, GetBlockSubsidy(1), alice, bob.GetAddress()) }, 5001);
+    // 鲻
+    Block orphan = MineBlockOn(Hash256(ToBytes("nowhere")), { MakeCoinbase(3, bob.GetAddress(), 50) }, 5002);
+
+    std::string messy = "garbage before the first record";
+    record(messy, blocks[2].Serialize());
+    record(messy, blocks[1].Serialize());
+    record(messy, forged.Serialize());
+    record(messy, blocks[0].Serialize());
+    messy += "more garbage";
+    for (size_t i = 3; i < blocks.size(); i++) record(messy, blocks[i].Serialize());
+    record(messy, blocks[3].Serialize());
+    record(messy, doubleSpend.Serialize());
+    record(messy, Bytes(100, 0x42));
+    record(messy, orphan.Serialize());
+    std::string last;
+    record(last, blocks[5].Serialize());
+    messy += last.substr(0, 40); // ĩβдһ
+
+    for (unsigned threads : { 1u, 4u }) {
+        Blockchain chain(TEST_BITS);
+        ImportOptions options;
+        options.threads = threads;
+        options.queueSize = threads;
+        std::istringstream in(messy);
+        ImportStats stats = ImportBlocks(chain, in, options);
+        assert(stats.read == 13);
+        assert(stats.accepted == 8 && stats.duplicate == 1 && stats.invalid == 3 && stats.orphaned == 1);
+        assert(chain.GetTip()->hash == tip);
+        assert(chain.GetUtxoSet().Size() == utxoSize);
+    }
+
+    // 3. ֶƵķΧ̵˺Ч¼ħ֮ңļ¼
+    {
+        std::string inner;
+        for (const auto& block : blocks) record(inner, block.Serialize());
+        std::string swallowed;
+        record(swallowed, Bytes(inner.begin(), inner.end()));
+        Blockchain chain(TEST_BITS);
+        std::istringstream in(swallowed);
+        ImportStats stats = ImportBlocks(chain, in);
+        assert(stats.read == 9 && stats.invalid == 1 && stats.accepted == 8);
+        assert(chain.GetTip()->hash == tip);
+    }
+
+    // 4. ݴĹ¿ maxOrphanBytes ƣ޵Ķ
+    {
+        std::string reversed;
+        for (size_t i = blocks.size(); i-- > 0;) record(reversed, blocks[i].Serialize());
+        Blockchain chain(TEST_BITS);
+        ImportOptions options;
+        options.maxOrphanBytes = 0;
+        std::istringstream in(reversed);
+        ImportStats stats = ImportBlocks(chain, in, options);
+        assert(stats.accepted == 1 && stats.orphaned == 7);
+        assert(chain.GetHeight() == 1);
+
+        // ֻŵȵ blocks[7]Ĺ¿鶼
+        options.maxOrphanBytes = blocks[7].GetSerializeSize();
+        std::istringstream again(reversed);
+        stats = ImportBlocks(chain, again, options);
+        assert(stats.accepted == 1 && stats.duplicate == 1 && stats.orphaned == 6);
+        assert(chain.GetHeight() == 2);
+
+        std::istringstream all(reversed);
+        stats = ImportBlocks(chain, all);
+        assert(stats.accepted == 6 && stats.duplicate == 2 && stats.orphaned == 0);
+        assert(chain.GetTip()->hash == tip);
+    }
+
+    // 5. ֱӵļ (еĳݼ¼Ч)ֲҲ
+    {
+        Blockchain chain(TEST_BITS);
+        ImportStats stats = ImportBlocksFromFile(chain, (std::filesystem::path(dir) / "blk00000.dat").string());
+        assert(stats.accepted == 9 && stats.duplicate == 1 && stats.orphaned == 0); // ظ
+        assert(stats.read == stats.accepted + stats.duplicate + stats.invalid);
+        assert(chain.GetTip()->hash == tip);
+
+        bool threw = false;
+        try {
+            ImportBlocksFromFile(chain, (std::filesystem::path(dir) / "missing.dat").string());
+        }
+        catch (const std::exception&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    std::filesystem::remove_all(dir);
+    std::cout << "Block Import Test Passed!" << std::endl;
+}
+
 int main() {
     TestFullFlow();
+    TestUtxoRules();
+    TestSignatures();
+    TestSignatureCache();
+    TestReorg();
+    TestBlockStore();
+    TestPersistentChain();
+    TestUtxoTable();
+    TestMempool();
+    TestMetrics();
+    TestDifficultyRetarget();
+    TestWorkUnits();
+    TestDuplicateTransactions();
+    TestStaleHashCaches();
+    TestBlockImport();
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,14 @@
 #include <iostream>
 #include <cassert>
+#include "Crypto/ArithUint256.h"
 #include "Crypto/Hash.h"
+#include "Crypto/Sha256.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
 
 void TestSha256() {
     //  1: "hello"
@@ -21,17 +29,242 @@ void TestHash256() {
     // ע⣺ַ"hello"ǵһιϣֽ
     std::string input = "hello";
     Bytes data = ToBytes(input);
-    Bytes hash = Hash256(data);
+    uint256 hash = Hash256(data);
     std::string hex = ToHex(hash);
 
     std::cout << "Hash256('hello'): " << hex << std::endl;
     assert(hex == "9595c9df90075148eb06860365df33584b75bff782a510c6cd4883a419833d50");
 }
 
+void TestSha256Hasher() {
+    // ͬ (Խ 64 ֽڿ߽) Ҫ Sha256()/Hash256() һ
+    for (size_t len = 0; len < 200; len++) {
+        Bytes data(len);
+        for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i * 7 + len);
+
+        uint8_t out[32];
+        Sha256Hasher().Write(data.data(), data.size()).Finalize(out);
+        assert(Bytes(out, out + 32) == Sha256(data));
+
+        // д
+        Sha256Hasher h;
+        h.Write(data.data(), len / 3).Write(data.data() + len / 3, len - len / 3).Finalize(out);
+        assert(Bytes(out, out + 32) == Sha256(data));
+
+        Sha256D(out, data.data(), data.size());
+        assert(uint256(Bytes(out, out + 32)) == Hash256(data));
+    }
+    std::cout << "Sha256Hasher matches Sha256/Hash256" << std::endl;
+}
+
+void TestMidstate() {
+    // ģ 80 ֽͷ noncemidstate · Hash256
+    Bytes header(80);
+    for (size_t i = 0; i < 80; i++) header[i] = (uint8_t)(i * 13 + 1);
+
+    uint32_t midstate[8];
+    Sha256Midstate(midstate, header.data());
+    for (uint32_t nonce = 0; nonce < 100; nonce++) {
+        header[76] = nonce & 0xFF;
+        header[77] = (nonce >> 8) & 0xFF;
+        uint8_t out[32];
+        Sha256D80Midstate(out, midstate, header.data() + 64);
+        assert(uint256(Bytes(out, out + 32)) == Hash256(header));
+    }
+    std::cout << "Midstate Hash256 matches" << std::endl;
+}
+
+void TestSha256Batch() {
+    // ׼ 37 ϢղһβҲҪǵ
+    const size_t N = 37;
+    Bytes in64(64 * N), in80(80 * N);
+    uint32_t seed = 12345;
+    for (auto& b : in64) { seed = seed * 1103515245 + 12345; b = seed >> 16; }
+    for (auto& b : in80) { seed = seed * 1103515245 + 12345; b = seed >> 16; }
+
+    // ο Hash256
+    std::vector<uint256> ref64, ref80, refMid;
+    for (size_t i = 0; i < N; i++) {
+        ref64.push_back(Hash256(in64.data() + 64 * i, 64));
+        ref80.push_back(Hash256(in80.data() + 80 * i, 80));
+    }
+    //  midstateһͷǰ 64 ֽ + ÿԵβ
+    uint32_t midstate[8];
+    Sha256Midstate(midstate, in80.data());
+    Bytes tails(16 * N);
+    for (size_t i = 0; i < N; i++) {
+        Bytes header(in80.begin() + 80 * i, in80.begin() + 80 * i + 80);
+        memcpy(header.data(), in80.data(), 64);
+        memcpy(tails.data() + 16 * i, header.data() + 64, 16);
+        refMid.push_back(Hash256(header));
+    }
+
+    // ֵ֧ÿһʵֶολһ
+    for (const std::string& impl : Sha256AvailableImplementations()) {
+        assert(Sha256UseImplementation(impl));
+        assert(ToHex(Sha256(ToBytes("hello"))) == "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+
+        Bytes out(32 * N);
+        Sha256D64Batch(out.data(), in64.data(), N);
+        for (size_t i = 0; i < N; i++) assert(memcmp(out.data() + 32 * i, ref64[i].data(), 32) == 0);
+
+        Sha256D80Batch(out.data(), in80.data(), N);
+        for (size_t i = 0; i < N; i++) assert(memcmp(out.data() + 32 * i, ref80[i].data(), 32) == 0);
+
+        Sha256D80MidstateBatch(out.data(), midstate, tails.data(), N);
+        for (size_t i = 0; i < N; i++) assert(memcmp(out.data() + 32 * i, refMid[i].data(), 32) == 0);
+
+        // ԭؼ (out == in)
+        Bytes inplace = in64;
+        Sha256D64Batch(inplace.data(), inplace.data(), N);
+        for (size_t i = 0; i < N; i++) assert(memcmp(inplace.data() + 32 * i, ref64[i].data(), 32) == 0);
+
+        std::cout << "Sha256 batch [" << impl << ", " << Sha256BatchLanes() << " lanes] matches" << std::endl;
+    }
+    assert(Sha256UseImplementation("auto"));
+    assert(!Sha256UseImplementation("no-such-impl"));
+}
+
+void TestUint256() {
+    static_assert(sizeof(uint256) == 32, "uint256 must be exactly 32 bytes");
+    static_assert(sizeof(uint160) == 20, "uint160 must be exactly 20 bytes");
+    static_assert(std::is_trivially_copyable<uint256>::value, "uint256 must be trivially copyable");
+
+    constexpr uint256 zero;
+    constexpr uint256 one(std::array<uint8_t, 32>{1});
+    assert(zero.IsNull());
+    assert(!one.IsNull());
+    assert(zero < one && zero != one);
+
+    uint256 a = Hash256(ToBytes("a"));
+    uint256 b = Hash256(ToBytes("b"));
+    assert(a == Hash256(ToBytes("a")));
+    assert(a != b);
+    assert(uint256(a.ToBytes()) == a);
+
+    // Ϊ/ key
+    std::unordered_map<uint256, int> hmap;
+    std::map<uint256, int> tmap;
+    hmap[a] = 1; hmap[b] = 2;
+    tmap[a] = 1; tmap[b] = 2;
+    assert(hmap.at(a) == 1 && hmap.at(b) == 2);
+    assert(tmap.begin()->first == (a < b ? a : b));
+
+    bool threw = false;
+    try { uint256 bad(Bytes(31, 0)); }
+    catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    assert(Hash160(ToBytes("hello")).size() == 20);
+    std::cout << "uint256/uint160 Tests Passed" << std::endl;
+}
+
+void TestHex() {
+    // 1. 룺ȫ 256 ֵֽֽڸʽĽһ
+    Bytes all(256);
+    std::string expected;
+    for (int i = 0; i < 256; i++) {
+        all[i] = static_cast<uint8_t>(i);
+        char buf[3];
+        snprintf(buf, sizeof(buf), "%02x", i);
+        expected += buf;
+    }
+    assert(ToHex(all) == expected);
+    assert(ToHex(Bytes()).empty());
+
+    // 2. 룺Сдɣ䣻ȡǷַʧ
+    Bytes back;
+    assert(FromHex(expected, back) && back == all);
+    std::string upper = expected;
+    for (char& c : upper) c = static_cast<char>(toupper(c));
+    assert(FromHex(upper, back) && back == all);
+    assert(!FromHex("abc", back));
+    assert(!FromHex("0g", back));
+    assert(!FromHex("zz", back));
+    assert(!FromHex(std::string("0\0", 2), back));
+
+    // 3. д÷ֽ֮
+    uint256 h = Hash256(ToBytes("hex"));
+    char buf[66];
+    memset(buf, '#', sizeof(buf));
+    ToHex(h.data(), h.size(), buf);
+    assert(std::string(buf, 64) == ToHex(h) && buf[64] == '#');
+
+    // 4. ʾ Bitcoin Core ʾĴϣһ
+    uint256 genesis;
+    assert(FromHexReversed("000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f", genesis));
+    assert(genesis[0] == 0x6f && genesis[31] == 0x00);
+    assert(ToHexReversed(genesis) == "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f");
+    uint256 parsed;
+    assert(FromHex(ToHex(h), parsed) && parsed == h);
+    assert(!FromHex(ToHex(h).substr(2), parsed));
+
+    std::cout << "Hex Tests Passed" << std::endl;
+}
+
+void TestArithUint256() {
+    // 1. λλͻ
+    ArithUint256 a(0xFFFFFFFFFFFFFFFFULL);
+    assert(a + 1 == (ArithUint256(1) << 64));
+    assert((ArithUint256(1) << 64) - 1 == a);
+    assert(ArithUint256() - 1 == ~ArithUint256());
+    assert(~ArithUint256() + 1 == ArithUint256());
+    assert(ArithUint256(0xFFFFFFFFULL) * 0xFFFFFFFFu == ArithUint256(0xFFFFFFFE00000001ULL));
+
+    // 2. λλ
+    assert((ArithUint256(1) << 255).Bits() == 256 && ArithUint256().Bits() == 0);
+    assert(((ArithUint256(1) << 255) >> 255) == 1);
+    assert(((ArithUint256(0x12345678) << 100) >> 100) == 0x12345678);
+    assert((ArithUint256(1) << 256) == ArithUint256());
+
+    // 3. 
+    assert((ArithUint256(1) << 200) / (ArithUint256(1) << 100) == (ArithUint256(1) << 100));
+    assert((ArithUint256(1000000007) * 12345u) / ArithUint256(12345) == 1000000007);
+    assert(ArithUint256(5) / ArithUint256(7) == 0);
+    assert(~ArithUint256() / ~ArithUint256() == 1);
+    bool thrown = false;
+    try { ArithUint256(1) / ArithUint256(); }
+    catch (const std::domain_error&) { thrown = true; }
+    assert(thrown);
+
+    // 4.  uint256 ת (ͬС)
+    uint256 blob(Bytes(32, 0));
+    blob[0] = 0x01;
+    blob[31] = 0x80;
+    ArithUint256 n(blob);
+    assert(n == (ArithUint256(1) << 255) + 1 && n.ToUint256() == blob);
+    assert(n > ArithUint256(1) << 254 && !(n < ArithUint256(1)));
+
+    // 5. compact ʽ ( Bitcoin Core Ĳһ)
+    ArithUint256 t;
+    bool negative = false, overflow = false;
+    t.SetCompact(0x1d00ffff, &negative, &overflow);
+    assert(!negative && !overflow);
+    assert(t.ToString() == "00000000ffff0000000000000000000000000000000000000000000000000000");
+    assert(t.GetCompact() == 0x1d00ffff);
+    assert(t.SetCompact(0x01003456) == 0 && t.GetCompact() == 0);
+    assert(t.SetCompact(0x01123456) == 0x12 && t.GetCompact() == 0x01120000);
+    assert(t.SetCompact(0x04123456) == 0x12345600 && t.GetCompact() == 0x04123456);
+    assert(t.SetCompact(0x05009234) == 0x92340000ULL && t.GetCompact() == 0x05009234);
+    t.SetCompact(0x04923456, &negative, &overflow);
+    assert(negative && !overflow && t.GetCompact(true) == 0x04923456);
+    t.SetCompact(0xff123456, &negative, &overflow);
+    assert(!negative && overflow);
+    t.SetCompact(0x20123456, &negative, &overflow);
+    assert(!overflow && t == (ArithUint256(0x123456) << 232));
+    std::cout << "ArithUint256 Tests Passed" << std::endl;
+}
+
 int main() {
     try {
         TestSha256();
         TestHash256();
+        TestSha256Hasher();
+        TestMidstate();
+        TestSha256Batch();
+        TestUint256();
+        TestHex();
+        TestArithUint256();
         std::cout << "All Crypto Tests Passed!" << std::endl;
     }
     catch (const std::exception& e) {
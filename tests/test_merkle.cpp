@@ -0,0 +1,181 @@
+#include "../src/Core/Block.h"
+#include "../src/Core/Merkle.h"
+#include <iostream>
+#include <cassert>
+
+//  n ʻͬģ⽻
+std::vector<Transaction> MakeTransactions(size_t n) {
+    std::vector<Transaction> txs;
+    for (size_t i = 0; i < n; i++) {
+        Transaction tx;
+        TxIn in;
+        in.prevTxId = Hash256(ToBytes("prev" + std::to_string(i)));
+        in.prevIndex = (uint32_t)i;
+        tx.inputs.push_back(in);
+        tx.outputs.push_back({ (int64_t)(i + 1) * 1000, Hash160(ToBytes("addr" + std::to_string(i))) });
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+// οʵֱ֣׵ƴ + Hash256
+uint256 ReferenceMerkleRoot(const std::vector<Transaction>& txs) {
+    if (txs.empty()) return uint256();
+    std::vector<uint256> hashes;
+    for (const auto& tx : txs) hashes.push_back(tx.GetId());
+    while (hashes.size() > 1) {
+        if (hashes.size() % 2 != 0) hashes.push_back(hashes.back());
+        std::vector<uint256> next;
+        for (size_t i = 0; i < hashes.size(); i += 2) {
+            Bytes concat = hashes[i].ToBytes();
+            concat.insert(concat.end(), hashes[i + 1].begin(), hashes[i + 1].end());
+            next.push_back(Hash256(concat));
+        }
+        hashes = next;
+    }
+    return hashes[0];
+}
+
+void TestMerkleRoot() {
+    assert(ComputeMerkleRoot({}).IsNull());
+
+    // Ǹż
+    for (size_t n = 1; n <= 70; n++) {
+        std::vector<Transaction> txs = MakeTransactions(n);
+        assert(ComputeMerkleRoot(txs) == ReferenceMerkleRoot(txs));
+    }
+
+    // 飺̳߳زм txid
+    std::vector<Transaction> big = MakeTransactions(3001);
+    assert(ComputeMerkleRoot(big) == ReferenceMerkleRoot(big));
+
+    // ʽ׵ĸ txid
+    std::vector<Transaction> one = MakeTransactions(1);
+    assert(ComputeMerkleRoot(one) == one[0].GetId());
+
+    std::cout << "Merkle Root Test Passed!" << std::endl;
+}
+
+void TestMerkleFrontier() {
+    // ÿ׷һʽףĸҪĽһ
+    std::vector<Transaction> txs = MakeTransactions(70);
+    MerkleFrontier frontier;
+    assert(frontier.Root().IsNull());
+    for (size_t n = 1; n <= txs.size(); n++) {
+        frontier.Append(txs[n - 1].GetId());
+        std::vector<Transaction> prefix(txs.begin(), txs.begin() + n);
+        assert(frontier.Size() == n);
+        assert(frontier.Root() == ComputeMerkleRoot(prefix));
+    }
+
+    // Block::AddTransaction ά
+    Block block(1, uint256(), uint256(), 123456, 0);
+    for (const auto& tx : txs) {
+        block.AddTransaction(tx);
+    }
+    assert(block.GetMerkleRoot() == ComputeMerkleRoot(txs));
+
+    // ƹ AddTransaction ֱ޸Ľбؽɻָһ
+    block.transactions[3].outputs[0].value = 1;
+    block.RebuildMerkleTree();
+    assert(block.GetMerkleRoot() == ComputeMerkleRoot(block.transactions));
+
+    std::cout << "Merkle Frontier Test Passed!" << std::endl;
+}
+
+void TestCoinbaseBranch() {
+    // ÿ׷һʽסÿһ coinbaseҪĽһ
+    std::vector<Transaction> txs = MakeTransactions(70);
+    CoinbaseMerkleBranch branch;
+    assert(branch.Root(txs[0].GetId()) == txs[0].GetId());
+    for (size_t n = 2; n <= txs.size(); n++) {
+        branch.Append(txs[n - 1].GetId());
+        assert(branch.Size() == n);
+        std::vector<Transaction> prefix(txs.begin(), txs.begin() + n);
+        assert(branch.Root(txs[0].GetId()) == ComputeMerkleRoot(prefix));
+        prefix[0] = txs[n % txs.size()];
+        assert(branch.Root(prefix[0].GetId()) == ComputeMerkleRoot(prefix));
+        // ķ֧ BuildMerkleBranch Ե 0 Ҷɵ֤ͬ
+        std::vector<uint256> ids;
+        for (const auto& tx : prefix) ids.push_back(tx.GetId());
+        assert(branch.Branch() == BuildMerkleBranch(ids, 0).siblings);
+        assert(ComputeMerkleRootFromBranch(ids[0], branch.Branch(), 0) == ComputeMerkleRoot(prefix));
+    }
+    assert(CoinbaseMerkleBranch().Branch().empty());
+    std::cout << "Coinbase Branch Test Passed!" << std::endl;
+}
+
+void TestMerkleBranch() {
+    for (size_t n = 1; n <= 40; n++) {
+        std::vector<Transaction> txs = MakeTransactions(n);
+        Block block(1, uint256(), uint256(), 123456, 0);
+        for (const auto& tx : txs) block.AddTransaction(tx);
+        block.merkleRoot = block.GetMerkleRoot();
+
+        for (size_t i = 0; i < n; i++) {
+            MerkleBranch branch;
+            assert(BuildMerkleBranch(block, txs[i].GetId(), branch));
+            assert(branch.index == i);
+            assert(VerifyMerkleBranch(branch, block));
+
+            // ۸һֵܽڵ±֤꣬ʧ
+            if (!branch.siblings.empty()) {
+                MerkleBranch bad = branch;
+                bad.siblings.back()[0] ^= 1;
+                assert(!VerifyMerkleBranch(bad, block));
+            }
+            MerkleBranch badIndex = branch;
+            badIndex.index |= 1u << branch.siblings.size();
+            assert(!VerifyMerkleBranch(badIndex, block));
+        }
+    }
+
+    // Ľɲ֤
+    Block block(1, uint256(), uint256(), 123456, 0);
+    block.AddTransaction(MakeTransactions(1)[0]);
+    MerkleBranch none;
+    assert(!BuildMerkleBranch(block, Hash256(ToBytes("nope")), none));
+
+    std::cout << "Merkle Branch Test Passed!" << std::endl;
+}
+
+void TestBatchVerify() {
+    // 10 飬ÿÿʽ׶һ֤ٻһЩα֤
+    std::vector<MerkleProof> proofs;
+    std::vector<bool> expected;
+    for (size_t b = 0; b < 10; b++) {
+        std::vector<Transaction> txs = MakeTransactions(20 + b * 7);
+        std::vector<uint256> ids;
+        for (const auto& tx : txs) ids.push_back(tx.GetId());
+        uint256 root = ComputeMerkleRoot(txs);
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            MerkleProof proof{ BuildMerkleBranch(ids, (uint32_t)i), root };
+            bool good = (i % 5 != 3);
+            if (!good) {
+                // α죺֤Ľףߴ۸ϲֵܽڵ
+                if (i % 2) proof.branch.txid = Hash256(ToBytes("fake"));
+                else proof.branch.siblings.back()[5] ^= 0x80;
+            }
+            proofs.push_back(proof);
+            expected.push_back(good);
+        }
+    }
+
+    std::vector<bool> result = BatchVerifyMerkleBranches(proofs);
+    assert(result.size() == proofs.size());
+    for (size_t i = 0; i < proofs.size(); i++) {
+        assert(result[i] == expected[i]);
+        assert(result[i] == VerifyMerkleBranch(proofs[i].branch, proofs[i].merkleRoot));
+    }
+    std::cout << "Merkle Batch Verify Test Passed! (" << proofs.size() << " proofs)" << std::endl;
+}
+
+int main() {
+    TestMerkleRoot();
+    TestMerkleFrontier();
+    TestCoinbaseBranch();
+    TestMerkleBranch();
+    TestBatchVerify();
+    return 0;
+}
@@ -1,4 +1,7 @@
+#include "../src/Core/Block.h"
 #include "../src/Core/Transaction.h"
+#include "../src/Core/TransactionView.h"
+#include "../src/Wallet/Base58.h"
 #include "../src/Wallet/Wallet.h"
 #include <iostream>
 #include <cassert>
@@ -12,22 +15,22 @@ void TestTransactionSignature() {
     // 1. һģ⽻ (Input)
     //  Alice ֮ǰյһǮ (TxID: ȫ0, Index: 0)
     TxIn input;
-    input.prevTxId = Bytes(32, 0);
+    input.prevTxId = uint256();
     input.prevIndex = 0;
     input.publicKey = alicePub; // 빫Կ
 
     // 콻
     Transaction tx;
     tx.inputs.push_back(input);
-    tx.outputs.push_back({ 50, "1BobAddress..." }); // ת Bob 50 BTC
+    tx.outputs.push_back({ 50, Hash160(ToBytes("Bob")) }); // ת Bob 50 BTC
 
     // 2. ǩ
     // رҵǩ临 (SIGHASH_ALL)ʾԭ
     // Alice ԡȥǩϢĽݡйϣȻǩ
 
     // Step A: ȡǩĹϣ (Message Hash)
-    // лǰ(ʱǩΪ) -> Hash256
-    Bytes messageHash = tx.GetId();
+    // л (ǩ͹Կÿ) -> Hash256
+    uint256 messageHash = tx.GetSignatureHash();
     std::cout << "Transaction Hash to Sign: " << ToHex(messageHash) << std::endl;
 
     // Step B: Alice ˽Կǩ
@@ -45,9 +48,10 @@ void TestTransactionSignature() {
 
     // õףȡ
     // ע⣺֤ʱ¼㱻ǩǸϣ (ǩõĹϣ)
-    Transaction tempTx = tx;
-    tempTx.inputs[0].signature.clear(); // ǩԻԭԭʼ
-    Bytes checkHash = tempTx.GetId();
+    // ǩϣǩǩĻͬһֵ TxID ǩ
+    uint256 checkHash = tx.GetSignatureHash();
+    assert(checkHash == messageHash);
+    assert(tx.GetId() != messageHash);
 
     bool isValid = Wallet::Verify(verifyInput.publicKey, checkHash, verifyInput.signature);
 
@@ -60,9 +64,140 @@ void TestTransactionSignature() {
     assert(isValid == true);
 }
 
+void TestSerialization() {
+    // 1. CompactSize ÿ볤ȵı߽
+    for (uint64_t n : { 0ULL, 0xFCULL, 0xFDULL, 0xFFFFULL, 0x10000ULL, 0xFFFFFFFFULL, 0x100000000ULL }) {
+        Bytes buf;
+        VectorWriter writer(buf);
+        WriteCompactSize(writer, n);
+        assert(buf.size() == GetCompactSizeLength(n));
+        SpanReader reader(buf.data(), buf.size());
+        assert(reader.ReadCompactSize() == n && reader.Empty());
+    }
+    // ̱ ( 3 ֽڱʾ 5) ܾͬһʽ׿вͬ txid
+    Bytes nonCanonical = { 0xFD, 0x05, 0x00 };
+    bool thrown = false;
+    try { SpanReader(nonCanonical.data(), nonCanonical.size()).ReadCompactSize(); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+
+    // 2. txid ǩϣ
+    Transaction tx;
+    tx.inputs.push_back({ uint256(Bytes(32, 0x33)), 1, Bytes(72, 0x30), Bytes(65, 0x04) });
+    tx.inputs.push_back({ uint256(Bytes(32, 0x44)), 0, Bytes(300, 0x30), Bytes(33, 0x03) });
+    tx.outputs.push_back({ 50, Hash160(ToBytes("Bob")) });
+    tx.outputs.push_back({ 7, uint160() });
+    tx.lockTime = 99;
+    Bytes data = tx.Serialize();
+    assert(data.size() == tx.GetSerializeSize());
+    assert(tx.GetId() == Hash256(data));
+    SpanReader reader(data.data(), data.size());
+    Transaction back = DeserializeTransaction(reader);
+    assert(reader.Empty());
+    assert(back.GetId() == tx.GetId() && back.lockTime == 99);
+    assert(back.inputs[1].signature.size() == 300 && back.outputs[0].pubKeyHash == Hash160(ToBytes("Bob")));
+
+    // 3. ֻͼֶָԭϣһ
+    TransactionView view((ByteView(data)));
+    assert(view.InputCount() == 2 && view.OutputCount() == 2 && view.LockTime() == 99);
+    assert(view.GetId() == tx.GetId());
+    assert(view.GetSignatureHash() == tx.GetSignatureHash());
+    assert(view.GetInput(1).prevTxId == tx.inputs[1].prevTxId);
+    assert(view.GetInput(1).publicKey == ByteView(tx.inputs[1].publicKey));
+    assert(view.GetOutput(0).value == 50);
+    assert(view.GetInput(0).signature.data > data.data() && view.GetInput(0).signature.data < data.data() + data.size());
+    assert(!view.IsCoinBase());
+    assert(view.ToTransaction().GetId() == tx.GetId());
+
+    // 4. ضϵ
+    thrown = false;
+    try { TransactionView bad(ByteView(data.data(), data.size() - 1)); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+    std::cout << "Serialization Test Passed!" << std::endl;
+}
+
+void TestHashCache() {
+    Transaction tx;
+    tx.inputs.push_back({ uint256(Bytes(32, 0x55)), 0, Bytes(72, 0x30), Bytes(65, 0x04) });
+    tx.outputs.push_back({ 20, Hash160(ToBytes("Carol")) });
+
+    // 1. 󷵻ػ棬ֱӼһ£ͬһ𿽱
+    uint256 id = tx.GetId();
+    uint256 sighash = tx.GetSignatureHash();
+    tx.Freeze();
+    assert(tx.IsFrozen() && tx.GetId() == id && tx.GetSignatureHash() == sighash);
+    Transaction copy = tx;
+    assert(copy.IsFrozen() && copy.GetId() == id);
+
+    // 2.  Thaw ޸ģ¶õµ txid
+    copy.Thaw();
+    copy.outputs[0].value = 21;
+    assert(copy.GetId() != id);
+    copy.Freeze();
+    assert(copy.GetId() == Hash256(copy.Serialize()));
+
+    // 3. лõĽѾ
+    Bytes data = tx.Serialize();
+    SpanReader reader(data.data(), data.size());
+    Transaction back = DeserializeTransaction(reader);
+    assert(back.IsFrozen() && back.GetId() == id);
+
+    // 4. 飺AddTransaction 涳ĸϣ䣬ڿûʧЧ
+    Block block(1, uint256(), uint256(), 123456, 0x2000ffff);
+    block.AddTransaction(tx);
+    block.AddTransaction(copy);
+    assert(block.transactions[0].IsFrozen() && block.transactions[1].GetId() == copy.GetId());
+    block.merkleRoot = block.GetMerkleRoot();
+    block.Freeze();
+    uint256 hash = block.GetHash();
+    assert(block.IsFrozen());
+    block.Mine(1);
+    assert(!block.IsFrozen() && block.CheckPoW());
+    block.Freeze();
+    uint8_t header[Block::HEADER_SIZE];
+    block.SerializeHeader(header);
+    assert(block.GetHash() == Hash256(header, Block::HEADER_SIZE) && block.GetHash() != hash);
+
+    std::cout << "Hash Cache Test Passed!" << std::endl;
+}
+
+void TestOutputAddress() {
+    Wallet wallet;
+    wallet.GenerateNewKey();
+
+    // 1. ֻ 20 ֽڹԿϣַڽӿڴת
+    TxOut out(50, wallet.GetAddress());
+    assert(out.pubKeyHash == wallet.GetPubKeyHash());
+    assert(out.GetAddress() == wallet.GetAddress());
+    assert(out == TxOut(50, wallet.GetPubKeyHash()));
+    assert(Wallet::AddressFromPublicKey(wallet.GetPublicKey()) == wallet.GetAddress());
+
+    // 2. Ϸĵַ (Уʹ󡢷 Base58 ַմ) ֱ쳣
+    std::string bad = wallet.GetAddress();
+    bad[bad.size() - 1] = (bad[bad.size() - 1] == '1') ? '2' : '1';
+    const char* invalid[] = { bad.c_str(), "1BobAddress...", "" };
+    for (const char* address : invalid) {
+        bool thrown = false;
+        try { TxOut(1, address); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+    }
+
+    // 3. 汾Ų 0x00  Base58Check Ҳ
+    uint8_t payload[21] = { 0x05 };
+    uint160 hash;
+    assert(!Wallet::PubKeyHashFromAddress(EncodeBase58Check(payload, sizeof(payload)), hash));
+
+    std::cout << "Output Address Test Passed!" << std::endl;
+}
+
 int main() {
     try {
         TestTransactionSignature();
+        TestSerialization();
+        TestHashCache();
+        TestOutputAddress();
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -1,6 +1,11 @@
 #include "../src/Wallet/Wallet.h"
+#include "../src/Wallet/PublicKey.h"
+#include "../src/Wallet/Base58.h"
+#include "../src/Wallet/HDKey.h"
+#include "../src/Wallet/KeyPool.h"
 #include <iostream>
 #include <cassert>
+#include <set>
 
 void TestWallet() {
     std::cout << "Generating new wallet..." << std::endl;
@@ -26,9 +31,262 @@ void TestWallet() {
     std::cout << "Wallet Test Passed!" << std::endl;
 }
 
+void TestPublicKey() {
+    Wallet wallet;
+    wallet.GenerateNewKey();
+    uint256 hash = Hash256(ToBytes("hello"));
+    Bytes sig = wallet.Sign(hash);
+
+    // 1. һΣ֤
+    PublicKey key(wallet.GetPublicKey());
+    assert(key.IsValid());
+    assert(key.GetBytes() == wallet.GetPublicKey());
+    for (int i = 0; i < 3; i++) assert(key.Verify(hash, sig));
+    assert(!key.Verify(Hash256(ToBytes("hellp")), sig));
+    Bytes badSig = sig;
+    badSig[badSig.size() / 2] ^= 0x01;
+    assert(!key.Verify(hash, badSig));
+    assert(!key.Verify(hash, Bytes()));
+
+    // 2. ϷĹԿ
+    Bytes badPrefix = wallet.GetPublicKey();
+    badPrefix[0] = 0x05;
+    assert(!PublicKey(badPrefix).IsValid());
+    assert(!PublicKey(Bytes(10, 0x02)).IsValid());
+    assert(!PublicKey(Bytes()).IsValid());
+    assert(!Wallet::Verify(badPrefix, hash, sig));
+
+    // 3. ԿǩʧЧ
+    Bytes oldPub = wallet.GetPublicKey();
+    wallet.GenerateNewKey();
+    assert(wallet.GetPublicKey() != oldPub);
+    assert(!Wallet::Verify(wallet.GetPublicKey(), hash, sig));
+    assert(Wallet::Verify(oldPub, hash, sig));
+
+    std::cout << "PublicKey Test Passed!" << std::endl;
+}
+
+void TestPublicKeyCache() {
+    Wallet a, b, c;
+    a.GenerateNewKey();
+    b.GenerateNewKey();
+    c.GenerateNewKey();
+
+    PublicKeyCache cache(2);
+    auto ka = cache.Get(a.GetPublicKey());
+    assert(ka && ka->IsValid());
+    assert(cache.Get(a.GetPublicKey()) == ka);   // Уͬһ
+    assert(cache.Hits() == 1 && cache.Misses() == 1);
+
+    cache.Get(b.GetPublicKey());
+    cache.Get(a.GetPublicKey());                 // a ʹ
+    cache.Get(c.GetPublicKey());                 // ̭ b
+    assert(cache.Size() == 2);
+    uint64_t misses = cache.Misses();
+    cache.Get(a.GetPublicKey());
+    assert(cache.Misses() == misses);
+    cache.Get(b.GetPublicKey());
+    assert(cache.Misses() == misses + 1);
+
+    // ϷĹԿ
+    assert(cache.Get(Bytes(33, 0x07)) == nullptr);
+    assert(cache.Size() == 2);
+    std::cout << "PublicKeyCache Test Passed!" << std::endl;
+}
+
+// ʮַתֽ
+Bytes ParseHexString(const std::string& hex) {
+    Bytes out;
+    bool ok = FromHex(hex, out);
+    assert(ok);
+    return out;
+}
+
+// οʵֽ֣ڳ 58
+std::string ReferenceBase58(const Bytes& input) {
+    static const char* alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    size_t zeros = 0;
+    while (zeros < input.size() && input[zeros] == 0) zeros++;
+    Bytes num(input.begin() + zeros, input.end());
+    std::string digits;
+    while (!num.empty()) {
+        int carry = 0;
+        Bytes next;
+        for (uint8_t b : num) {
+            int cur = carry * 256 + b;
+            if (!next.empty() || cur / 58) next.push_back((uint8_t)(cur / 58));
+            carry = cur % 58;
+        }
+        digits.insert(digits.begin(), alphabet[carry]);
+        num = next;
+    }
+    return std::string(zeros, '1') + digits;
+}
+
+void TestBase58() {
+    // 1. ׼ (Bitcoin Core base58_encode_decode.json)
+    const char* vectors[][2] = {
+        { "", "" },
+        { "61", "2g" },
+        { "626262", "a3gV" },
+        { "636363", "aPEr" },
+        { "73696d706c792061206c6f6e6720737472696e67", "2cFupjhnEsSn59qHXstmK2ffpLv2" },
+        { "00eb15231dfceb60925886b67d065299925915aeb172c06647", "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L" },
+        { "516b6fcd0f", "ABnLTmg" },
+        { "bf4f89001e670274dd", "3SEo3LWLoPntC" },
+        { "572e4794", "3EFU7m" },
+        { "ecac89cad93923c02321", "EJDM8drfXA6uyA" },
+        { "10c8511e", "Rt5zm" },
+        { "00000000000000000000", "1111111111" },
+    };
+    for (const auto& v : vectors) {
+        Bytes data = ParseHexString(v[0]);
+        assert(EncodeBase58(data) == v[1]);
+        Bytes back;
+        assert(DecodeBase58(v[1], back) && back == data);
+    }
+
+    // 2. ֳȡǰ 0 οʵһ£ܽ
+    for (size_t len = 0; len < 80; len++) {
+        Bytes data(len);
+        for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i * 37 + len);
+        if (len > 3) data[0] = data[1] = 0;
+        std::string str = EncodeBase58(data);
+        assert(str == ReferenceBase58(data));
+        Bytes back;
+        assert(DecodeBase58(str, back) && back == data);
+    }
+
+    // 3. ĸַ
+    Bytes out;
+    assert(!DecodeBase58("3EFU0m", out) && out.empty());
+    assert(!DecodeBase58("3EFUOm", out));
+    assert(!DecodeBase58("3EFU7m ", out));
+
+    // 4. Base58Checkַõ汾 + Hash160(Կ)һַУ;Ͳ
+    Wallet wallet;
+    wallet.GenerateNewKey();
+    std::string address = wallet.GetAddress();
+    Bytes payload;
+    assert(DecodeBase58Check(address, payload));
+    uint160 keyHash = Hash160(wallet.GetPublicKey());
+    assert(payload.size() == 21 && payload[0] == 0x00);
+    assert(Bytes(payload.begin() + 1, payload.end()) == Bytes(keyHash.begin(), keyHash.end()));
+    assert(EncodeBase58Check(payload) == address);
+    std::string typo = address;
+    typo[5] = (typo[5] == 'a') ? 'b' : 'a';
+    assert(!DecodeBase58Check(typo, payload) && payload.empty());
+    assert(!DecodeBase58Check("1111", payload));
+
+    // 5. ӿýͬ
+    std::vector<Bytes> payloads;
+    for (uint32_t i = 0; i < 5000; i++) {
+        Bytes p(21, 0);
+        for (int k = 0; k < 4; k++) p[20 - k] = (uint8_t)(i >> (8 * k));
+        payloads.push_back(p);
+    }
+    std::vector<std::string> encoded = EncodeBase58CheckBatch(payloads);
+    assert(encoded.size() == payloads.size() && encoded[1234] == EncodeBase58Check(payloads[1234]));
+    encoded[77] = typo;
+    std::vector<Bytes> decoded;
+    std::vector<bool> ok = DecodeBase58CheckBatch(encoded, decoded);
+    for (size_t i = 0; i < payloads.size(); i++) {
+        assert(ok[i] == (i != 77));
+        if (i != 77) assert(decoded[i] == payloads[i]);
+    }
+
+    std::cout << "Base58 Test Passed!" << std::endl;
+}
+
+void TestHDKey() {
+    // 1. BIP32  1m / 0H / 1 / 2H / 2
+    HDKey master = HDKey::FromSeed(ParseHexString("000102030405060708090a0b0c0d0e0f"));
+    assert(ToHex(master.GetPrivateKey()) == "e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35");
+    assert(ToHex(master.GetChainCode()) == "873dff81c02f525623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508");
+
+    HDKey child = master.Derive(0 | HDKey::HARDENED);
+    assert(ToHex(child.GetPrivateKey()) == "edb2e14f9ee77d26dd93b4ecede8d16ed408ce149b6cd80b0715a2d911a0afea");
+    assert(ToHex(child.GetPublicKey()) == "035a784662a4a20a65bf6aab9ae98a6c068a81c52e4b032c0fb5400c706cfccc56");
+    child = child.Derive(1);
+    assert(ToHex(child.GetChainCode()) == "2a7857631386ba23dacac34180dd1983734e444fdbf774041578e9b6adb37c19");
+    assert(ToHex(child.GetPublicKey()) == "03501e454bf00751f24b1b489aa925215d66af2234e3891c3b21a52bedb3cd711c");
+    HDKey leaf = master.DerivePath({ 0 | HDKey::HARDENED, 1, 2 | HDKey::HARDENED, 2 });
+    assert(ToHex(leaf.GetPrivateKey()) == "0f479245fb19a38a1954c5c7c0ebab2f9bdfd96a17563ef28a6a4b1a2a764ef4");
+    assert(ToHex(leaf.GetPublicKey()) == "02e8445082a72f29b75ca48748a914df60622a609cacfce8ed0e35804560741d29");
+    assert(leaf.GetDepth() == 4 && leaf.GetChildNumber() == 2);
+
+    // 2.  Wallet ǩԿֱӼһ£˽ԿԵٵ
+    Wallet wallet = leaf.ToWallet();
+    assert(wallet.GetPublicKey() == leaf.GetPublicKey());
+    assert(wallet.GetPrivateKey() == leaf.GetPrivateKey());
+    uint256 hash = Hash256(ToBytes("hd"));
+    assert(Wallet::Verify(wallet.GetPublicKey(), hash, wallet.Sign(hash)));
+    Wallet restored;
+    restored.SetPrivateKey(wallet.GetPrivateKey());
+    assert(restored.GetAddress() == wallet.GetAddress());
+
+    // 3. ͬ
+    std::vector<Wallet> batch = child.DeriveWallets(10, 40);
+    for (uint32_t i = 0; i < 40; i += 13) {
+        assert(batch[i].GetAddress() == Wallet::AddressFromPublicKey(child.Derive(10 + i).GetPublicKey()));
+    }
+
+    // 4. ˽ԿΪ 0 СߵĽʱܾ
+    bool thrown = false;
+    try { restored.SetPrivateKey(uint256()); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown && restored.GetAddress() == wallet.GetAddress());
+    thrown = false;
+    try { restored.SetPrivateKey(uint256(Bytes(32, 0xFF))); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+
+    std::cout << "HD Key Test Passed!" << std::endl;
+}
+
+void TestKeyPool() {
+    // 1. ԿأȡԿַͬѾ
+    std::vector<Wallet> batch = Wallet::GenerateBatch(50);
+    std::set<std::string> addresses;
+    for (const auto& w : batch) addresses.insert(w.GetAddress());
+    assert(addresses.size() == 50);
+    {
+        KeyPool pool(64);
+        pool.WaitUntilFull();
+        assert(pool.Size() == 64);
+        for (int i = 0; i < 100; i++) { // ҪȺ̨
+            Wallet w = pool.Take();
+            assert(w.HasKey() && w.GetAddress() == Wallet::AddressFromPublicKey(w.GetPublicKey()));
+            assert(addresses.insert(w.GetAddress()).second);
+        }
+    }
+
+    // 2. Կأνʱ NextIndex 
+    HDKey account = HDKey::FromSeed(ToBytes("key pool test seed")).Derive(0 | HDKey::HARDENED);
+    uint32_t next;
+    {
+        KeyPool pool(account, 5, 16);
+        for (uint32_t i = 5; i < 25; i++) {
+            assert(pool.NextIndex() == i);
+            assert(pool.Take().GetPublicKey() == account.Derive(i).GetPublicKey());
+        }
+        next = pool.NextIndex();
+    }
+    assert(next == 25);
+    KeyPool resumed(account, next, 4);
+    assert(resumed.Take().GetPublicKey() == account.Derive(25).GetPublicKey());
+
+    std::cout << "Key Pool Test Passed!" << std::endl;
+}
+
 int main() {
     try {
         TestWallet();
+        TestPublicKey();
+        TestPublicKeyCache();
+        TestBase58();
+        TestHDKey();
+        TestKeyPool();
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;